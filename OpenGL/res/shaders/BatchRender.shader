@@ -14,7 +14,9 @@ uniform mat4 u_MVP;
 
 void main()
 {
-	gl_Position = u_MVP * position;
+	// z is the depth the batcher gave the quad, it bypasses the projection
+	gl_Position = u_MVP * vec4(position.xy, 0.0, 1.0);
+	gl_Position.z = position.z * gl_Position.w;
 	v_TexCoord = texCoord;
 	v_Color = color;
 	v_TexID = texID;
@@ -30,10 +32,33 @@ in vec2 v_TexCoord;
 in vec4 v_Color;
 in float v_TexID;
 
-uniform sampler2D u_Textures[32];
+// sized by the batcher from GL_MAX_TEXTURE_IMAGE_UNITS
+#ifndef MAX_TEXTURES
+#define MAX_TEXTURES 32
+#endif
+
+#ifndef UNTEXTURED
+uniform sampler2D u_Textures[MAX_TEXTURES];
+#endif
 
 void main()
 {
+#ifdef UNTEXTURED
+	// a batch that only used the white texture, nothing to sample
+	color = v_Color;
+#else
+	// negative ids are signed distance field glyphs, stored as -(slot + 1)
+	if (v_TexID < 0.0)
+	{
+		int index = int(-v_TexID + 0.5) - 1;
+		float distance = texture(u_Textures[index], v_TexCoord).r;
+		float width = fwidth(distance);
+		float alpha = smoothstep(0.5 - width, 0.5 + width, distance);
+		color = vec4(v_Color.rgb, v_Color.a * alpha);
+		return;
+	}
+
 	int index = int(v_TexID);
 	color = texture(u_Textures[index], v_TexCoord) * v_Color;
+#endif
 };
\ No newline at end of file
@@ -0,0 +1,39 @@
+#shader vertex
+#version 450 core
+
+#include "include/Fullscreen.glsl"
+
+
+#shader fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Source;
+// one source texel along the blur
+uniform vec2 u_Direction;
+// brightness the THRESHOLD variant starts to keep from
+uniform float u_Threshold;
+
+void main()
+{
+#ifdef THRESHOLD
+	// bright pass, keeps what's above the threshold and fades in from there
+	vec3 source = texture(u_Source, v_TexCoord).rgb;
+	float brightness = max(source.r, max(source.g, source.b));
+	color = vec4(source * (max(brightness - u_Threshold, 0.0) / max(brightness, 0.0001)), 1.0);
+#else
+	// 9 tap gaussian in 5 fetches, the outer taps sample between two texels
+	const float offsets[3] = float[](0.0, 1.3846153846, 3.2307692308);
+	const float weights[3] = float[](0.2270270270, 0.3162162162, 0.0702702703);
+	vec3 sum = texture(u_Source, v_TexCoord).rgb * weights[0];
+	for (int i = 1; i < 3; i++)
+	{
+		sum += texture(u_Source, v_TexCoord + u_Direction * offsets[i]).rgb * weights[i];
+		sum += texture(u_Source, v_TexCoord - u_Direction * offsets[i]).rgb * weights[i];
+	}
+	color = vec4(sum, 1.0);
+#endif
+};
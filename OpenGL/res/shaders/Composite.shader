@@ -0,0 +1,20 @@
+#shader vertex
+#version 450 core
+
+#include "include/Fullscreen.glsl"
+
+
+#shader fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+// premultiplied alpha, blended with GL_ONE, GL_ONE_MINUS_SRC_ALPHA
+uniform sampler2D u_Layer;
+
+void main()
+{
+	color = texture(u_Layer, v_TexCoord);
+};
@@ -0,0 +1,45 @@
+#shader vertex
+#version 450 core
+
+#include "include/Fullscreen.glsl"
+
+
+#shader fragment
+#version 450 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Color;
+// stencil view of the counting target, one increment per shaded fragment
+uniform usampler2D u_Counts;
+// 0 scene, 1 heatmap over the scene, 2 heatmap
+uniform int u_Mode;
+uniform float u_MaxCount;
+uniform float u_Opacity;
+
+// black, blue, cyan, green, yellow, red
+vec3 Heat(float t)
+{
+	const vec3 colors[6] = vec3[](
+		vec3(0.0, 0.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 1.0),
+		vec3(0.0, 1.0, 0.0), vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0));
+	float scaled = t * 5.0;
+	int index = min(int(scaled), 4);
+	return mix(colors[index], colors[index + 1], scaled - float(index));
+}
+
+void main()
+{
+	vec4 scene = texture(u_Color, v_TexCoord);
+	uint count = texture(u_Counts, v_TexCoord).r;
+	vec3 heat = Heat(clamp(float(count) / u_MaxCount, 0.0, 1.0));
+
+	if (u_Mode == 2)
+		color = vec4(heat, 1.0);
+	else if (u_Mode == 1)
+		color = vec4(mix(scene.rgb, heat, count > 0u ? u_Opacity : 0.0), 1.0);
+	else
+		color = scene;
+};
@@ -0,0 +1,9 @@
+// vertex stage of the fullscreen passes, a triangle from the vertex id, no vertex buffer needed
+out vec2 v_TexCoord;
+
+void main()
+{
+	vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+	v_TexCoord = position;
+	gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+};
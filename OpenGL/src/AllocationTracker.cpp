@@ -0,0 +1,97 @@
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<uint64_t> s_Allocations{ 0 };
+static std::atomic<uint64_t> s_Frees{ 0 };
+static std::atomic<uint64_t> s_Bytes{ 0 };
+
+AllocationCounters AllocationTracker::GetCounters()
+{
+    AllocationCounters counters;
+    counters.Allocations = s_Allocations.load(std::memory_order_relaxed);
+    counters.Frees = s_Frees.load(std::memory_order_relaxed);
+    counters.Bytes = s_Bytes.load(std::memory_order_relaxed);
+    return counters;
+}
+
+#if TRACK_ALLOCATIONS
+
+static void* TrackedAllocate(size_t size, size_t alignment)
+{
+    if (size == 0)
+        size = 1;
+
+    void* memory;
+    if (alignment <= alignof(std::max_align_t))
+        memory = std::malloc(size);
+    else
+    {
+#ifdef _MSC_VER
+        memory = _aligned_malloc(size, alignment);
+#else
+        // aligned_alloc wants a multiple of the alignment
+        memory = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+    }
+
+    if (memory)
+    {
+        s_Allocations.fetch_add(1, std::memory_order_relaxed);
+        s_Bytes.fetch_add(size, std::memory_order_relaxed);
+    }
+    return memory;
+}
+
+static void TrackedFree(void* memory, size_t alignment)
+{
+    if (!memory)
+        return;
+
+    s_Frees.fetch_add(1, std::memory_order_relaxed);
+#ifdef _MSC_VER
+    if (alignment > alignof(std::max_align_t))
+    {
+        _aligned_free(memory);
+        return;
+    }
+#else
+    (void)alignment;
+#endif
+    std::free(memory);
+}
+
+static void* TrackedNew(size_t size, size_t alignment)
+{
+    void* memory = TrackedAllocate(size, alignment);
+    if (!memory)
+        throw std::bad_alloc();
+    return memory;
+}
+
+void* operator new(size_t size) { return TrackedNew(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return TrackedNew(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return TrackedAllocate(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return TrackedAllocate(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return TrackedNew(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment) { return TrackedNew(size, (size_t)alignment); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return TrackedAllocate(size, (size_t)alignment); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return TrackedAllocate(size, (size_t)alignment); }
+
+void operator delete(void* memory) noexcept { TrackedFree(memory, alignof(std::max_align_t)); }
+void operator delete[](void* memory) noexcept { TrackedFree(memory, alignof(std::max_align_t)); }
+void operator delete(void* memory, size_t) noexcept { TrackedFree(memory, alignof(std::max_align_t)); }
+void operator delete[](void* memory, size_t) noexcept { TrackedFree(memory, alignof(std::max_align_t)); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { TrackedFree(memory, alignof(std::max_align_t)); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { TrackedFree(memory, alignof(std::max_align_t)); }
+void operator delete(void* memory, std::align_val_t alignment) noexcept { TrackedFree(memory, (size_t)alignment); }
+void operator delete[](void* memory, std::align_val_t alignment) noexcept { TrackedFree(memory, (size_t)alignment); }
+void operator delete(void* memory, size_t, std::align_val_t alignment) noexcept { TrackedFree(memory, (size_t)alignment); }
+void operator delete[](void* memory, size_t, std::align_val_t alignment) noexcept { TrackedFree(memory, (size_t)alignment); }
+void operator delete(void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept { TrackedFree(memory, (size_t)alignment); }
+void operator delete[](void* memory, std::align_val_t alignment, const std::nothrow_t&) noexcept { TrackedFree(memory, (size_t)alignment); }
+
+#endif
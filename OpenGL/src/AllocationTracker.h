@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// set to 0 to leave the global operator new/delete alone
+#ifndef TRACK_ALLOCATIONS
+#define TRACK_ALLOCATIONS 1
+#endif
+
+// heap activity of the whole process, every thread included
+struct AllocationCounters
+{
+	uint64_t Allocations = 0;
+	uint64_t Frees = 0;
+	// requested by the allocations, frees aren't sized
+	uint64_t Bytes = 0;
+
+	inline AllocationCounters operator-(const AllocationCounters& other) const
+	{
+		return { Allocations - other.Allocations, Frees - other.Frees, Bytes - other.Bytes };
+	}
+};
+
+// counts every global operator new and delete, a couple of relaxed atomic adds each so
+// it stays on in release builds; take a snapshot before and after a frame to see what
+// the frame allocated
+class AllocationTracker
+{
+public:
+	// totals since startup, all zero when TRACK_ALLOCATIONS is off
+	static AllocationCounters GetCounters();
+	static inline bool IsEnabled() { return TRACK_ALLOCATIONS != 0; }
+};
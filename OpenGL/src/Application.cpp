@@ -5,6 +5,8 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <chrono>
+#include <cstring>
 
 #include "Renderer.h"
 
@@ -14,6 +16,18 @@
 #include "VertexArray.h"
 #include "Shader.h"
 #include "Texture.h"
+#include "HeadlessContext.h"
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "FramePacer.h"
+#include "FrameCapture.h"
+#include "CommandCapture.h"
+#include "CommandReplay.h"
+#include "FrameArena.h"
+#include "GpuMemoryTracker.h"
+#include "ResourceManager.h"
+#include "OverdrawView.h"
+#include "SceneFile.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -29,8 +43,221 @@
 #include "tests/TestBatchDynamicGeometry.h"
 #include "tests/TestBatchRendering.h"
 #include "tests/TestCircle.h"
+#include "tests/TestLines.h"
+#include "tests/TestText.h"
+#include "tests/TestRenderGraph.h"
+#include "tests/TestReplay.h"
+#include "tests/TestResourcePool.h"
+#include "tests/TestStreaming.h"
+#include "tests/TestStreamingTexture.h"
+#include "tests/TestSceneFile.h"
+#include "tests/TestWorldStreaming.h"
+#include "tests/TestSprites.h"
+#include "tests/TestStress.h"
 
-int main(void)
+struct Options
+{
+    bool Headless = false;
+    bool Bench = false;
+    PacingMode Pacing = PacingMode::VSync;
+    float TargetFps = 60.0f;
+    bool FixedTimestep = false;
+    // empty means no capture
+    std::string CapturePrefix;
+    CaptureFormat Capture = CaptureFormat::Png;
+    int CaptureFrames = -1;
+    int Width = 1920, Height = 1080;
+    bool SizeGiven = false;
+    // a command capture played back instead of the built in tests
+    std::string ReplayPath;
+    BenchmarkOptions Benchmark;
+    // --convert-scene, text in and binary out
+    std::string SceneText, SceneOutput;
+    bool SceneBench = false;
+};
+
+static Options ParseOptions(int argc, char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+            options.Headless = true;
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+        {
+            // WIDTHxHEIGHT
+            std::string size = argv[++i];
+            size_t x = size.find('x');
+            if (x != std::string::npos)
+            {
+                options.Width = atoi(size.substr(0, x).c_str());
+                options.Height = atoi(size.substr(x + 1).c_str());
+                options.SizeGiven = true;
+            }
+        }
+        else if (strcmp(argv[i], "--pacing") == 0 && i + 1 < argc)
+        {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "uncapped") == 0)
+                options.Pacing = PacingMode::Uncapped;
+            else if (strcmp(mode, "vsync") == 0)
+                options.Pacing = PacingMode::VSync;
+            else if (strcmp(mode, "adaptive") == 0)
+                options.Pacing = PacingMode::AdaptiveVSync;
+            else if (strcmp(mode, "fps") == 0)
+                options.Pacing = PacingMode::TargetFps;
+            else
+                std::cout << "Unknown pacing mode " << mode << "\n";
+        }
+        else if (strcmp(argv[i], "--fps") == 0 && i + 1 < argc)
+        {
+            options.Pacing = PacingMode::TargetFps;
+            options.TargetFps = (float)atof(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--fixed-step") == 0)
+            options.FixedTimestep = true;
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+            options.CapturePrefix = argv[++i];
+        else if (strcmp(argv[i], "--capture-frames") == 0 && i + 1 < argc)
+            options.CaptureFrames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--raw") == 0)
+            options.Capture = CaptureFormat::Raw;
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            options.Benchmark.RecordPath = argv[++i];
+        else if (strcmp(argv[i], "--record-frames") == 0 && i + 1 < argc)
+            options.Benchmark.RecordFrames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            options.ReplayPath = argv[++i];
+        else if (strcmp(argv[i], "--overdraw") == 0)
+            options.Benchmark.Overdraw = true;
+        else if (strcmp(argv[i], "--bench") == 0)
+            options.Bench = true;
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            options.Benchmark.Frames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc)
+            options.Benchmark.WarmupFrames = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            options.Benchmark.Filter = argv[++i];
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            options.Benchmark.JsonPath = argv[++i];
+        else if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc)
+            options.Benchmark.CsvPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            options.Benchmark.BaselinePath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc)
+            options.Benchmark.Threshold = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-allocations") == 0 && i + 1 < argc)
+            options.Benchmark.MaxAllocations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--fail-on-leaks") == 0)
+            options.Benchmark.FailOnLeaks = true;
+        else if (strcmp(argv[i], "--convert-scene") == 0 && i + 2 < argc)
+        {
+            options.SceneText = argv[++i];
+            options.SceneOutput = argv[++i];
+        }
+        else if (strcmp(argv[i], "--scene-bench") == 0)
+            options.SceneBench = true;
+        else
+            std::cout << "Unknown option " << argv[i] << "\n";
+    }
+    return options;
+}
+
+// scaling curves, every scene changes one param from the defaults, e.g. --bench --filter Stress
+static void RegisterStressTests(test::TestMenu& testMenu)
+{
+    auto add = [&testMenu](const test::StressParams& params) {
+        testMenu.RegisterTest<test::TestStress>(test::GetStressName(params), params);
+    };
+
+    test::StressParams params;
+    for (uint32_t quads : { 10000u, 100000u, 1000000u, 10000000u })
+    {
+        params.Quads = quads;
+        add(params);
+    }
+    params = test::StressParams();
+    // around GL_MAX_TEXTURE_IMAGE_UNITS, a batch holds one texture less than that next to white
+    for (uint32_t textures : { 0u, 8u, 16u, 32u, 64u, 256u })
+    {
+        params.Textures = textures;
+        add(params);
+    }
+    params = test::StressParams();
+    for (float moving : { 0.0f, 0.5f, 1.0f })
+    {
+        params.Moving = moving;
+        add(params);
+    }
+    params = test::StressParams();
+    for (float overlap : { 0.5f, 8.0f, 32.0f })
+    {
+        params.Overlap = overlap;
+        add(params);
+    }
+    params = test::StressParams();
+    for (test::StressSizes sizes : { test::StressSizes::Fixed, test::StressSizes::Skewed })
+    {
+        params.Sizes = sizes;
+        add(params);
+    }
+}
+
+static void RegisterTests(test::TestMenu& testMenu)
+{
+    testMenu.RegisterTest<test::TestClearColor>("Clear Color");
+    testMenu.RegisterTest<test::TestTexture2D>("Texture");
+    testMenu.RegisterTest<test::TestTexture2DBatch>("Batching");
+    testMenu.RegisterTest<test::TestMultiTexture2DBatch>("Batching with Multiple Textures");
+    testMenu.RegisterTest<test::TestBatchDynamicGeometry>("Batching with Dynamic Geometry");
+    testMenu.RegisterTest<test::TestBatchRendering>("Batch Rendering!");
+    testMenu.RegisterTest<test::TestCircle>("Circle");
+    testMenu.RegisterTest<test::TestLines>("Lines");
+    testMenu.RegisterTest<test::TestText>("Text");
+    testMenu.RegisterTest<test::TestResourcePool>("Resource Pool");
+    testMenu.RegisterTest<test::TestRenderGraph>("Render Graph (bloom)");
+    // written on first use, kept for the next run
+    testMenu.RegisterTest<test::TestSceneFile>("Scene File (1M sprites)", std::string("res/scenes/generated_1m.scene"), 1000000u);
+    testMenu.RegisterTest<test::TestWorldStreaming>("World Streaming (10M sprites)", std::string("res/scenes/generated_10m.scene"), 10000000u);
+    testMenu.RegisterTest<test::TestSprites>("Sprite Store (1M sprites)", 1000000u);
+    // one entry per strategy so the bench compares them, e.g. --bench --filter Streaming
+    for (int i = 0; i < StreamingStrategyCount; i++)
+    {
+        StreamingStrategy strategy = (StreamingStrategy)i;
+        testMenu.RegisterTest<test::TestStreaming>(std::string("Streaming: ") + GetStreamingStrategyName(strategy), strategy);
+    }
+    testMenu.RegisterTest<test::TestStreamingTexture>("Streaming Texture (1024x1024)", 1024);
+    RegisterStressTests(testMenu);
+}
+
+// a replay stands in for the built in tests, e.g. --headless --replay frames.cmd
+static void RegisterTests(test::TestMenu& testMenu, const Options& options)
+{
+    if (!options.ReplayPath.empty())
+        testMenu.RegisterTest<test::TestReplay>("Replay: " + options.ReplayPath, options.ReplayPath);
+    else
+        RegisterTests(testMenu);
+}
+
+// loaded in the background while the menu is up so opening a test doesn't hit the disk
+static void PreloadResources()
+{
+    ResourceManager::Get().Preload(
+        {
+            // BatchRender.shader is compiled per variant by the BatchRenderer
+            "res/shaders/Basic.shader",
+            "res/shaders/Circle.shader",
+            "res/shaders/Line.shader",
+            "res/shaders/Multi.shader",
+            "res/shaders/TextureBatch.shader"
+        },
+        {
+            "res/textures/Penguin.png",
+            "res/textures/icon.png"
+        });
+}
+
+static int RunWindowed(const Options& options)
 {
     GLFWwindow* window;
 
@@ -44,7 +271,7 @@ int main(void)
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     /* Create a windowed mode window and its OpenGL context */
-    window = glfwCreateWindow(1920, 1080, "Hello World", NULL, NULL);
+    window = glfwCreateWindow(options.Width, options.Height, "Hello World", NULL, NULL);
     if (!window)
     {
         glfwTerminate();
@@ -54,8 +281,6 @@ int main(void)
     /* Make the window's context current */
     glfwMakeContextCurrent(window);
 
-    glfwSwapInterval(10);
-
     /* GLEW init after the context and window exist */
     if (glewInit() != GLEW_OK)
         std::cout << "Error \n";
@@ -63,6 +288,7 @@ int main(void)
     // show version
     std::cout << glGetString(GL_VERSION) << "\n";
 
+    int exitCode = 0;
     {
         // blending
         GLCall(glEnable(GL_BLEND));
@@ -70,6 +296,18 @@ int main(void)
 
         Renderer renderer;
 
+        FramePacer pacer(window);
+        pacer.SetTargetFps(options.TargetFps);
+        pacer.SetMode(options.Pacing);
+        pacer.SetFixedTimestep(options.FixedTimestep);
+
+        FrameCapture capture;
+        if (!options.CapturePrefix.empty())
+            capture.Start(options.CapturePrefix, options.Capture, options.CaptureFrames);
+
+        OverdrawView overdraw;
+        overdraw.SetEnabled(options.Benchmark.Overdraw);
+
         // Setup Dear ImGui context
         ImGui::CreateContext();
         // Setup Platform/Renderer bindings
@@ -82,59 +320,215 @@ int main(void)
         test::TestMenu* testMenu = new test::TestMenu(currentTest);
         currentTest = testMenu;
 
-        testMenu->RegisterTest<test::TestClearColor>("Clear Color");
-        testMenu->RegisterTest<test::TestTexture2D>("Texture");
-        testMenu->RegisterTest<test::TestTexture2DBatch>("Batching");
-        testMenu->RegisterTest<test::TestMultiTexture2DBatch>("Batching with Multiple Textures");
-        testMenu->RegisterTest<test::TestBatchDynamicGeometry>("Batching with Dynamic Geometry");
-        testMenu->RegisterTest<test::TestBatchRendering>("Batch Rendering!");
-        testMenu->RegisterTest<test::TestCircle>("Circle");
+        RegisterTests(*testMenu, options);
+        PreloadResources();
+        if (!options.Benchmark.RecordPath.empty())
+            CommandCapture::Get().SetDefaults(options.Benchmark.RecordPath, options.Benchmark.RecordFrames);
+        // objects created after this belong to the open test
+        uint64_t testMarker = 0;
+
+        if (options.Bench)
+        {
+            // measure real throughput, not the refresh rate
+            glfwSwapInterval(0);
+
+            Benchmark benchmark(options.Benchmark);
+            benchmark.RunAll(*testMenu, [window, &capture]() {
+                int width, height;
+                glfwGetFramebufferSize(window, &width, &height);
+                capture.Capture(0, width, height);
+                glfwSwapBuffers(window);
+                glfwPollEvents();
+            });
+            exitCode = benchmark.Report();
+            glfwSetWindowShouldClose(window, GLFW_TRUE);
+        }
 
         /* Loop until the user closes the window */
         while (!glfwWindowShouldClose(window))
         {
-            GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
-            /* Render here */
-            renderer.Clear();
+            float deltaTime = pacer.BeginFrame();
+            Profiler::Get().BeginFrame();
+            {
+                PROFILE_SCOPE("Frame");
 
-            // feed inputs to dear imgui, start new frame
-            ImGui_ImplOpenGL3_NewFrame();
-            ImGui_ImplGlfw_NewFrame();
-            ImGui::NewFrame();
+                CommandCapture::Get().BeginFrame();
+                GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+                /* Render here */
+                renderer.Clear();
 
-            if (currentTest)
-            {
-                currentTest->OnUpdate(0.0f);
-                currentTest->OnRender();
-                ImGui::Begin("Test");
-                if (currentTest != testMenu && ImGui::Button("<-"))
+                // feed inputs to dear imgui, start new frame
+                ImGui_ImplOpenGL3_NewFrame();
+                ImGui_ImplGlfw_NewFrame();
+                ImGui::NewFrame();
+
+                ResourceManager::Get().Update();
+
+                if (currentTest)
                 {
-                    delete currentTest;
-                    currentTest = testMenu;
+                    {
+                        PROFILE_SCOPE("OnUpdate");
+                        if (pacer.IsFixedTimestep())
+                        {
+                            int steps = pacer.ConsumeFixedSteps();
+                            for (int step = 0; step < steps; step++)
+                                currentTest->OnUpdate(pacer.GetFixedStep());
+                        }
+                        else
+                            currentTest->OnUpdate(deltaTime);
+                    }
+                    {
+                        PROFILE_SCOPE("OnRender");
+                        PROFILE_GPU_SCOPE("OnRender");
+                        overdraw.Begin();
+                        currentTest->OnRender();
+                        overdraw.End();
+                    }
+                    // the ui isn't part of a command capture
+                    CommandCapture::Get().EndFrame();
+                    PROFILE_SCOPE("OnImGuiRender");
+                    ImGui::Begin("Test");
+                    if (currentTest != testMenu && ImGui::Button("<-"))
+                    {
+                        delete currentTest;
+                        currentTest = testMenu;
+                        GpuMemoryTracker::Get().ReportLeaks("Closing test", testMarker);
+                    }
+                    if (currentTest == testMenu)
+                        testMarker = GpuMemoryTracker::Get().GetMarker();
+                    currentTest->OnImGuiRender();
+                    ImGui::End();
+                }
+
+                Profiler::Get().OnImGuiRender();
+                pacer.OnImGuiRender();
+                capture.OnImGuiRender();
+                CommandCapture::Get().OnImGuiRender();
+                overdraw.OnImGuiRender();
+                ResourceManager::Get().OnImGuiRender();
+                GpuMemoryTracker::Get().OnImGuiRender();
+
+                // the test output without the ui on top
+                {
+                    int width, height;
+                    glfwGetFramebufferSize(window, &width, &height);
+                    capture.Capture(0, width, height);
                 }
-                currentTest->OnImGuiRender();
-                ImGui::End();
-            }
 
-            // Render dear imgui into screen
-            ImGui::Render();
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                // Render dear imgui into screen
+                {
+                    PROFILE_SCOPE("ImGui");
+                    PROFILE_GPU_SCOPE("ImGui");
+                    ImGui::Render();
+                    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                }
+
+                /* Swap front and back buffers */
+                {
+                    PROFILE_SCOPE("SwapBuffers");
+                    glfwSwapBuffers(window);
+                }
 
-            /* Swap front and back buffers */
-            glfwSwapBuffers(window);
+                /* Poll for and process events */
+                GLCall(glfwPollEvents());
+            }
+            Profiler::Get().EndFrame();
+            FrameArena::ResetAll();
 
-            /* Poll for and process events */
-            GLCall(glfwPollEvents());
+            pacer.EndFrame();
         }
         delete currentTest;
         if (currentTest != testMenu)
             delete testMenu;
+
+        // shared resources outlive the tests but not the context
+        ResourceManager::Get().Clear();
     }
+    // every wrapper is gone, anything still tracked was never deleted
+    GpuMemoryTracker::Get().ReportLeaks("Shutdown", 0, true);
 
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     //ImGui::DestroyContext();
 
     glfwTerminate();
-    return 0;
+    return exitCode;
+}
+
+/* benchmark every registered test offscreen */
+static int RunHeadless(const Options& options)
+{
+    HeadlessContext context(options.Width, options.Height);
+    if (!context.IsValid())
+        return -1;
+
+#ifdef _WIN32
+    GLenum glewResult = glewInit();
+#else
+    // glewInit wants a GLX display next to the context, only load the GL entry points
+    GLenum glewResult = glewContextInit();
+#endif
+    if (glewResult != GLEW_OK)
+    {
+        std::cout << "Failed to initialize GLEW: " << glewGetErrorString(glewResult) << std::endl;
+        return -1;
+    }
+
+    // show version
+    std::cout << glGetString(GL_VERSION) << " " << glGetString(GL_RENDERER) << "\n";
+
+    int exitCode = 0;
+    // the render target lives as long as the context
+    uint64_t marker;
+    {
+        context.CreateRenderTarget();
+        context.Bind();
+        marker = GpuMemoryTracker::Get().GetMarker();
+
+        // blending
+        GLCall(glEnable(GL_BLEND));
+        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+        test::Test* currentTest = nullptr;
+        test::TestMenu testMenu(currentTest);
+        RegisterTests(testMenu, options);
+
+        FrameCapture capture;
+        if (!options.CapturePrefix.empty())
+            capture.Start(options.CapturePrefix, options.Capture, options.CaptureFrames);
+
+        // no swap to throttle us, wait for the GPU so the time is real
+        Benchmark benchmark(options.Benchmark);
+        benchmark.RunAll(testMenu, [&context, &capture]() {
+            capture.Capture(context.GetFramebufferID(), context.GetWidth(), context.GetHeight());
+            GLCall(glFinish());
+        });
+        exitCode = benchmark.Report();
+
+        context.Unbind();
+        ResourceManager::Get().Clear();
+    }
+    GpuMemoryTracker::Get().ReportLeaks("Shutdown", marker, true);
+
+    return exitCode;
+}
+
+int main(int argc, char** argv)
+{
+    Options options = ParseOptions(argc, argv);
+    // neither needs a window or a context
+    if (!options.SceneText.empty())
+        return ConvertTextScene(options.SceneText, options.SceneOutput) ? 0 : 1;
+    if (options.SceneBench)
+        return RunSceneLoadBenchmark({ 1000000, 10000000 });
+    // replays render at the size they were recorded at, --size overrides it
+    CaptureHeader header;
+    if (!options.ReplayPath.empty() && !options.SizeGiven && CommandReplay::ReadHeader(options.ReplayPath, header))
+    {
+        options.Width = header.Width;
+        options.Height = header.Height;
+    }
+    if (options.Headless)
+        return RunHeadless(options);
+    return RunWindowed(options);
 }
\ No newline at end of file
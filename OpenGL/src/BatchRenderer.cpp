@@ -0,0 +1,957 @@
+#include "BatchRenderer.h"
+
+#include "CommandCapture.h"
+#include "VertexLayout.h"
+#include "GpuMemoryTracker.h"
+#include "Profiler.h"
+#include "ResourceManager.h"
+#include "SpriteStore.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define BATCH_RENDERER_SSE
+#endif
+
+// unit normals (-dy, dx) of every segment points[i] -> points[(i + 1) % count]
+static void ComputeSegmentNormals(const glm::vec2* points, size_t count, size_t segments,
+    float* normalX, float* normalY)
+{
+    size_t i = 0;
+
+#ifdef BATCH_RENDERER_SSE
+    // four segments per iteration, needs points up to i + 4 without wrapping
+    const float* p = &points[0].x;
+    const __m128 epsilon = _mm_set1_ps(1e-12f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    for (; i + 4 < count && i + 4 <= segments; i += 4)
+    {
+        __m128 a0 = _mm_loadu_ps(p + i * 2);
+        __m128 a1 = _mm_loadu_ps(p + i * 2 + 4);
+        __m128 b0 = _mm_loadu_ps(p + i * 2 + 2);
+        __m128 b1 = _mm_loadu_ps(p + i * 2 + 6);
+
+        __m128 x0 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 y0 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 x1 = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 y1 = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+
+        __m128 dx = _mm_sub_ps(x1, x0);
+        __m128 dy = _mm_sub_ps(y1, y0);
+        __m128 length2 = _mm_max_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), epsilon);
+        __m128 invLength = _mm_div_ps(one, _mm_sqrt_ps(length2));
+
+        _mm_storeu_ps(normalX + i, _mm_mul_ps(_mm_sub_ps(_mm_setzero_ps(), dy), invLength));
+        _mm_storeu_ps(normalY + i, _mm_mul_ps(dx, invLength));
+    }
+#endif
+
+    for (; i < segments; i++)
+    {
+        const glm::vec2& p0 = points[i];
+        const glm::vec2& p1 = points[(i + 1) % count];
+        float dx = p1.x - p0.x;
+        float dy = p1.y - p0.y;
+        float invLength = 1.0f / std::sqrt(std::max(dx * dx + dy * dy, 1e-12f));
+        normalX[i] = -dy * invLength;
+        normalY[i] = dx * invLength;
+    }
+}
+
+// checked at compile time, a member added to a vertex struct without updating these fails to build
+static constexpr auto QuadLayout = MakeVertexLayout<BatchRenderer::Vertex>(
+    VERTEX_ATTRIBUTE(BatchRenderer::Vertex, Position),
+    VERTEX_ATTRIBUTE(BatchRenderer::Vertex, TexCoord),
+    VERTEX_ATTRIBUTE(BatchRenderer::Vertex, Color),
+    VERTEX_ATTRIBUTE(BatchRenderer::Vertex, TextureID));
+static_assert(QuadLayout.IsPacked(), "BatchRenderer::Vertex has padding");
+static_assert(QuadLayout.Stride == 10 * sizeof(float), "BatchRenderer::Vertex no longer matches BatchRender.shader");
+
+static constexpr auto LineLayout = MakeVertexLayout<BatchRenderer::LineVertex>(
+    VERTEX_ATTRIBUTE(BatchRenderer::LineVertex, Position),
+    VERTEX_ATTRIBUTE(BatchRenderer::LineVertex, Color));
+static_assert(LineLayout.IsPacked(), "BatchRenderer::LineVertex has padding");
+static_assert(LineLayout.Stride == 6 * sizeof(float), "BatchRenderer::LineVertex no longer matches Line.shader");
+
+BatchRenderer::BatchRenderer()
+    : m_TextureWhite(0), m_IndexCount(0), m_TextureSlotIndex(1)
+{
+    // the sampler array is sized for the hardware, the plain color variant samples nothing
+    uint32_t maxTextures = GetMaxTextures();
+    m_Shader = ResourceManager::Get().GetShader("res/shaders/BatchRender.shader",
+        { "MAX_TEXTURES=" + std::to_string(maxTextures) });
+    m_ColorShader = ResourceManager::Get().GetShader("res/shaders/BatchRender.shader", { "UNTEXTURED" });
+    m_Shader->Bind();
+
+    std::vector<int> samplers(maxTextures);
+    for (uint32_t i = 0; i < maxTextures; i++)
+        samplers[i] = (int)i;
+    m_Shader->SetUniform1iv("u_Textures", (int)maxTextures, samplers.data());
+
+    m_QuadBuffer = new Vertex[MaxVertexCount];
+    m_LineBuffer = new LineVertex[MaxLineVertexCount];
+    m_QuadBufferPtr = m_QuadBuffer;
+    m_LineBufferPtr = m_LineBuffer;
+
+    m_VAO = &ResourceManager::Get().GetVertexArray(QuadLayout);
+
+    std::vector<uint32_t> indices(MaxIndexCount);
+    uint32_t offset = 0;
+    for (size_t i = 0; i < MaxIndexCount; i += 6)
+    {
+        indices[i + 0] = 0 + offset;
+        indices[i + 1] = 1 + offset;
+        indices[i + 2] = 2 + offset;
+
+        indices[i + 3] = 2 + offset;
+        indices[i + 4] = 3 + offset;
+        indices[i + 5] = 0 + offset;
+
+        offset += 4;
+    }
+
+    m_IB = std::make_unique<IndexBuffer>(indices.data(), MaxIndexCount);
+
+    m_LineShader = ResourceManager::Get().GetShader("res/shaders/Line.shader");
+
+    m_LineVAO = &ResourceManager::Get().GetVertexArray(LineLayout);
+    SetStreamingStrategy(DefaultStreamingStrategy);
+
+    // 1x1 white texture
+    GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_TextureWhite));
+    GLCall(glBindTexture(GL_TEXTURE_2D, m_TextureWhite));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    uint32_t color = 0xffffffff;
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, &color));
+    GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+    GPU_TRACK(GpuResourceType::Texture, m_TextureWhite, 4, "BatchRenderer white");
+
+    m_TextureSlots.assign(maxTextures, 0);
+    m_TextureSlots[0] = m_TextureWhite;
+}
+
+BatchRenderer::~BatchRenderer()
+{
+    GPU_UNTRACK(GpuResourceType::Texture, m_TextureWhite);
+    GLCall(glDeleteTextures(1, &m_TextureWhite));
+
+    delete[] m_QuadBuffer;
+    delete[] m_LineBuffer;
+}
+
+uint32_t BatchRenderer::GetMaxTextures()
+{
+    return (uint32_t)Renderer::GetMaxTextureUnits();
+}
+
+void BatchRenderer::SetViewProjection(const glm::mat4& mvp)
+{
+    m_ViewProjection = mvp;
+    m_Shader->Bind();
+    m_Shader->SetUniformMat4f("u_MVP", mvp);
+    m_ColorShader->Bind();
+    m_ColorShader->SetUniformMat4f("u_MVP", mvp);
+    m_LineShader->Bind();
+    m_LineShader->SetUniformMat4f("u_MVP", mvp);
+}
+
+void BatchRenderer::BeginBatch()
+{
+    PROFILE_SCOPE("BeginBatch");
+
+    m_QuadBufferPtr = m_QuadBuffer;
+    m_LineBufferPtr = m_LineBuffer;
+}
+
+void BatchRenderer::EndBatch()
+{
+    PROFILE_SCOPE("EndBatch");
+    PROFILE_GPU_SCOPE("EndBatch");
+
+    UploadQuads();
+    UploadLines();
+}
+
+void BatchRenderer::Flush()
+{
+    PROFILE_SCOPE("Flush");
+    PROFILE_GPU_SCOPE("Flush");
+
+    // a partial redraw with nothing left still has to erase what was there
+    if (!m_SortedQuads.empty() || (m_PartialRedraw && !m_PreviousHashes.empty()))
+        FlushSorted();
+
+    DrawQuads();
+    DrawLines();
+}
+
+void BatchRenderer::UploadQuads()
+{
+    size_t size = (uint8_t*)m_QuadBufferPtr - (uint8_t*)m_QuadBuffer;
+    if (size > 0)
+    {
+        m_VBOffset = m_VB->Upload(m_QuadBuffer, size);
+        Renderer::GetFrameStats().BytesUploaded += size;
+    }
+}
+
+void BatchRenderer::UploadLines()
+{
+    size_t lineSize = (uint8_t*)m_LineBufferPtr - (uint8_t*)m_LineBuffer;
+    if (lineSize > 0)
+    {
+        m_LineVBOffset = m_LineVB->Upload(m_LineBuffer, lineSize);
+        Renderer::GetFrameStats().BytesUploaded += lineSize;
+    }
+}
+
+void BatchRenderer::DrawQuads()
+{
+    if (m_IndexCount > 0)
+    {
+        if (m_TextureSlotIndex > 1)
+        {
+            m_Shader->Bind();
+            for (uint32_t i = 0; i < m_TextureSlotIndex; i++)
+            {
+                GLCall(glBindTextureUnit(i, m_TextureSlots[i]));
+            }
+        }
+        else
+            m_ColorShader->Bind();
+
+        // the VAO is shared with everything else using this vertex format
+        m_VAO->SetVertexBuffer(m_VB->GetRendererID(), QuadLayout.Stride, m_VBOffset);
+        m_VAO->SetIndexBuffer(*m_IB);
+        m_VAO->Bind();
+        CommandCapture::Get().RecordDraw(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, 0);
+        GLCall(glDrawElements(GL_TRIANGLES, m_IndexCount, GL_UNSIGNED_INT, nullptr));
+        m_RenderStats.DrawCount++;
+        Renderer::GetFrameStats().DrawCalls++;
+        Renderer::GetFrameStats().Quads += m_IndexCount / 6;
+    }
+
+    // the ring may only reuse what was uploaded so far once these draws are done
+    m_VB->Fence();
+
+    m_IndexCount = 0;
+    m_TextureSlotIndex = 1;
+    m_SlotGeneration++;
+}
+
+void BatchRenderer::DrawLines()
+{
+    GLsizei lineVertexCount = (GLsizei)(m_LineBufferPtr - m_LineBuffer);
+    if (lineVertexCount > 0)
+    {
+        m_LineShader->Bind();
+        m_LineVAO->SetVertexBuffer(m_LineVB->GetRendererID(), LineLayout.Stride, m_LineVBOffset);
+        m_LineVAO->Bind();
+        CommandCapture::Get().RecordDraw(GL_LINES, lineVertexCount, 0, 0);
+        GLCall(glDrawArrays(GL_LINES, 0, lineVertexCount));
+        m_RenderStats.DrawCount++;
+        Renderer::GetFrameStats().DrawCalls++;
+    }
+
+    m_LineVB->Fence();
+}
+
+void BatchRenderer::NextBatch()
+{
+    if (m_Replaying)
+    {
+        UploadQuads();
+        DrawQuads();
+        m_QuadBufferPtr = m_QuadBuffer;
+        return;
+    }
+
+    EndBatch();
+    Flush();
+    BeginBatch();
+}
+
+void BatchRenderer::SetDepthSorting(bool enabled)
+{
+    // quads already held keep their place in front of anything drawn unsorted later
+    if (!enabled && !m_SortedQuads.empty())
+        FlushSorted();
+    m_DepthSorting = enabled;
+}
+
+void BatchRenderer::FlushSorted()
+{
+    PROFILE_SCOPE("FlushSorted");
+    PROFILE_GPU_SCOPE("FlushSorted");
+
+    // anything unsorted already in the buffer was submitted first, it goes out first
+    UploadQuads();
+    DrawQuads();
+    m_QuadBufferPtr = m_QuadBuffer;
+
+    // painter's order: by layer, submission order within a layer
+    uint32_t count = (uint32_t)m_SortedQuads.size();
+    // sorted as layer << 32 | index, unique keys keep it stable without the temporary
+    // buffer std::stable_sort allocates on every call
+    m_SortKeys.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        // + 0.0f folds -0 into 0, the bits are flipped so they order like the floats
+        float layer = m_SortedQuads[i].Layer + 0.0f;
+        uint32_t bits;
+        memcpy(&bits, &layer, sizeof(bits));
+        bits ^= (bits & 0x80000000) ? 0xffffffff : 0x80000000;
+        m_SortKeys[i] = (uint64_t)bits << 32 | i;
+    }
+    std::sort(m_SortKeys.begin(), m_SortKeys.end());
+    m_SortOrder.resize(count);
+    for (uint32_t i = 0; i < count; i++)
+        m_SortOrder[i] = (uint32_t)m_SortKeys[i];
+
+    GLboolean blend;
+    GLCall(blend = glIsEnabled(GL_BLEND));
+    GLCall(glEnable(GL_DEPTH_TEST));
+    GLCall(glDepthFunc(GL_LESS));
+    GLCall(glDepthMask(GL_TRUE));
+
+    if (!m_PartialRedraw)
+    {
+        // every flush starts over, later flushes cover earlier ones like before
+        Renderer::Clear(GL_DEPTH_BUFFER_BIT);
+        DrawSortedPasses(nullptr, blend);
+    }
+    else
+    {
+        UpdateDirtyRegion();
+        if (m_DirtyRegion.IsFull())
+        {
+            Renderer::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            DrawSortedPasses(nullptr, blend);
+        }
+        else if (!m_DirtyRegion.IsEmpty())
+        {
+            // clears respect the scissor, each rect starts from the clear color
+            GLCall(glEnable(GL_SCISSOR_TEST));
+            for (const DirtyRect& rect : m_DirtyRegion.GetRects())
+            {
+                GLCall(glScissor(rect.X0, rect.Y0, rect.X1 - rect.X0, rect.Y1 - rect.Y0));
+                Renderer::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                DrawSortedPasses(&rect, blend);
+            }
+            GLCall(glDisable(GL_SCISSOR_TEST));
+        }
+        m_RenderStats.DirtyRectCount += (uint32_t)m_DirtyRegion.GetRects().size();
+        m_RenderStats.RedrawCoverage = m_DirtyRegion.IsEmpty() ? 0.0f : m_DirtyRegion.GetCoverage();
+    }
+
+    GLCall(glDisable(GL_DEPTH_TEST));
+    m_SortedQuads.clear();
+}
+
+void BatchRenderer::DrawSortedPasses(const DirtyRect* clip, bool blend)
+{
+    uint32_t count = (uint32_t)m_SortedQuads.size();
+
+    // rank r in painter's order gets NDC depth 1 - (r + 1) * step, later is nearer. A 24 bit
+    // depth buffer and the float NDC z keep ranks apart up to about 2^22 quads, past that
+    // neighbours share a depth value: the opaque pass still resolves them since it draws front
+    // to back with GL_LESS, the translucent pass tests GL_LEQUAL so a quad isn't rejected by
+    // an opaque one right behind it (one in front at the same value lets it through instead)
+    const float step = 2.0f / (count + 1);
+    const auto replay = [&](uint32_t rank) {
+        uint32_t index = m_SortOrder[rank];
+        if (clip && !m_QuadBounds[index].Intersects(*clip))
+            return false;
+
+        const SortedQuad& quad = m_SortedQuads[index];
+        m_Depth = 1.0f - (rank + 1) * step;
+        EmitQuad(quad.Corners[0], quad.Corners[1], quad.Corners[2], quad.Corners[3],
+            quad.Color, quad.TextureID, quad.UVMin, quad.UVMax, quad.Flags);
+        return true;
+    };
+
+    m_Replaying = true;
+
+    // opaque front to back, whatever ends up hidden fails the early depth test
+    GLCall(glDisable(GL_BLEND));
+    GLCall(glDepthFunc(GL_LESS));
+    GLCall(glDepthMask(GL_TRUE));
+    for (uint32_t rank = count; rank-- > 0;)
+    {
+        if (m_SortedQuads[m_SortOrder[rank]].Opaque && replay(rank))
+            m_RenderStats.OpaqueQuadCount++;
+    }
+    UploadQuads();
+    DrawQuads();
+    m_QuadBufferPtr = m_QuadBuffer;
+
+    // translucent back to front, tested against the opaque ones but not writing depth
+    if (blend)
+    {
+        GLCall(glEnable(GL_BLEND));
+    }
+    GLCall(glDepthFunc(GL_LEQUAL));
+    GLCall(glDepthMask(GL_FALSE));
+    for (uint32_t rank = 0; rank < count; rank++)
+    {
+        if (!m_SortedQuads[m_SortOrder[rank]].Opaque && replay(rank))
+            m_RenderStats.TranslucentQuadCount++;
+    }
+    UploadQuads();
+    DrawQuads();
+    m_QuadBufferPtr = m_QuadBuffer;
+
+    GLCall(glDepthFunc(GL_LESS));
+    GLCall(glDepthMask(GL_TRUE));
+
+    m_Replaying = false;
+    m_Depth = 0.0f;
+}
+
+void BatchRenderer::UpdateDirtyRegion()
+{
+    PROFILE_SCOPE("UpdateDirtyRegion");
+
+    GLint viewport[4];
+    GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+    DirtyRect target = { viewport[0], viewport[1], viewport[0] + viewport[2], viewport[1] + viewport[3] };
+    m_DirtyRegion.Reset(target);
+
+    // window space bounds, a pixel of margin for filtering at the edges
+    size_t count = m_SortedQuads.size();
+    m_QuadBounds.resize(count);
+    m_QuadHashes.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const SortedQuad& quad = m_SortedQuads[i];
+        glm::vec2 min = { FLT_MAX, FLT_MAX }, max = { -FLT_MAX, -FLT_MAX };
+        for (const glm::vec2& corner : quad.Corners)
+        {
+            glm::vec4 clip = m_ViewProjection * glm::vec4(corner, 0.0f, 1.0f);
+            glm::vec2 window = { (clip.x / clip.w * 0.5f + 0.5f) * viewport[2] + viewport[0],
+                (clip.y / clip.w * 0.5f + 0.5f) * viewport[3] + viewport[1] };
+            min = glm::min(min, window);
+            max = glm::max(max, window);
+        }
+        m_QuadBounds[i] = { (int)std::floor(min.x) - 1, (int)std::floor(min.y) - 1,
+            (int)std::ceil(max.x) + 1, (int)std::ceil(max.y) + 1 };
+
+        // FNV-1a over everything that affects the pixels, the members before Opaque are all 4 bytes
+        const uint8_t* bytes = (const uint8_t*)&quad;
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t b = 0; b < offsetof(SortedQuad, Opaque); b++)
+            hash = (hash ^ bytes[b]) * 1099511628211ull;
+        m_QuadHashes[i] = hash;
+    }
+
+    // quads are matched with the previous flush by submission index
+    bool full = m_InvalidateAll || count != m_PreviousHashes.size() || m_ViewProjection != m_PreviousViewProjection
+        || target.X0 != m_PreviousViewport.X0 || target.Y0 != m_PreviousViewport.Y0
+        || target.X1 != m_PreviousViewport.X1 || target.Y1 != m_PreviousViewport.Y1;
+    if (full)
+        m_DirtyRegion.SetFull();
+    else
+    {
+        // a moved quad has to be erased where it was and drawn where it is
+        for (size_t i = 0; i < count && !m_DirtyRegion.IsFull(); i++)
+        {
+            if (m_QuadHashes[i] == m_PreviousHashes[i])
+                continue;
+            m_DirtyRegion.Add(m_PreviousBounds[i]);
+            m_DirtyRegion.Add(m_QuadBounds[i]);
+        }
+        m_DirtyRegion.Merge();
+    }
+
+    // copies, the current bounds are still needed to clip the passes
+    m_PreviousBounds = m_QuadBounds;
+    m_PreviousHashes = m_QuadHashes;
+    m_PreviousViewProjection = m_ViewProjection;
+    m_PreviousViewport = target;
+    m_InvalidateAll = false;
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color)
+{
+    PROFILE_SCOPE_VERBOSE("DrawQuad");
+
+    EmitQuad(position, { position.x + size.x, position.y },
+        position + size, { position.x, position.y + size.y }, color);
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const uint32_t textureID)
+{
+    PROFILE_SCOPE_VERBOSE("DrawQuad");
+
+    // default no tint for texture
+    constexpr glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    EmitQuad(position, { position.x + size.x, position.y },
+        position + size, { position.x, position.y + size.y }, color, textureID);
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture)
+{
+    PROFILE_SCOPE_VERBOSE("DrawQuad");
+
+    constexpr glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    EmitQuad(position, { position.x + size.x, position.y },
+        position + size, { position.x, position.y + size.y }, color, texture.GetRendererID(),
+        { 0.0f, 0.0f }, { 1.0f, 1.0f }, texture.IsOpaque() ? (uint32_t)QuadOpaqueTexture : 0u);
+}
+
+void BatchRenderer::DrawQuad(const glm::vec2& position, const glm::vec2& size, uint32_t textureID,
+    const glm::vec2& uvMin, const glm::vec2& uvMax, const glm::vec4& color)
+{
+    PROFILE_SCOPE_VERBOSE("DrawQuad");
+
+    EmitQuad(position, { position.x + size.x, position.y },
+        position + size, { position.x, position.y + size.y }, color, textureID, uvMin, uvMax);
+}
+
+void BatchRenderer::DrawSprites(const SpriteStore& sprites)
+{
+    PROFILE_SCOPE("DrawSprites");
+
+    size_t count = sprites.GetCount();
+    const float* positionX = sprites.GetPositionX();
+    const float* positionY = sprites.GetPositionY();
+    const float* sizeX = sprites.GetSizeX();
+    const float* sizeY = sprites.GetSizeY();
+    const float* rotation = sprites.GetRotation();
+    const uint32_t* colors = sprites.GetColors();
+    const SpriteStore::Image* images = sprites.GetImages();
+    uint32_t imageCount = sprites.GetImageCount();
+
+    // slots are looked up once per image and batch instead of once per sprite
+    m_ImageSlots.assign(imageCount, 0.0f);
+    uint32_t slotGeneration = m_SlotGeneration - 1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t packed = colors[i];
+        glm::vec4 color = glm::vec4(packed & 0xff, packed >> 8 & 0xff, packed >> 16 & 0xff, packed >> 24) * (1.0f / 255.0f);
+
+        glm::vec2 uvMin = { 0.0f, 0.0f }, uvMax = { 1.0f, 1.0f };
+        uint32_t textureID = 0;
+        uint16_t image = sprites.GetCurrentImage(i);
+        if (image < imageCount)
+        {
+            uvMin = images[image].UVMin;
+            uvMax = images[image].UVMax;
+            textureID = images[image].TextureID;
+        }
+
+        // rotated around the center, the corners in the order DrawQuad emits them
+        glm::vec2 half = { sizeX[i] * 0.5f, sizeY[i] * 0.5f };
+        glm::vec2 center = { positionX[i] + half.x, positionY[i] + half.y };
+        glm::vec2 a, b, c, d;
+        if (rotation[i] != 0.0f)
+        {
+            float s = std::sin(rotation[i]), co = std::cos(rotation[i]);
+            glm::vec2 u = { co * half.x, s * half.x };
+            glm::vec2 v = { -s * half.y, co * half.y };
+            a = center - u - v;
+            b = center + u - v;
+            c = center + u + v;
+            d = center - u + v;
+        }
+        else
+        {
+            a = center - half;
+            b = { center.x + half.x, center.y - half.y };
+            c = center + half;
+            d = { center.x - half.x, center.y + half.y };
+        }
+
+        if (m_DepthSorting && !m_Replaying)
+        {
+            EmitQuad(a, b, c, d, color, textureID, uvMin, uvMax);
+            continue;
+        }
+
+        if (m_IndexCount >= MaxIndexCount)
+            NextBatch();
+
+        float textureIndex = 0.0f;
+        if (textureID)
+        {
+            if (slotGeneration != m_SlotGeneration)
+            {
+                std::fill(m_ImageSlots.begin(), m_ImageSlots.end(), 0.0f);
+                slotGeneration = m_SlotGeneration;
+            }
+            float& slot = m_ImageSlots[image];
+            if (slot == 0.0f)
+            {
+                slot = GetTextureIndex(textureID);
+                // running out of slots drew the batch, the other cached slots are gone
+                if (slotGeneration != m_SlotGeneration)
+                {
+                    std::fill(m_ImageSlots.begin(), m_ImageSlots.end(), 0.0f);
+                    slotGeneration = m_SlotGeneration;
+                    m_ImageSlots[image] = slot;
+                }
+            }
+            textureIndex = slot;
+        }
+
+        Vertex* vertex = m_QuadBufferPtr;
+        vertex[0] = { { a, m_Depth }, uvMin, color, textureIndex };
+        vertex[1] = { { b, m_Depth }, { uvMax.x, uvMin.y }, color, textureIndex };
+        vertex[2] = { { c, m_Depth }, uvMax, color, textureIndex };
+        vertex[3] = { { d, m_Depth }, { uvMin.x, uvMax.y }, color, textureIndex };
+        m_QuadBufferPtr += 4;
+        m_IndexCount += 6;
+        m_RenderStats.QuadCount++;
+    }
+}
+
+void BatchRenderer::DrawStaticQuads(unsigned int buffer, uint32_t quadCount, const uint32_t* textures, uint32_t textureCount)
+{
+    PROFILE_SCOPE("DrawStaticQuads");
+
+    if (quadCount == 0)
+        return;
+
+    m_Shader->Bind();
+    GLCall(glBindTextureUnit(0, m_TextureWhite));
+    textureCount = std::min(textureCount, (uint32_t)m_TextureSlots.size() - 1);
+    for (uint32_t i = 0; i < textureCount; i++)
+    {
+        GLCall(glBindTextureUnit(i + 1, textures[i]));
+    }
+
+    m_VAO->SetVertexBuffer(buffer, QuadLayout.Stride, 0);
+    m_VAO->SetIndexBuffer(*m_IB);
+    m_VAO->Bind();
+
+    // the shared index buffer covers MaxQuadCount quads, longer runs go out in pieces
+    for (uint32_t first = 0; first < quadCount; first += MaxQuadCount)
+    {
+        uint32_t quads = std::min(quadCount - first, (uint32_t)MaxQuadCount);
+        CommandCapture::Get().RecordDraw(GL_TRIANGLES, quads * 6, GL_UNSIGNED_INT, 0, first * 4);
+        GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, quads * 6, GL_UNSIGNED_INT, nullptr, first * 4));
+        m_RenderStats.DrawCount++;
+        m_RenderStats.QuadCount += quads;
+        Renderer::GetFrameStats().DrawCalls++;
+        Renderer::GetFrameStats().Quads += quads;
+    }
+}
+
+void BatchRenderer::DrawLine(const glm::vec2& p0, const glm::vec2& p1, float thickness, const glm::vec4& color,
+    LineCap cap)
+{
+    if (thickness <= 1.0f)
+    {
+        DrawHairline(p0, p1, color);
+        return;
+    }
+
+    const glm::vec2 points[2] = { p0, p1 };
+    DrawPolyline(points, 2, thickness, color, LineJoin::Miter, cap, false);
+}
+
+void BatchRenderer::DrawPolyline(const glm::vec2* points, size_t count, float thickness, const glm::vec4& color,
+    LineJoin join, LineCap cap, bool closed)
+{
+    if (count < 2)
+        return;
+
+    size_t segments = closed ? count : count - 1;
+
+    if (thickness <= 1.0f)
+    {
+        for (size_t i = 0; i < segments; i++)
+            DrawHairline(points[i], points[(i + 1) % count], color);
+        return;
+    }
+
+    if (m_NormalX.size() < segments)
+    {
+        m_NormalX.resize(segments);
+        m_NormalY.resize(segments);
+    }
+    ComputeSegmentNormals(points, count, segments, m_NormalX.data(), m_NormalY.data());
+
+    const float halfWidth = thickness * 0.5f;
+
+    // segment bodies
+    for (size_t i = 0; i < segments; i++)
+    {
+        glm::vec2 n = glm::vec2(m_NormalX[i], m_NormalY[i]) * halfWidth;
+        glm::vec2 p0 = points[i];
+        glm::vec2 p1 = points[(i + 1) % count];
+
+        if (!closed && cap == LineCap::Square)
+        {
+            // direction is the normal rotated back by 90 degrees
+            glm::vec2 d = { n.y, -n.x };
+            if (i == 0)
+                p0 -= d;
+            if (i == segments - 1)
+                p1 += d;
+        }
+
+        EmitQuad(p0 - n, p1 - n, p1 + n, p0 + n, color);
+    }
+
+    // joins fill the gap on the outer side of every interior vertex
+    size_t firstJoin = closed ? 0 : 1;
+    size_t lastJoin = closed ? count : count - 1;
+    for (size_t i = firstJoin; i < lastJoin; i++)
+    {
+        size_t prev = (i + segments - 1) % segments;
+        glm::vec2 n0 = { m_NormalX[prev], m_NormalY[prev] };
+        glm::vec2 n1 = { m_NormalX[i], m_NormalY[i] };
+
+        float turn = n0.x * n1.y - n0.y * n1.x;
+        float cosine = glm::dot(n0, n1);
+        if (std::fabs(turn) < 1e-6f && cosine > 0.0f)
+            continue;
+
+        // a left turn opens the gap on the right side
+        float side = turn > 0.0f ? -1.0f : 1.0f;
+        const glm::vec2& p = points[i];
+        glm::vec2 o0 = n0 * (halfWidth * side);
+        glm::vec2 o1 = n1 * (halfWidth * side);
+
+        LineJoin effective = join;
+        // miter longer than 4x the half width falls back to bevel
+        if (effective == LineJoin::Miter && 1.0f + cosine < 0.125f)
+            effective = LineJoin::Bevel;
+
+        switch (effective)
+        {
+        case LineJoin::Miter:
+        {
+            glm::vec2 miter = (o0 + o1) / (1.0f + cosine);
+            EmitQuad(p, p + o0, p + miter, p + o1, color);
+            break;
+        }
+        case LineJoin::Bevel:
+            EmitTriangle(p, p + o0, p + o1, color);
+            break;
+        case LineJoin::Round:
+            EmitFan(p, o0, std::atan2(o0.x * o1.y - o0.y * o1.x, glm::dot(o0, o1)), halfWidth, color);
+            break;
+        }
+    }
+
+    if (!closed && cap == LineCap::Round)
+    {
+        const float pi = 3.14159265f;
+        glm::vec2 nStart = glm::vec2(m_NormalX[0], m_NormalY[0]) * halfWidth;
+        glm::vec2 nEnd = glm::vec2(m_NormalX[segments - 1], m_NormalY[segments - 1]) * halfWidth;
+        EmitFan(points[0], nStart, pi, halfWidth, color);
+        EmitFan(points[count - 1], -nEnd, pi, halfWidth, color);
+    }
+}
+
+void BatchRenderer::DrawHairline(const glm::vec2& p0, const glm::vec2& p1, const glm::vec4& color)
+{
+    if ((size_t)(m_LineBufferPtr - m_LineBuffer) + 2 > MaxLineVertexCount)
+    {
+        EndBatch();
+        Flush();
+        BeginBatch();
+    }
+
+    m_LineBufferPtr->Position = p0;
+    m_LineBufferPtr->Color = color;
+    m_LineBufferPtr++;
+
+    m_LineBufferPtr->Position = p1;
+    m_LineBufferPtr->Color = color;
+    m_LineBufferPtr++;
+
+    m_RenderStats.LineCount++;
+}
+
+void BatchRenderer::DrawHairlines(const glm::vec2* points, size_t segmentCount, const glm::vec4& color)
+{
+    while (segmentCount > 0)
+    {
+        size_t used = m_LineBufferPtr - m_LineBuffer;
+        if (used + 2 > MaxLineVertexCount)
+        {
+            EndBatch();
+            Flush();
+            BeginBatch();
+            used = 0;
+        }
+
+        // copy as many segments as fit in one go
+        size_t batch = std::min(segmentCount, (MaxLineVertexCount - used) / 2);
+        LineVertex* target = m_LineBufferPtr;
+        for (size_t i = 0; i < batch * 2; i++)
+        {
+            target[i].Position = points[i];
+            target[i].Color = color;
+        }
+
+        m_LineBufferPtr += batch * 2;
+        m_RenderStats.LineCount += (uint32_t)batch;
+        points += batch * 2;
+        segmentCount -= batch;
+    }
+}
+
+void BatchRenderer::DrawString(Font& font, const std::string& text, const glm::vec2& position, float size,
+    const glm::vec4& color)
+{
+    float scale = size / font.GetPixelHeight();
+    for (const Font::GlyphQuad& quad : font.Layout(text))
+    {
+        glm::vec2 min = position + quad.Min * scale;
+        glm::vec2 max = position + quad.Max * scale;
+        EmitQuad(min, { max.x, min.y }, max, { min.x, max.y }, color,
+            font.GetTextureID(), quad.UVMin, quad.UVMax, QuadSDF);
+        m_RenderStats.GlyphCount++;
+    }
+}
+
+void BatchRenderer::ResetStats()
+{
+    m_RenderStats = Stats();
+}
+
+void BatchRenderer::SetStreamingStrategy(StreamingStrategy strategy)
+{
+    // the buffers belong to the renderer, not to whichever test switched the strategy
+    GpuMemoryTracker::SharedScope shared;
+    m_VB = std::make_unique<StreamingBuffer>(MaxVertexCount * sizeof(Vertex), strategy, QuadRingLength);
+    m_LineVB = std::make_unique<StreamingBuffer>(MaxLineVertexCount * sizeof(LineVertex), strategy, LineRingLength);
+}
+
+StreamingBuffer::Stats BatchRenderer::GetStreamingStats() const
+{
+    StreamingBuffer::Stats stats = m_VB->GetStats();
+    const StreamingBuffer::Stats& lines = m_LineVB->GetStats();
+    stats.Bytes += lines.Bytes;
+    stats.Uploads += lines.Uploads;
+    stats.UploadMs += lines.UploadMs;
+    stats.WaitMs += lines.WaitMs;
+    stats.Waits += lines.Waits;
+    return stats;
+}
+
+void BatchRenderer::ResetStreamingStats()
+{
+    m_VB->ResetStats();
+    m_LineVB->ResetStats();
+}
+
+void BatchRenderer::EmitQuad(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, const glm::vec2& d,
+    const glm::vec4& color, uint32_t textureID, const glm::vec2& uvMin, const glm::vec2& uvMax, uint32_t flags)
+{
+    if (m_DepthSorting && !m_Replaying)
+    {
+        // white or a texture known to be opaque, raw texture IDs might have alpha
+        bool opaque = color.a >= 1.0f && !(flags & QuadSDF) && (textureID == 0 || (flags & QuadOpaqueTexture));
+        m_SortedQuads.push_back({ { a, b, c, d }, uvMin, uvMax, color, textureID, flags, m_Layer, opaque });
+        m_RenderStats.QuadCount++;
+        return;
+    }
+
+    if (m_IndexCount >= MaxIndexCount)
+        NextBatch();
+
+    // default no texture for pure color rendering
+    float textureIndex = textureID ? GetTextureIndex(textureID) : 0.0f;
+    // distance field slots are stored negated, the shader tells them apart by sign
+    if (flags & QuadSDF)
+        textureIndex = -(textureIndex + 1.0f);
+
+    m_QuadBufferPtr->Position = { a, m_Depth };
+    m_QuadBufferPtr->TexCoord = uvMin;
+    m_QuadBufferPtr->Color = color;
+    m_QuadBufferPtr->TextureID = textureIndex;
+    m_QuadBufferPtr++;
+
+    m_QuadBufferPtr->Position = { b, m_Depth };
+    m_QuadBufferPtr->TexCoord = { uvMax.x, uvMin.y };
+    m_QuadBufferPtr->Color = color;
+    m_QuadBufferPtr->TextureID = textureIndex;
+    m_QuadBufferPtr++;
+
+    m_QuadBufferPtr->Position = { c, m_Depth };
+    m_QuadBufferPtr->TexCoord = uvMax;
+    m_QuadBufferPtr->Color = color;
+    m_QuadBufferPtr->TextureID = textureIndex;
+    m_QuadBufferPtr++;
+
+    m_QuadBufferPtr->Position = { d, m_Depth };
+    m_QuadBufferPtr->TexCoord = { uvMin.x, uvMax.y };
+    m_QuadBufferPtr->Color = color;
+    m_QuadBufferPtr->TextureID = textureIndex;
+    m_QuadBufferPtr++;
+
+    m_IndexCount += 6;
+    // sorted quads were counted when submitted
+    if (!m_Replaying)
+        m_RenderStats.QuadCount++;
+}
+
+float BatchRenderer::GetTextureIndex(uint32_t textureID)
+{
+    // check if the texture is used
+    for (uint32_t i = 1; i < m_TextureSlotIndex; i++)
+    {
+        if (m_TextureSlots[i] == textureID)
+            return (float)i;
+    }
+
+    // out of slots, draw what we have and start over
+    if (m_TextureSlotIndex >= m_TextureSlots.size())
+        NextBatch();
+
+    // texture has not been used, save it
+    m_TextureSlots[m_TextureSlotIndex] = textureID;
+    return (float)m_TextureSlotIndex++;
+}
+
+void BatchRenderer::EmitTriangle(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, const glm::vec4& color)
+{
+    // degenerate quad, the second triangle (c, c, a) has no area
+    EmitQuad(a, b, c, c, color);
+}
+
+void BatchRenderer::EmitFan(const glm::vec2& center, const glm::vec2& from, float sweep, float radius,
+    const glm::vec4& color)
+{
+    // more steps for wider lines so the arc stays smooth
+    int steps = (int)std::ceil(std::fabs(sweep) * std::sqrt(radius) * 0.5f);
+    steps = std::clamp(steps, 2, 32);
+
+    float step = sweep / steps;
+    float c = std::cos(step);
+    float s = std::sin(step);
+
+    // two fan triangles per quad: (center, v0, v1) and (v1, v2, center)
+    glm::vec2 v0 = from;
+    for (int i = 0; i < steps; i += 2)
+    {
+        glm::vec2 v1 = { v0.x * c - v0.y * s, v0.x * s + v0.y * c };
+        if (i + 1 < steps)
+        {
+            glm::vec2 v2 = { v1.x * c - v1.y * s, v1.x * s + v1.y * c };
+            EmitQuad(center, center + v0, center + v1, center + v2, color);
+            v0 = v2;
+        }
+        else
+        {
+            EmitTriangle(center, center + v0, center + v1, color);
+            v0 = v1;
+        }
+    }
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include "Renderer.h"
+#include "StreamingBuffer.h"
+#include "DirtyRegion.h"
+#include "Font.h"
+#include "Texture.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+class SpriteStore;
+
+enum class LineJoin
+{
+	Miter, Bevel, Round
+};
+
+enum class LineCap
+{
+	Butt, Square, Round
+};
+
+class BatchRenderer
+{
+public:
+	static const size_t MaxQuadCount = 1000;
+	static const size_t MaxVertexCount = MaxQuadCount * 4;
+	static const size_t MaxIndexCount = MaxQuadCount * 6;
+	// hairlines are drawn as GL_LINES, two vertices per segment
+	static const size_t MaxLineCount = 100000;
+	static const size_t MaxLineVertexCount = MaxLineCount * 2;
+	// how many full batches the ring strategies keep in flight
+	static const int QuadRingLength = 32;
+	static const int LineRingLength = 3;
+	static constexpr StreamingStrategy DefaultStreamingStrategy = StreamingStrategy::PersistentRing;
+
+	struct Vertex
+	{
+		// z is the depth assigned when sorting, 0 otherwise
+		glm::vec3 Position;
+		glm::vec2 TexCoord;
+		glm::vec4 Color;
+		float TextureID;
+	};
+
+	struct LineVertex
+	{
+		glm::vec2 Position;
+		glm::vec4 Color;
+	};
+
+	struct Stats
+	{
+		uint32_t DrawCount = 0;
+		uint32_t QuadCount = 0;
+		uint32_t LineCount = 0;
+		uint32_t GlyphCount = 0;
+		// split made by the depth sorted path
+		uint32_t OpaqueQuadCount = 0;
+		uint32_t TranslucentQuadCount = 0;
+		// partial redraw, 0 rects and full coverage means everything was drawn
+		uint32_t DirtyRectCount = 0;
+		float RedrawCoverage = 0.0f;
+	};
+
+	BatchRenderer();
+	~BatchRenderer();
+
+	// texture slots per batch, one per fragment texture unit of the GL, the white texture included
+	static uint32_t GetMaxTextures();
+
+	void SetViewProjection(const glm::mat4& mvp);
+
+	void BeginBatch();
+	void EndBatch();
+	void Flush();
+
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color);
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const uint32_t textureID);
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, const Texture& texture);
+	// tinted region of a texture, e.g. one sprite of an atlas
+	void DrawQuad(const glm::vec2& position, const glm::vec2& size, uint32_t textureID,
+		const glm::vec2& uvMin, const glm::vec2& uvMax, const glm::vec4& color);
+
+	// every sprite of the store read straight from its component arrays, much cheaper
+	// per sprite than DrawQuad when depth sorting is off
+	void DrawSprites(const SpriteStore& sprites);
+
+	// quadCount prebuilt quads in Vertex layout kept in a buffer owned by the caller, e.g.
+	// static chunk geometry, TextureID n samples textures[n - 1] and 0 is white; draws right
+	// away so call it outside of BeginBatch/Flush
+	void DrawStaticQuads(unsigned int buffer, uint32_t quadCount, const uint32_t* textures, uint32_t textureCount);
+
+	// thick lines are tessellated into the quad batch, thickness <= 1 takes the hairline path
+	void DrawLine(const glm::vec2& p0, const glm::vec2& p1, float thickness, const glm::vec4& color,
+		LineCap cap = LineCap::Butt);
+	void DrawPolyline(const glm::vec2* points, size_t count, float thickness, const glm::vec4& color,
+		LineJoin join = LineJoin::Miter, LineCap cap = LineCap::Butt, bool closed = false);
+
+	// 1px GL_LINES fast path, points holds 2 * segmentCount endpoints
+	void DrawHairline(const glm::vec2& p0, const glm::vec2& p1, const glm::vec4& color);
+	void DrawHairlines(const glm::vec2* points, size_t segmentCount, const glm::vec4& color);
+
+	// size is the font pixel height in world units, position is the baseline of the first line
+	void DrawString(Font& font, const std::string& text, const glm::vec2& position, float size,
+		const glm::vec4& color);
+
+	const Stats& GetStats() const { return m_RenderStats; }
+	void ResetStats();
+
+	// quads are held until Flush, opaque ones are drawn front to back with depth writes and
+	// blending off, then translucent ones back to front, the result matches submission order
+	void SetDepthSorting(bool enabled);
+	inline bool IsDepthSorting() const { return m_DepthSorting; }
+	// quads submitted after this are ordered by layer first, higher is in front
+	inline void SetLayer(float layer) { m_Layer = layer; }
+	inline float GetLayer() const { return m_Layer; }
+
+	// needs depth sorting and a target that keeps its contents (PersistentTarget): the
+	// sorted quads are compared with the previous flush and only the screen areas that
+	// changed are cleared with the current clear color and redrawn, scissored, the rest
+	// of the target is left alone, hairlines are not tracked
+	inline void SetPartialRedraw(bool enabled) { m_PartialRedraw = enabled; }
+	inline bool IsPartialRedraw() const { return m_PartialRedraw; }
+	// the next partial flush redraws everything, e.g. after the target lost its contents
+	inline void InvalidateAll() { m_InvalidateAll = true; }
+	inline const DirtyRegion& GetDirtyRegion() const { return m_DirtyRegion; }
+
+	// recreates the vertex buffers, call outside of a batch
+	void SetStreamingStrategy(StreamingStrategy strategy);
+	inline StreamingStrategy GetStreamingStrategy() const { return m_VB->GetStrategy(); }
+	// quad and line uploads together
+	StreamingBuffer::Stats GetStreamingStats() const;
+	void ResetStreamingStats();
+
+private:
+	enum QuadFlags : uint32_t
+	{
+		// distance field glyphs, always blended
+		QuadSDF = 1,
+		// the texture has no alpha below 255
+		QuadOpaqueTexture = 2
+	};
+
+	// a quad held back for the depth sorted flush
+	struct SortedQuad
+	{
+		glm::vec2 Corners[4];
+		glm::vec2 UVMin, UVMax;
+		glm::vec4 Color;
+		uint32_t TextureID;
+		uint32_t Flags;
+		float Layer;
+		bool Opaque;
+	};
+
+	// textureID 0 samples the white texture
+	void EmitQuad(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, const glm::vec2& d,
+		const glm::vec4& color, uint32_t textureID = 0,
+		const glm::vec2& uvMin = { 0.0f, 0.0f }, const glm::vec2& uvMax = { 1.0f, 1.0f }, uint32_t flags = 0);
+	float GetTextureIndex(uint32_t textureID);
+	// makes room in the quad buffer, while replaying sorted quads the lines stay queued
+	void NextBatch();
+
+	void UploadQuads();
+	void UploadLines();
+	void DrawQuads();
+	void DrawLines();
+	void FlushSorted();
+	// both sorted passes, only quads touching clip when given
+	void DrawSortedPasses(const DirtyRect* clip, bool blend);
+	// diffs the sorted quads against the previous flush
+	void UpdateDirtyRegion();
+	void EmitTriangle(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c, const glm::vec4& color);
+	void EmitFan(const glm::vec2& center, const glm::vec2& from, float sweep, float radius,
+		const glm::vec4& color);
+
+	// shared per vertex format, owned by the ResourceManager
+	VertexArray* m_VAO;
+	std::unique_ptr<StreamingBuffer> m_VB;
+	size_t m_VBOffset = 0;
+	std::unique_ptr<IndexBuffer> m_IB;
+	std::shared_ptr<Shader> m_Shader;
+	// variant without texture sampling for batches that only use the white slot
+	std::shared_ptr<Shader> m_ColorShader;
+
+	VertexArray* m_LineVAO;
+	std::unique_ptr<StreamingBuffer> m_LineVB;
+	size_t m_LineVBOffset = 0;
+	std::shared_ptr<Shader> m_LineShader;
+
+	unsigned int m_TextureWhite;
+
+	uint32_t m_IndexCount = 0;
+
+	Vertex* m_QuadBuffer = nullptr;
+	Vertex* m_QuadBufferPtr = nullptr;
+
+	LineVertex* m_LineBuffer = nullptr;
+	LineVertex* m_LineBufferPtr = nullptr;
+
+	// GetMaxTextures entries, slot 0 is the white texture
+	std::vector<uint32_t> m_TextureSlots;
+	uint32_t m_TextureSlotIndex = 1;
+	// bumped whenever the texture slots are reset
+	uint32_t m_SlotGeneration = 0;
+	// texture slot per sprite store image in DrawSprites, valid for m_SlotGeneration
+	std::vector<float> m_ImageSlots;
+
+	bool m_DepthSorting = true;
+	bool m_Replaying = false;
+	float m_Layer = 0.0f;
+	// z written into the vertices while replaying
+	float m_Depth = 0.0f;
+	std::vector<SortedQuad> m_SortedQuads;
+	std::vector<uint64_t> m_SortKeys;
+	std::vector<uint32_t> m_SortOrder;
+
+	bool m_PartialRedraw = false;
+	bool m_InvalidateAll = true;
+	glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+	DirtyRegion m_DirtyRegion;
+	// per sorted quad, this flush and the previous one
+	std::vector<DirtyRect> m_QuadBounds, m_PreviousBounds;
+	std::vector<uint64_t> m_QuadHashes, m_PreviousHashes;
+	glm::mat4 m_PreviousViewProjection = glm::mat4(0.0f);
+	DirtyRect m_PreviousViewport;
+
+	// per segment unit normals, reused between polylines
+	std::vector<float> m_NormalX, m_NormalY;
+
+	Stats m_RenderStats;
+};
@@ -0,0 +1,407 @@
+#include "Benchmark.h"
+
+#include "AllocationTracker.h"
+#include "CommandCapture.h"
+#include "FrameArena.h"
+#include "GpuMemoryTracker.h"
+#include "Renderer.h"
+#include "OverdrawView.h"
+#include "SceneFile.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+static float Percentile(std::vector<float> samples, float p)
+{
+    if (samples.empty())
+        return 0.0f;
+    std::sort(samples.begin(), samples.end());
+    size_t index = (size_t)(p * (samples.size() - 1) + 0.5f);
+    return samples[index];
+}
+
+static std::string EscapeJson(const std::string& text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+            escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+Benchmark::Benchmark(const BenchmarkOptions& options)
+    : m_Options(options)
+{
+}
+
+void Benchmark::RunAll(const test::TestMenu& menu, const std::function<void()>& endFrame)
+{
+    for (auto& entry : menu.GetTests())
+    {
+        if (!m_Options.Filter.empty() && entry.first.find(m_Options.Filter) == std::string::npos)
+            continue;
+
+        uint64_t marker = GpuMemoryTracker::Get().GetMarker();
+        test::Test* test = entry.second();
+        BenchmarkResult result = Run(entry.first, test, endFrame);
+        delete test;
+        // Run stored the result already, leaks are only known once the test is gone
+        m_Results.back().LeakedObjects = (uint32_t)GpuMemoryTracker::Get().ReportLeaks(entry.first, marker);
+
+        std::cout << result.Name << ": mean " << result.MeanMs << " ms, p50 " << result.P50Ms
+            << " ms, p95 " << result.P95Ms << " ms, p99 " << result.P99Ms << " ms, gpu " << result.GpuMs
+            << " ms, " << result.DrawCalls << " draws, " << result.Quads << " quads, "
+            << result.BytesUploaded << " bytes, " << result.Allocations << " allocations ("
+            << result.MaxFrameAllocations << " max)";
+        if (m_Options.Overdraw)
+            std::cout << ", " << result.Overdraw << " fragments per pixel";
+        std::cout << "\n";
+    }
+}
+
+BenchmarkResult Benchmark::Run(const std::string& name, test::Test* test, const std::function<void()>& endFrame)
+{
+    // fixed step so every run animates the same way
+    const float deltaTime = 1.0f / 60.0f;
+
+    // warm frames are the ones worth replaying, and recording them doesn't touch the timing
+    CommandCapture& capture = CommandCapture::Get();
+    int recordFrom = m_Options.WarmupFrames - std::max(m_Options.RecordFrames, 1);
+    bool record = !m_Options.RecordPath.empty() && !m_Recorded;
+    for (int frame = 0; frame < m_Options.WarmupFrames; frame++)
+    {
+        if (record && frame == std::max(recordFrom, 0))
+            capture.Start(m_Options.RecordPath, m_Options.WarmupFrames - frame);
+        capture.BeginFrame();
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+        test->OnUpdate(deltaTime);
+        test->OnRender();
+        capture.EndFrame();
+        endFrame();
+        FrameArena::ResetAll();
+    }
+    if (record)
+    {
+        if (m_Options.WarmupFrames < m_Options.RecordFrames)
+            std::cout << "Recorded " << m_Options.WarmupFrames << " of " << m_Options.RecordFrames
+                << " frames of " << name << ", --warmup is shorter" << std::endl;
+        m_Recorded = true;
+    }
+    GLCall(glFinish());
+
+    // GPU results are read a few frames late so the queries never stall
+    const int QueryCount = 4;
+    unsigned int queries[QueryCount];
+    GLCall(glGenQueries(QueryCount, queries));
+
+    std::vector<float> frameTimes;
+    frameTimes.reserve(m_Options.Frames);
+    double gpuTotal = 0.0;
+    int gpuSamples = 0;
+    FrameStats totals;
+    AllocationCounters allocations;
+    uint32_t maxFrameAllocations = 0;
+
+    for (int frame = 0; frame < m_Options.Frames; frame++)
+    {
+        unsigned int query = queries[frame % QueryCount];
+        if (frame >= QueryCount)
+        {
+            GLuint64 elapsed = 0;
+            GLCall(glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed));
+            gpuTotal += elapsed / 1e6;
+            gpuSamples++;
+        }
+
+        Renderer::ResetFrameStats();
+        AllocationCounters frameStart = AllocationTracker::GetCounters();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        GLCall(glBeginQuery(GL_TIME_ELAPSED, query));
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+        test->OnUpdate(deltaTime);
+        test->OnRender();
+        GLCall(glEndQuery(GL_TIME_ELAPSED));
+        endFrame();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        frameTimes.push_back(std::chrono::duration<float, std::milli>(end - start).count());
+
+        // the arena reset belongs to the frame, growing it is an allocation of this frame
+        FrameArena::ResetAll();
+        AllocationCounters frameAllocations = AllocationTracker::GetCounters() - frameStart;
+        allocations.Allocations += frameAllocations.Allocations;
+        allocations.Bytes += frameAllocations.Bytes;
+        maxFrameAllocations = std::max(maxFrameAllocations, (uint32_t)frameAllocations.Allocations);
+
+        const FrameStats& stats = Renderer::GetFrameStats();
+        totals.DrawCalls += stats.DrawCalls;
+        totals.Quads += stats.Quads;
+        totals.BytesUploaded += stats.BytesUploaded;
+    }
+
+    // drain the queries still in flight
+    for (int frame = std::max(0, m_Options.Frames - QueryCount); frame < m_Options.Frames; frame++)
+    {
+        GLuint64 elapsed = 0;
+        GLCall(glGetQueryObjectui64v(queries[frame % QueryCount], GL_QUERY_RESULT, &elapsed));
+        gpuTotal += elapsed / 1e6;
+        gpuSamples++;
+    }
+    GLCall(glDeleteQueries(QueryCount, queries));
+
+    BenchmarkResult result;
+    result.Name = name;
+    if (!frameTimes.empty())
+    {
+        double sum = 0.0;
+        for (float time : frameTimes)
+            sum += time;
+        result.MeanMs = (float)(sum / frameTimes.size());
+        result.P50Ms = Percentile(frameTimes, 0.50f);
+        result.P95Ms = Percentile(frameTimes, 0.95f);
+        result.P99Ms = Percentile(frameTimes, 0.99f);
+
+        float frames = (float)frameTimes.size();
+        result.DrawCalls = totals.DrawCalls / frames;
+        result.Quads = totals.Quads / frames;
+        result.BytesUploaded = totals.BytesUploaded / frames;
+        result.Allocations = allocations.Allocations / frames;
+        result.AllocatedBytes = allocations.Bytes / frames;
+        result.MaxFrameAllocations = maxFrameAllocations;
+    }
+    if (gpuSamples > 0)
+        result.GpuMs = (float)(gpuTotal / gpuSamples);
+
+    if (m_Options.Overdraw)
+    {
+        OverdrawView overdraw;
+        overdraw.SetEnabled(true);
+        overdraw.Begin();
+        test->OnUpdate(deltaTime);
+        test->OnRender();
+        overdraw.End();
+        endFrame();
+        result.Overdraw = overdraw.GetAverage();
+    }
+
+    m_Results.push_back(result);
+    return result;
+}
+
+void Benchmark::WriteJson(const std::string& path) const
+{
+    std::ofstream stream(path);
+    stream << "{\n  \"frames\": " << m_Options.Frames << ",\n  \"tests\": [\n";
+    for (size_t i = 0; i < m_Results.size(); i++)
+    {
+        const BenchmarkResult& r = m_Results[i];
+        stream << "    { \"name\": \"" << EscapeJson(r.Name) << "\", \"mean_ms\": " << r.MeanMs
+            << ", \"p50_ms\": " << r.P50Ms << ", \"p95_ms\": " << r.P95Ms << ", \"p99_ms\": " << r.P99Ms
+            << ", \"gpu_ms\": " << r.GpuMs << ", \"draw_calls\": " << r.DrawCalls
+            << ", \"quads\": " << r.Quads << ", \"bytes_uploaded\": " << r.BytesUploaded
+            << ", \"overdraw\": " << r.Overdraw << ", \"allocations\": " << r.Allocations
+            << ", \"allocated_bytes\": " << r.AllocatedBytes << ", \"max_frame_allocations\": "
+            << r.MaxFrameAllocations << ", \"leaked_objects\": " << r.LeakedObjects << " }"
+            << (i + 1 < m_Results.size() ? ",\n" : "\n");
+    }
+    stream << "  ]\n}\n";
+}
+
+void Benchmark::WriteCsv(const std::string& path) const
+{
+    std::ofstream stream(path);
+    stream << "name,mean_ms,p50_ms,p95_ms,p99_ms,gpu_ms,draw_calls,quads,bytes_uploaded,overdraw,"
+        "allocations,allocated_bytes,max_frame_allocations,leaked_objects\n";
+    for (const BenchmarkResult& r : m_Results)
+    {
+        stream << '"' << r.Name << "\"," << r.MeanMs << ',' << r.P50Ms << ',' << r.P95Ms << ',' << r.P99Ms
+            << ',' << r.GpuMs << ',' << r.DrawCalls << ',' << r.Quads << ',' << r.BytesUploaded
+            << ',' << r.Overdraw << ',' << r.Allocations << ',' << r.AllocatedBytes
+            << ',' << r.MaxFrameAllocations << ',' << r.LeakedObjects << '\n';
+    }
+}
+
+int Benchmark::CompareBaseline(const std::string& path) const
+{
+    std::ifstream stream(path);
+    if (!stream)
+    {
+        std::cout << "Failed to open baseline '" << path << "'" << std::endl;
+        return 0;
+    }
+
+    // name -> mean frame time
+    std::unordered_map<std::string, float> baseline;
+    std::string line;
+    getline(stream, line); // header
+    while (getline(stream, line))
+    {
+        if (line.empty())
+            continue;
+
+        std::string name;
+        size_t rest = 0;
+        if (line[0] == '"')
+        {
+            size_t close = line.find('"', 1);
+            name = line.substr(1, close - 1);
+            rest = close + 2;
+        }
+        else
+        {
+            size_t comma = line.find(',');
+            name = line.substr(0, comma);
+            rest = comma + 1;
+        }
+        if (rest < line.size())
+            baseline[name] = (float)atof(line.c_str() + rest);
+    }
+
+    int regressions = 0;
+    for (const BenchmarkResult& r : m_Results)
+    {
+        auto it = baseline.find(r.Name);
+        if (it == baseline.end() || it->second <= 0.0f)
+            continue;
+
+        float change = r.MeanMs / it->second - 1.0f;
+        if (change > m_Options.Threshold)
+        {
+            std::cout << "REGRESSION " << r.Name << ": " << it->second << " ms -> " << r.MeanMs
+                << " ms (+" << change * 100.0f << "%)\n";
+            regressions++;
+        }
+    }
+    return regressions;
+}
+
+int Benchmark::CheckAllocations() const
+{
+    if (m_Options.MaxAllocations < 0)
+        return 0;
+
+    if (!AllocationTracker::IsEnabled())
+    {
+        std::cout << "Allocation tracking is compiled out, --max-allocations checks nothing\n";
+        return 0;
+    }
+
+    int failures = 0;
+    for (const BenchmarkResult& r : m_Results)
+    {
+        if (r.MaxFrameAllocations > (uint32_t)m_Options.MaxAllocations)
+        {
+            std::cout << "ALLOCATIONS " << r.Name << ": up to " << r.MaxFrameAllocations << " per frame, "
+                << r.Allocations << " (" << r.AllocatedBytes << " bytes) on average, "
+                << m_Options.MaxAllocations << " allowed\n";
+            failures++;
+        }
+    }
+    return failures;
+}
+
+int Benchmark::Report() const
+{
+    if (!m_Options.JsonPath.empty())
+        WriteJson(m_Options.JsonPath);
+    if (!m_Options.CsvPath.empty())
+        WriteCsv(m_Options.CsvPath);
+
+    int exitCode = 0;
+    if (!m_Options.BaselinePath.empty() && CompareBaseline(m_Options.BaselinePath) > 0)
+        exitCode = 1;
+    if (CheckAllocations() > 0)
+        exitCode = 1;
+    if (m_Options.FailOnLeaks)
+    {
+        for (const BenchmarkResult& r : m_Results)
+        {
+            if (r.LeakedObjects > 0)
+                exitCode = 1;
+        }
+    }
+    return exitCode;
+}
+
+static double MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+int RunSceneLoadBenchmark(const std::vector<uint32_t>& spriteCounts)
+{
+    std::cout << "sprites, file MB, write ms, map ms, first touch ms, read ms\n";
+    int exitCode = 0;
+    for (uint32_t count : spriteCounts)
+    {
+        std::string path = "bench_" + std::to_string(count) + ".scene";
+
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            SceneWriter writer;
+            GenerateScene(writer, count);
+            start = std::chrono::high_resolution_clock::now();
+            if (!writer.Write(path))
+            {
+                exitCode = 1;
+                continue;
+            }
+        }
+        double writeMs = MillisecondsSince(start);
+
+        // the file was just written so it's in the page cache, these are warm numbers
+        SceneFile scene;
+        start = std::chrono::high_resolution_clock::now();
+        bool opened = scene.Open(path);
+        double mapMs = MillisecondsSince(start);
+        if (!opened)
+        {
+            exitCode = 1;
+            std::remove(path.c_str());
+            continue;
+        }
+
+        // what a frame drawing everything would touch, the pages get mapped in here
+        start = std::chrono::high_resolution_clock::now();
+        float sum = 0.0f;
+        uint32_t colors = 0;
+        for (uint32_t i = 0; i < scene.GetSpriteCount(); i++)
+        {
+            sum += scene.GetPositionX()[i] + scene.GetPositionY()[i] + scene.GetSizeX()[i] + scene.GetSizeY()[i];
+            colors ^= scene.GetColors()[i] + scene.GetTextureIndices()[i];
+        }
+        double touchMs = MillisecondsSince(start);
+
+        // the least a loader copying the file into memory pays, before any parsing
+        start = std::chrono::high_resolution_clock::now();
+        size_t bytes = 0;
+        {
+            std::ifstream stream(path, std::ios::binary);
+            std::vector<char> contents(scene.GetFileSize());
+            stream.read(contents.data(), contents.size());
+            bytes = (size_t)stream.gcount();
+        }
+        double readMs = MillisecondsSince(start);
+
+        std::cout << count << ", " << scene.GetFileSize() / (1024.0 * 1024.0) << ", " << writeMs << ", "
+            << mapMs << ", " << touchMs << ", " << readMs << "\n";
+        // keeps the touch loop from being optimized out
+        if (bytes != scene.GetFileSize() || (sum < 0.0f && colors == 0))
+            std::cout << "Read " << bytes << " of " << scene.GetFileSize() << " bytes\n";
+
+        scene.Close();
+        std::remove(path.c_str());
+    }
+    return exitCode;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "tests/Test.h"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions
+{
+	int WarmupFrames = 10;
+	int Frames = 200;
+	// only tests whose name contains this run
+	std::string Filter;
+	std::string JsonPath, CsvPath;
+	// csv written by an earlier run, compared against mean frame time
+	std::string BaselinePath;
+	float Threshold = 0.10f;
+	// renders one extra, untimed frame per test with fragment counting
+	bool Overdraw = false;
+	// heap allocations any measured frame may make before the run fails, -1 doesn't check
+	int MaxAllocations = -1;
+	// a test leaving GL objects behind after it's deleted fails the run
+	bool FailOnLeaks = false;
+	// command stream of the last RecordFrames warmup frames of the first test, for --replay
+	std::string RecordPath;
+	int RecordFrames = 1;
+};
+
+struct BenchmarkResult
+{
+	std::string Name;
+	float MeanMs = 0.0f, P50Ms = 0.0f, P95Ms = 0.0f, P99Ms = 0.0f;
+	float GpuMs = 0.0f;
+	// per frame averages
+	float DrawCalls = 0.0f, Quads = 0.0f, BytesUploaded = 0.0f;
+	// shaded fragments per pixel, 0 unless measured
+	float Overdraw = 0.0f;
+	// operator new calls per frame, on average and in the worst frame
+	float Allocations = 0.0f, AllocatedBytes = 0.0f;
+	uint32_t MaxFrameAllocations = 0;
+	// GL objects the test created and didn't delete
+	uint32_t LeakedObjects = 0;
+};
+
+class Benchmark
+{
+public:
+	Benchmark(const BenchmarkOptions& options);
+
+	// endFrame presents the frame, a buffer swap or a glFinish when headless
+	void RunAll(const test::TestMenu& menu, const std::function<void()>& endFrame);
+	BenchmarkResult Run(const std::string& name, test::Test* test, const std::function<void()>& endFrame);
+
+	void WriteJson(const std::string& path) const;
+	void WriteCsv(const std::string& path) const;
+
+	// prints every test slower than the baseline by more than the threshold, returns how many
+	int CompareBaseline(const std::string& path) const;
+	// prints every test with a frame above MaxAllocations, returns how many
+	int CheckAllocations() const;
+
+	// writes the requested reports, returns a non-zero exit code on regressions, allocations
+	// or, with FailOnLeaks, leaked GL objects
+	int Report() const;
+
+	inline const std::vector<BenchmarkResult>& GetResults() const { return m_Results; }
+
+private:
+	BenchmarkOptions m_Options;
+	std::vector<BenchmarkResult> m_Results;
+	bool m_Recorded = false;
+};
+
+// writes a generated scene per count to the working directory and times opening it
+// mapped against reading the file into memory, no GL needed, returns an exit code
+int RunSceneLoadBenchmark(const std::vector<uint32_t>& spriteCounts);
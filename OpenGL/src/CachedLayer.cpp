@@ -0,0 +1,104 @@
+#include "CachedLayer.h"
+
+#include "CommandCapture.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include "ResourceManager.h"
+
+CachedLayer::CachedLayer()
+    : m_Valid(false), m_Active(false), m_RebuildCount(0), m_PreviousFramebuffer(0),
+    m_PreviousViewport{}, m_PreviousBlend{}
+{
+    m_Shader = ResourceManager::Get().GetShader("res/shaders/Composite.shader");
+
+    // sampled 1:1, depth so the sorted batch path works inside the layer too
+    FramebufferSpec spec;
+    spec.Filter = GL_NEAREST;
+    m_Framebuffer = Framebuffer(spec);
+}
+
+CachedLayer::~CachedLayer()
+{
+}
+
+bool CachedLayer::Begin()
+{
+    GLCall(glGetIntegerv(GL_VIEWPORT, m_PreviousViewport));
+    if (m_PreviousViewport[2] <= 0 || m_PreviousViewport[3] <= 0)
+        return false;
+    if (m_Framebuffer.Resize(m_PreviousViewport[2], m_PreviousViewport[3]))
+        m_Valid = false;
+    if (m_Valid)
+        return false;
+
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_PreviousFramebuffer));
+    m_Framebuffer.Bind();
+
+    GLfloat clearColor[4];
+    GLCall(glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor));
+    GLCall(glClearColor(0.0f, 0.0f, 0.0f, 0.0f));
+    Renderer::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    GLCall(glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]));
+
+    // alpha accumulates like it would over the opaque back buffer, color comes out
+    // premultiplied so the composite blends the same as drawing directly would
+    GLCall(glGetIntegerv(GL_BLEND_SRC_RGB, &m_PreviousBlend[0]));
+    GLCall(glGetIntegerv(GL_BLEND_DST_RGB, &m_PreviousBlend[1]));
+    GLCall(glGetIntegerv(GL_BLEND_SRC_ALPHA, &m_PreviousBlend[2]));
+    GLCall(glGetIntegerv(GL_BLEND_DST_ALPHA, &m_PreviousBlend[3]));
+    GLCall(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+
+    m_Active = true;
+    m_RebuildCount++;
+    return true;
+}
+
+void CachedLayer::End()
+{
+    if (!m_Active)
+        return;
+    m_Active = false;
+    m_Valid = true;
+
+    GLCall(glBlendFuncSeparate(m_PreviousBlend[0], m_PreviousBlend[1], m_PreviousBlend[2], m_PreviousBlend[3]));
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_PreviousFramebuffer));
+    GLCall(glViewport(m_PreviousViewport[0], m_PreviousViewport[1], m_PreviousViewport[2], m_PreviousViewport[3]));
+}
+
+void CachedLayer::Composite()
+{
+    if (!m_Valid)
+        return;
+
+    PROFILE_SCOPE("Composite layer");
+
+    GLboolean blend, depthTest;
+    GLCall(blend = glIsEnabled(GL_BLEND));
+    GLCall(depthTest = glIsEnabled(GL_DEPTH_TEST));
+    GLint blendFunc[4];
+    GLCall(glGetIntegerv(GL_BLEND_SRC_RGB, &blendFunc[0]));
+    GLCall(glGetIntegerv(GL_BLEND_DST_RGB, &blendFunc[1]));
+    GLCall(glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendFunc[2]));
+    GLCall(glGetIntegerv(GL_BLEND_DST_ALPHA, &blendFunc[3]));
+    GLCall(glEnable(GL_BLEND));
+    GLCall(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+    GLCall(glDisable(GL_DEPTH_TEST));
+
+    m_Shader->Bind();
+    GLCall(glBindTextureUnit(0, m_Framebuffer.GetColorAttachment()));
+    m_Shader->SetUniform1i("u_Layer", 0);
+    m_EmptyVAO.Bind();
+    CommandCapture::Get().RecordDraw(GL_TRIANGLES, 3, 0, 0);
+    GLCall(glDrawArrays(GL_TRIANGLES, 0, 3));
+    Renderer::GetFrameStats().DrawCalls++;
+
+    GLCall(glBlendFuncSeparate(blendFunc[0], blendFunc[1], blendFunc[2], blendFunc[3]));
+    if (!blend)
+    {
+        GLCall(glDisable(GL_BLEND));
+    }
+    if (depthTest)
+    {
+        GLCall(glEnable(GL_DEPTH_TEST));
+    }
+}
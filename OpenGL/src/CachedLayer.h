@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Framebuffer.h"
+#include "Shader.h"
+#include "VertexArray.h"
+
+#include <memory>
+
+// static part of a scene rendered once into a texture and drawn as a single fullscreen
+// triangle every frame after that, until it's invalidated or the viewport changes:
+//
+//     if (layer.Begin())
+//     {
+//         ...draw the layer...
+//         layer.End();
+//     }
+//     layer.Composite();
+class CachedLayer
+{
+public:
+	CachedLayer();
+	~CachedLayer();
+
+	CachedLayer(const CachedLayer&) = delete;
+	CachedLayer& operator=(const CachedLayer&) = delete;
+
+	// true when the cached image is stale, the layer's framebuffer is then bound sized to
+	// the current viewport and cleared to transparent, draw it and call End
+	bool Begin();
+	// restores the framebuffer and viewport from Begin
+	void End();
+	// draws the cached image over the current framebuffer
+	void Composite();
+
+	// the next Begin redraws, e.g. after the view moved
+	inline void Invalidate() { m_Valid = false; }
+	inline bool IsValid() const { return m_Valid; }
+	// how often the layer had to be drawn again
+	inline unsigned int GetRebuildCount() const { return m_RebuildCount; }
+	inline const Framebuffer& GetFramebuffer() const { return m_Framebuffer; }
+
+private:
+	Framebuffer m_Framebuffer;
+	bool m_Valid;
+	bool m_Active;
+	unsigned int m_RebuildCount;
+
+	// state restored by End
+	int m_PreviousFramebuffer;
+	int m_PreviousViewport[4];
+	int m_PreviousBlend[4];
+
+	std::shared_ptr<Shader> m_Shader;
+	// bound for the fullscreen triangle, core profile draws need one
+	VertexArray m_EmptyVAO;
+};
@@ -0,0 +1,331 @@
+#include "ChunkStreamer.h"
+
+#include "GpuMemoryTracker.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include "ResourceManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+ChunkStreamer::ChunkStreamer(const SceneFile& scene)
+    : m_Scene(scene)
+{
+    const SceneHeader& header = m_Scene.GetHeader();
+
+    // one slot per distinct file, atlas regions of the same file share it
+    m_EntrySlots.resize(header.TextureCount, 0.0f);
+    std::vector<std::string> paths;
+    for (uint32_t i = 0; i < header.TextureCount; i++)
+    {
+        const SceneTexture& entry = m_Scene.GetTexture(i);
+        std::string path(entry.Path, strnlen(entry.Path, sizeof(entry.Path)));
+        auto it = std::find(paths.begin(), paths.end(), path);
+        if (it == paths.end())
+        {
+            if (paths.size() >= BatchRenderer::GetMaxTextures() - 1)
+            {
+                std::cout << "Chunk streaming supports " << BatchRenderer::GetMaxTextures() - 1
+                    << " textures, '" << path << "' is drawn untextured" << std::endl;
+                continue;
+            }
+            paths.push_back(path);
+            m_Textures.push_back(ResourceManager::Get().GetTexture(path));
+            m_TextureIDs.push_back(m_Textures.back()->GetRendererID());
+            it = paths.end() - 1;
+        }
+        m_EntrySlots[i] = (float)(it - paths.begin() + 1);
+    }
+
+    // a pathological scene with one huge chunk makes every pooled buffer huge, the
+    // writer's chunk size is what keeps this reasonable
+    uint32_t largest = 0;
+    for (uint32_t y = 0; y < header.ChunkRows; y++)
+    {
+        for (uint32_t x = 0; x < header.ChunkColumns; x++)
+            largest = std::max(largest, m_Scene.GetChunk(x, y).Count);
+    }
+    m_BufferSize = std::max<size_t>(largest, 1) * 4 * sizeof(BatchRenderer::Vertex);
+
+    m_Loader = std::thread(&ChunkStreamer::LoaderLoop, this);
+}
+
+ChunkStreamer::~ChunkStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_one();
+    m_Loader.join();
+
+    for (unsigned int buffer : m_Buffers)
+    {
+        GPU_UNTRACK(GpuResourceType::Buffer, buffer);
+        GLCall(glDeleteBuffers(1, &buffer));
+    }
+}
+
+void ChunkStreamer::LoaderLoop()
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    while (true)
+    {
+        m_Wake.wait(lock, [this]() { return m_Stop || !m_Queue.empty(); });
+        if (m_Stop)
+            return;
+
+        Request request = m_Queue.front();
+        m_Queue.pop_front();
+        std::vector<BatchRenderer::Vertex> vertices;
+        if (!m_FreeStaging.empty())
+        {
+            vertices = std::move(m_FreeStaging.back());
+            m_FreeStaging.pop_back();
+        }
+        lock.unlock();
+
+        // reading the sprites is what pages the chunk in, it isn't needed afterwards
+        BuildVertices(request.Chunk, vertices);
+        m_Scene.ReleaseChunk(request.Chunk);
+
+        lock.lock();
+        m_Finished.push_back({ request.Key, request.Chunk.Count, std::move(vertices) });
+    }
+}
+
+void ChunkStreamer::BuildVertices(const SceneChunk& chunk, std::vector<BatchRenderer::Vertex>& vertices) const
+{
+    const float* positionX = m_Scene.GetPositionX() + chunk.First;
+    const float* positionY = m_Scene.GetPositionY() + chunk.First;
+    const float* sizeX = m_Scene.GetSizeX() + chunk.First;
+    const float* sizeY = m_Scene.GetSizeY() + chunk.First;
+    const uint32_t* colors = m_Scene.GetColors() + chunk.First;
+    const uint16_t* textures = m_Scene.GetTextureIndices() + chunk.First;
+
+    // same corner order and uvs as the batcher's quads so its index buffer fits
+    vertices.resize((size_t)chunk.Count * 4);
+    BatchRenderer::Vertex* vertex = vertices.data();
+    for (uint32_t i = 0; i < chunk.Count; i++)
+    {
+        uint32_t packed = colors[i];
+        glm::vec4 color = glm::vec4(packed & 0xff, packed >> 8 & 0xff, packed >> 16 & 0xff, packed >> 24) / 255.0f;
+
+        glm::vec2 uvMin = { 0.0f, 0.0f }, uvMax = { 1.0f, 1.0f };
+        float slot = 0.0f;
+        if (textures[i] < m_EntrySlots.size())
+        {
+            const SceneTexture& entry = m_Scene.GetTexture(textures[i]);
+            uvMin = { entry.UVMin[0], entry.UVMin[1] };
+            uvMax = { entry.UVMax[0], entry.UVMax[1] };
+            slot = m_EntrySlots[textures[i]];
+        }
+
+        float x0 = positionX[i], y0 = positionY[i];
+        float x1 = x0 + sizeX[i], y1 = y0 + sizeY[i];
+        vertex[0] = { { x0, y0, 0.0f }, uvMin, color, slot };
+        vertex[1] = { { x1, y0, 0.0f }, { uvMax.x, uvMin.y }, color, slot };
+        vertex[2] = { { x1, y1, 0.0f }, uvMax, color, slot };
+        vertex[3] = { { x0, y1, 0.0f }, { uvMin.x, uvMax.y }, color, slot };
+        vertex += 4;
+    }
+}
+
+unsigned int ChunkStreamer::AcquireBuffer()
+{
+    if (!m_FreeBuffers.empty())
+    {
+        unsigned int buffer = m_FreeBuffers.back();
+        m_FreeBuffers.pop_back();
+        return buffer;
+    }
+
+    unsigned int buffer;
+    GLCall(glCreateBuffers(1, &buffer));
+    GLCall(glNamedBufferStorage(buffer, m_BufferSize, nullptr, GL_DYNAMIC_STORAGE_BIT));
+    GPU_TRACK(GpuResourceType::Buffer, buffer, m_BufferSize, "Scene chunk");
+    m_Buffers.push_back(buffer);
+    return buffer;
+}
+
+void ChunkStreamer::ReleaseBuffer(unsigned int buffer)
+{
+    m_FreeBuffers.push_back(buffer);
+}
+
+void ChunkStreamer::Evict(uint64_t key)
+{
+    auto it = m_Resident.find(key);
+    if (it == m_Resident.end())
+        return;
+
+    if (it->second.Buffer)
+        ReleaseBuffer(it->second.Buffer);
+    m_Resident.erase(it);
+    m_Stats.Evicted++;
+}
+
+void ChunkStreamer::Update(const glm::vec2& viewMin, const glm::vec2& viewMax)
+{
+    PROFILE_SCOPE("ChunkStreamer::Update");
+
+    const SceneHeader& header = m_Scene.GetHeader();
+
+    // everything in the view plus the margin, nearest first, as much as the cap allows
+    m_Wanted.clear();
+    glm::ivec2 first, last;
+    glm::vec2 margin = glm::vec2(m_PrefetchMargin);
+    if (m_Scene.GetChunkRange(viewMin - margin, viewMax + margin, first, last))
+    {
+        glm::vec2 center = (viewMin + viewMax) * 0.5f;
+        glm::vec2 origin = { header.ChunkMinX, header.ChunkMinY };
+        for (int y = first.y; y <= last.y; y++)
+        {
+            for (int x = first.x; x <= last.x; x++)
+            {
+                glm::vec2 chunkCenter = origin + (glm::vec2(x, y) + 0.5f) * header.ChunkSize;
+                glm::vec2 offset = chunkCenter - center;
+                m_Wanted.push_back({ glm::dot(offset, offset), MakeKey(x, y) });
+            }
+        }
+        std::sort(m_Wanted.begin(), m_Wanted.end());
+        if (m_Wanted.size() > m_MaxResidentChunks)
+            m_Wanted.resize(m_MaxResidentChunks);
+    }
+    m_WantedKeys.clear();
+    for (const auto& wanted : m_Wanted)
+        m_WantedKeys.push_back(wanted.second);
+    std::sort(m_WantedKeys.begin(), m_WantedKeys.end());
+    const auto isWanted = [this](uint64_t key) {
+        return std::binary_search(m_WantedKeys.begin(), m_WantedKeys.end(), key);
+    };
+
+    m_Evict.clear();
+    for (const auto& resident : m_Resident)
+    {
+        if (!isWanted(resident.first))
+            m_Evict.push_back(resident.first);
+    }
+    for (uint64_t key : m_Evict)
+        Evict(key);
+
+    // a lowered cap leaves spare buffers in the pool
+    while (!m_FreeBuffers.empty() && m_Buffers.size() > m_MaxResidentChunks)
+    {
+        unsigned int buffer = m_FreeBuffers.back();
+        m_FreeBuffers.pop_back();
+        m_Buffers.erase(std::find(m_Buffers.begin(), m_Buffers.end(), buffer));
+        GPU_UNTRACK(GpuResourceType::Buffer, buffer);
+        GLCall(glDeleteBuffers(1, &buffer));
+    }
+
+    m_Uploads.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+
+        // requests the loader hasn't started are rebuilt from the current view, the
+        // nearest missing chunks go first
+        for (const Request& request : m_Queue)
+            m_InFlight.erase(request.Key);
+        m_Queue.clear();
+        for (const auto& wanted : m_Wanted)
+        {
+            uint64_t key = wanted.second;
+            if (m_Queue.size() >= MaxQueuedLoads)
+                break;
+            if (m_Resident.count(key) || m_InFlight.count(key))
+                continue;
+
+            const SceneChunk& chunk = m_Scene.GetChunk((uint32_t)key, (uint32_t)(key >> 32));
+            if (chunk.Count == 0)
+            {
+                m_Resident[key] = { 0, 0 };
+                continue;
+            }
+            m_Queue.push_back({ key, chunk });
+            m_InFlight.insert(key);
+        }
+
+        size_t count = std::min(m_Finished.size(), (size_t)MaxUploadsPerFrame);
+        for (size_t i = 0; i < count; i++)
+            m_Uploads.push_back(std::move(m_Finished[i]));
+        m_Finished.erase(m_Finished.begin(), m_Finished.begin() + count);
+
+        m_Stats.QueuedLoads = (uint32_t)m_Queue.size();
+    }
+    m_Wake.notify_one();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (LoadedChunk& loaded : m_Uploads)
+    {
+        m_InFlight.erase(loaded.Key);
+        // the view moved on while it was loading
+        if (!isWanted(loaded.Key) || m_Resident.count(loaded.Key))
+        {
+            m_Stats.Discarded++;
+            continue;
+        }
+
+        unsigned int buffer = AcquireBuffer();
+        size_t size = loaded.Vertices.size() * sizeof(BatchRenderer::Vertex);
+        GLCall(glNamedBufferSubData(buffer, 0, size, loaded.Vertices.data()));
+        Renderer::GetFrameStats().BytesUploaded += size;
+        m_Resident[loaded.Key] = { buffer, loaded.Count };
+        m_Stats.Loaded++;
+    }
+    m_Stats.UploadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (LoadedChunk& loaded : m_Uploads)
+            m_FreeStaging.push_back(std::move(loaded.Vertices));
+        // recycled up to the queue length, more would only ever sit there
+        if (m_FreeStaging.size() > MaxQueuedLoads)
+            m_FreeStaging.resize(MaxQueuedLoads);
+
+        m_Stats.StagingBytes = 0;
+        for (const auto& staging : m_FreeStaging)
+            m_Stats.StagingBytes += staging.capacity() * sizeof(BatchRenderer::Vertex);
+        for (const LoadedChunk& loaded : m_Finished)
+            m_Stats.StagingBytes += loaded.Vertices.capacity() * sizeof(BatchRenderer::Vertex);
+    }
+
+    m_Stats.ResidentChunks = (uint32_t)m_Resident.size();
+    m_Stats.PooledBuffers = (uint32_t)m_Buffers.size();
+    m_Stats.FreeBuffers = (uint32_t)m_FreeBuffers.size();
+    m_Stats.GpuBytes = (uint64_t)m_Buffers.size() * m_BufferSize;
+}
+
+size_t ChunkStreamer::Draw(BatchRenderer& renderer, const glm::vec2& viewMin, const glm::vec2& viewMax)
+{
+    PROFILE_SCOPE("ChunkStreamer::Draw");
+
+    m_Stats.VisibleChunks = 0;
+    m_Stats.MissingChunks = 0;
+
+    glm::ivec2 first, last;
+    if (!m_Scene.GetChunkRange(viewMin, viewMax, first, last))
+        return 0;
+
+    size_t sprites = 0;
+    for (int y = first.y; y <= last.y; y++)
+    {
+        for (int x = first.x; x <= last.x; x++)
+        {
+            m_Stats.VisibleChunks++;
+            auto it = m_Resident.find(MakeKey(x, y));
+            if (it == m_Resident.end())
+            {
+                m_Stats.MissingChunks++;
+                continue;
+            }
+
+            const ResidentChunk& chunk = it->second;
+            renderer.DrawStaticQuads(chunk.Buffer, chunk.Count, m_TextureIDs.data(), (uint32_t)m_TextureIDs.size());
+            sprites += chunk.Count;
+        }
+    }
+    return sprites;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "BatchRenderer.h"
+#include "SceneFile.h"
+
+#include "glm/glm.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// keeps the chunks of a scene file around the camera on the GPU: a loader thread turns
+// chunk sprites into quad vertices, Update uploads them into pooled vertex buffers and
+// evicts chunks that fell out of the view plus its prefetch margin, so resident memory
+// depends on the view size and not on the size of the world
+class ChunkStreamer
+{
+public:
+	// finished loads uploaded per Update, bounds the upload cost of a frame
+	static const int MaxUploadsPerFrame = 8;
+	// queued ahead of the loader, requests are re-prioritized every Update
+	static const int MaxQueuedLoads = 32;
+
+	struct Stats
+	{
+		uint32_t ResidentChunks = 0;
+		uint32_t QueuedLoads = 0;
+		// visible chunks that weren't resident yet when drawn
+		uint32_t MissingChunks = 0;
+		uint32_t VisibleChunks = 0;
+		// totals since construction
+		uint64_t Loaded = 0, Evicted = 0, Discarded = 0;
+		// vertex buffers created, the rest of the time they're recycled
+		uint32_t PooledBuffers = 0, FreeBuffers = 0;
+		uint64_t GpuBytes = 0;
+		// staging vertices waiting for upload or kept for reuse
+		uint64_t StagingBytes = 0;
+		double UploadMs = 0.0;
+	};
+
+	// the scene has to stay open while the streamer exists
+	ChunkStreamer(const SceneFile& scene);
+	~ChunkStreamer();
+
+	ChunkStreamer(const ChunkStreamer&) = delete;
+	ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+	// world units around the view that are loaded before they become visible
+	inline void SetPrefetchMargin(float margin) { m_PrefetchMargin = margin; }
+	inline float GetPrefetchMargin() const { return m_PrefetchMargin; }
+	// hard cap, the chunks nearest the view win when the wanted area needs more
+	inline void SetMaxResidentChunks(uint32_t count) { m_MaxResidentChunks = count; }
+	inline uint32_t GetMaxResidentChunks() const { return m_MaxResidentChunks; }
+
+	// queues what the view needs, evicts what it doesn't and uploads finished loads
+	void Update(const glm::vec2& viewMin, const glm::vec2& viewMax);
+	// one draw per resident chunk overlapping the view, returns the sprites drawn
+	size_t Draw(BatchRenderer& renderer, const glm::vec2& viewMin, const glm::vec2& viewMax);
+
+	inline const Stats& GetStats() const { return m_Stats; }
+
+private:
+	struct Request
+	{
+		uint64_t Key;
+		SceneChunk Chunk;
+	};
+
+	struct LoadedChunk
+	{
+		uint64_t Key;
+		uint32_t Count;
+		std::vector<BatchRenderer::Vertex> Vertices;
+	};
+
+	struct ResidentChunk
+	{
+		// 0 for chunks without sprites, they take no buffer
+		unsigned int Buffer;
+		uint32_t Count;
+	};
+
+	static inline uint64_t MakeKey(uint32_t x, uint32_t y) { return (uint64_t)y << 32 | x; }
+
+	void LoaderLoop();
+	void BuildVertices(const SceneChunk& chunk, std::vector<BatchRenderer::Vertex>& vertices) const;
+
+	unsigned int AcquireBuffer();
+	void ReleaseBuffer(unsigned int buffer);
+	void Evict(uint64_t key);
+
+	const SceneFile& m_Scene;
+	float m_PrefetchMargin = 512.0f;
+	uint32_t m_MaxResidentChunks = 256;
+
+	// per scene texture entry, read by the loader, fixed after construction
+	std::vector<float> m_EntrySlots;
+	// distinct GL textures, slot n + 1 in the batch shader
+	std::vector<std::shared_ptr<Texture>> m_Textures;
+	std::vector<uint32_t> m_TextureIDs;
+
+	// every pooled buffer holds the largest chunk
+	size_t m_BufferSize = 0;
+	std::vector<unsigned int> m_Buffers;
+	std::vector<unsigned int> m_FreeBuffers;
+	std::unordered_map<uint64_t, ResidentChunk> m_Resident;
+
+	// loader side, guarded by m_Mutex
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::deque<Request> m_Queue;
+	std::vector<LoadedChunk> m_Finished;
+	std::vector<std::vector<BatchRenderer::Vertex>> m_FreeStaging;
+	// queued or being built, main thread only
+	std::unordered_set<uint64_t> m_InFlight;
+	bool m_Stop = false;
+	std::thread m_Loader;
+
+	// scratch for Update, wanted chunks nearest first and their keys sorted
+	std::vector<std::pair<float, uint64_t>> m_Wanted;
+	std::vector<uint64_t> m_WantedKeys;
+	std::vector<uint64_t> m_Evict;
+	std::vector<LoadedChunk> m_Uploads;
+
+	Stats m_Stats;
+};
@@ -0,0 +1,746 @@
+#include "CommandCapture.h"
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+int GetCaptureUniformComponents(GLenum type)
+{
+    switch (type)
+    {
+    case GL_FLOAT: case GL_INT: case GL_UNSIGNED_INT: case GL_BOOL:
+        return 1;
+    case GL_FLOAT_VEC2: case GL_INT_VEC2: case GL_UNSIGNED_INT_VEC2: case GL_BOOL_VEC2:
+        return 2;
+    case GL_FLOAT_VEC3: case GL_INT_VEC3: case GL_UNSIGNED_INT_VEC3: case GL_BOOL_VEC3:
+        return 3;
+    case GL_FLOAT_VEC4: case GL_INT_VEC4: case GL_UNSIGNED_INT_VEC4: case GL_BOOL_VEC4:
+    case GL_FLOAT_MAT2:
+        return 4;
+    case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT3x2:
+        return 6;
+    case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT4x2:
+        return 8;
+    case GL_FLOAT_MAT3:
+        return 9;
+    case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x3:
+        return 12;
+    case GL_FLOAT_MAT4:
+        return 16;
+    default:
+        return IsCaptureSampler(type) ? 1 : 0;
+    }
+}
+
+bool IsCaptureSampler(GLenum type)
+{
+    return type == GL_SAMPLER_2D || type == GL_INT_SAMPLER_2D || type == GL_UNSIGNED_INT_SAMPLER_2D
+        || type == GL_SAMPLER_2D_SHADOW;
+}
+
+static uint64_t HashBytes(const void* data, size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < size; i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+static bool IsFloatUniform(GLenum type)
+{
+    switch (type)
+    {
+    case GL_FLOAT: case GL_FLOAT_VEC2: case GL_FLOAT_VEC3: case GL_FLOAT_VEC4:
+    case GL_FLOAT_MAT2: case GL_FLOAT_MAT3: case GL_FLOAT_MAT4:
+    case GL_FLOAT_MAT2x3: case GL_FLOAT_MAT2x4: case GL_FLOAT_MAT3x2:
+    case GL_FLOAT_MAT3x4: case GL_FLOAT_MAT4x2: case GL_FLOAT_MAT4x3:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool IsUnsignedUniform(GLenum type)
+{
+    return type == GL_UNSIGNED_INT || type == GL_UNSIGNED_INT_VEC2 || type == GL_UNSIGNED_INT_VEC3
+        || type == GL_UNSIGNED_INT_VEC4;
+}
+
+static uint32_t GetIndexSize(GLenum type)
+{
+    return type == GL_UNSIGNED_BYTE ? 1 : type == GL_UNSIGNED_SHORT ? 2 : 4;
+}
+
+CommandCapture& CommandCapture::Get()
+{
+    static CommandCapture capture;
+    return capture;
+}
+
+void CommandCapture::Start(const std::string& path, int frameCount)
+{
+    Reset();
+    m_Path = path;
+    m_FramesLeft = std::max(frameCount, 1);
+}
+
+void CommandCapture::SetDefaults(const std::string& path, int frameCount)
+{
+    m_DefaultPath = path;
+    m_DefaultFrames = std::max(frameCount, 1);
+}
+
+void CommandCapture::Stop()
+{
+    if (m_FramesLeft == 0)
+        return;
+
+    if (m_Recording)
+        EndFrame();
+    if (m_FramesLeft > 0 && m_FrameCount > 0)
+        WriteFile();
+    m_FramesLeft = 0;
+    Reset();
+}
+
+void CommandCapture::Reset()
+{
+    m_Recording = false;
+    m_FrameCount = 0;
+    m_Setup.clear();
+    m_Frames.clear();
+    m_Blobs.clear();
+    m_BlobLookup.clear();
+    m_Programs.clear();
+    m_Textures.clear();
+    m_Renderbuffers.clear();
+    m_Framebuffers.clear();
+    m_Buffers.clear();
+    m_HasState = false;
+    m_Draws = 0;
+    m_SkippedDraws = 0;
+}
+
+void CommandCapture::BeginFrame()
+{
+    if (m_FramesLeft <= 0 || m_Recording)
+        return;
+
+    if (m_FrameCount == 0)
+    {
+        GLint viewport[4];
+        GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_OutputFramebuffer));
+        GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+        m_Width = viewport[2];
+        m_Height = viewport[3];
+    }
+    // every frame starts with the whole state, a looping replay enters it from the last frame
+    m_HasState = false;
+    m_Recording = true;
+}
+
+void CommandCapture::EndFrame()
+{
+    if (!m_Recording)
+        return;
+
+    Append(m_Frames, CaptureCommand::EndFrame);
+    m_Recording = false;
+    m_FrameCount++;
+    if (--m_FramesLeft == 0)
+    {
+        WriteFile();
+        Reset();
+    }
+}
+
+void CommandCapture::RegisterProgram(unsigned int program, const std::string& vertexSource,
+    const std::string& fragmentSource, const std::string& name)
+{
+    m_Sources[program] = { vertexSource, fragmentSource, name };
+}
+
+void CommandCapture::UnregisterProgram(unsigned int program)
+{
+    m_Sources.erase(program);
+    m_Uniforms.erase(program);
+    m_Missing.erase(program);
+}
+
+uint32_t CommandCapture::AddBlob(const void* data, size_t size)
+{
+    uint64_t hash = HashBytes(data, size);
+    std::vector<uint32_t>& candidates = m_BlobLookup[hash];
+    for (uint32_t index : candidates)
+    {
+        const std::vector<uint8_t>& blob = m_Blobs[index];
+        if (blob.size() == size && (size == 0 || std::memcmp(blob.data(), data, size) == 0))
+            return index;
+    }
+
+    uint32_t index = (uint32_t)m_Blobs.size();
+    const uint8_t* bytes = (const uint8_t*)data;
+    m_Blobs.emplace_back(bytes, bytes + size);
+    candidates.push_back(index);
+    return index;
+}
+
+bool CommandCapture::RecordProgram(unsigned int program)
+{
+    if (m_Programs.count(program))
+        return true;
+
+    auto it = m_Sources.find(program);
+    if (it == m_Sources.end())
+    {
+        if (m_Missing.insert(program).second)
+            std::cout << "Command capture: program " << program << " has no sources, its draws are skipped" << std::endl;
+        return false;
+    }
+
+    const ProgramSource& source = it->second;
+    CaptureProgram command;
+    command.ID = program;
+    command.VertexSource = AddBlob(source.Vertex.data(), source.Vertex.size());
+    command.FragmentSource = AddBlob(source.Fragment.data(), source.Fragment.size());
+    command.Name = AddBlob(source.Name.data(), source.Name.size());
+    Append(m_Setup, CaptureCommand::Program);
+    Append(m_Setup, command);
+    m_Programs.insert(program);
+    return true;
+}
+
+void CommandCapture::RecordTexture(unsigned int texture)
+{
+    if (!m_Textures.insert(texture).second)
+        return;
+
+    CaptureTexture command;
+    command.ID = texture;
+    GLint width, height, format, redType, value;
+    GLCall(glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width));
+    GLCall(glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height));
+    GLCall(glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &format));
+    GLCall(glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_RED_TYPE, &redType));
+    command.Width = width;
+    command.Height = height;
+    command.Format = format;
+    GLCall(glGetTextureParameteriv(texture, GL_TEXTURE_MIN_FILTER, &value));
+    command.MinFilter = value;
+    GLCall(glGetTextureParameteriv(texture, GL_TEXTURE_MAG_FILTER, &value));
+    command.MagFilter = value;
+    GLCall(glGetTextureParameteriv(texture, GL_TEXTURE_WRAP_S, &value));
+    command.WrapS = value;
+    GLCall(glGetTextureParameteriv(texture, GL_TEXTURE_WRAP_T, &value));
+    command.WrapT = value;
+    GLCall(glGetTextureParameteriv(texture, GL_DEPTH_STENCIL_TEXTURE_MODE, &value));
+    command.DepthStencilMode = value;
+
+    // the contents at first use: render targets get drawn over by the replay anyway
+    command.Pixels = CaptureNoBlob;
+    bool normalized = redType == GL_UNSIGNED_NORMALIZED || redType == GL_SIGNED_NORMALIZED || redType == GL_FLOAT;
+    if (normalized && width > 0 && height > 0)
+    {
+        size_t size = (size_t)width * height * 4;
+        m_Scratch.resize(size);
+        GLCall(glGetTextureImage(texture, 0, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)size, m_Scratch.data()));
+        command.Pixels = AddBlob(m_Scratch.data(), size);
+    }
+
+    Append(m_Setup, CaptureCommand::Texture);
+    Append(m_Setup, command);
+}
+
+void CommandCapture::RecordRenderbuffer(unsigned int renderbuffer)
+{
+    if (!m_Renderbuffers.insert(renderbuffer).second)
+        return;
+
+    CaptureRenderbuffer command;
+    command.ID = renderbuffer;
+    GLint value;
+    GLCall(glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_WIDTH, &value));
+    command.Width = value;
+    GLCall(glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_HEIGHT, &value));
+    command.Height = value;
+    GLCall(glGetNamedRenderbufferParameteriv(renderbuffer, GL_RENDERBUFFER_INTERNAL_FORMAT, &value));
+    command.Format = value;
+    Append(m_Setup, CaptureCommand::Renderbuffer);
+    Append(m_Setup, command);
+}
+
+uint32_t CommandCapture::RecordFramebuffer(unsigned int framebuffer)
+{
+    // in headless runs nothing is drawn into the default framebuffer, it stands for the output too
+    if ((int)framebuffer == m_OutputFramebuffer || framebuffer == 0)
+        return CaptureOutputFramebuffer;
+    if (m_Framebuffers.count(framebuffer))
+        return framebuffer;
+
+    CaptureFramebuffer command = {};
+    command.ID = framebuffer;
+    auto attachment = [&](GLenum point, uint32_t bit) {
+        GLint type, name;
+        GLCall(glGetNamedFramebufferAttachmentParameteriv(framebuffer, point, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type));
+        if (type == GL_NONE)
+            return 0u;
+        GLCall(glGetNamedFramebufferAttachmentParameteriv(framebuffer, point, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &name));
+        if (type == GL_RENDERBUFFER)
+        {
+            RecordRenderbuffer(name);
+            command.Renderbuffers |= bit;
+        }
+        else
+            RecordTexture(name);
+        return (uint32_t)name;
+    };
+
+    for (uint32_t i = 0; i < 8; i++)
+        command.Color[i] = attachment(GL_COLOR_ATTACHMENT0 + i, 1u << i);
+    command.Depth = attachment(GL_DEPTH_ATTACHMENT, 1u << 8);
+    if (command.Depth)
+    {
+        GLint type, stencil = 0;
+        GLCall(glGetNamedFramebufferAttachmentParameteriv(framebuffer, GL_STENCIL_ATTACHMENT, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_TYPE, &type));
+        if (type != GL_NONE)
+        {
+            GLCall(glGetNamedFramebufferAttachmentParameteriv(framebuffer, GL_STENCIL_ATTACHMENT, GL_FRAMEBUFFER_ATTACHMENT_OBJECT_NAME, &stencil));
+        }
+        command.DepthAttachment = (uint32_t)stencil == command.Depth ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+    }
+
+    Append(m_Setup, CaptureCommand::Framebuffer);
+    Append(m_Setup, command);
+    m_Framebuffers.insert(framebuffer);
+    return framebuffer;
+}
+
+CommandCapture::BufferInfo& CommandCapture::RecordBuffer(unsigned int buffer)
+{
+    auto it = m_Buffers.find(buffer);
+    if (it != m_Buffers.end())
+        return it->second;
+
+    BufferInfo info;
+    GLint64 size;
+    GLint immutable, usage;
+    GLCall(glGetNamedBufferParameteri64v(buffer, GL_BUFFER_SIZE, &size));
+    GLCall(glGetNamedBufferParameteriv(buffer, GL_BUFFER_IMMUTABLE_STORAGE, &immutable));
+    if (immutable)
+    {
+        GLint flags;
+        GLCall(glGetNamedBufferParameteriv(buffer, GL_BUFFER_STORAGE_FLAGS, &flags));
+        info.Static = (flags & (GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT)) == 0;
+    }
+    else
+    {
+        GLCall(glGetNamedBufferParameteriv(buffer, GL_BUFFER_USAGE, &usage));
+        info.Static = usage == GL_STATIC_DRAW;
+    }
+    info.Size = (uint64_t)size;
+
+    CaptureBuffer command = {};
+    command.ID = buffer;
+    command.Size = info.Size;
+    Append(m_Setup, CaptureCommand::Buffer);
+    Append(m_Setup, command);
+    return m_Buffers.emplace(buffer, std::move(info)).first->second;
+}
+
+const uint8_t* CommandCapture::RecordBufferData(unsigned int buffer, uint64_t offset, uint64_t size)
+{
+    BufferInfo& info = RecordBuffer(buffer);
+    if (offset >= info.Size)
+        return nullptr;
+    size = std::min(size, info.Size - offset);
+
+    m_Scratch.resize((size_t)size);
+    GLCall(glGetNamedBufferSubData(buffer, (GLintptr)offset, (GLsizeiptr)size, m_Scratch.data()));
+    uint64_t hash = HashBytes(m_Scratch.data(), (size_t)size);
+
+    // a batch renderer rewrites the start of its buffers every flush, only what changed since
+    // the replay last uploaded the range goes in; overlapping ranges are stale after an upload
+    for (const UploadedRange& range : info.Ranges)
+    {
+        if (range.Offset == offset && range.Size == size && range.Hash == hash)
+            return m_Scratch.data();
+    }
+    info.Ranges.erase(std::remove_if(info.Ranges.begin(), info.Ranges.end(), [&](const UploadedRange& range) {
+        return range.Offset < offset + size && offset < range.Offset + range.Size;
+    }), info.Ranges.end());
+    info.Ranges.push_back({ offset, size, hash });
+
+    CaptureBufferData command;
+    command.Buffer = buffer;
+    command.Data = AddBlob(m_Scratch.data(), (size_t)size);
+    command.Offset = offset;
+    // static contents from the first frame are uploaded once, everything else every loop
+    std::vector<uint8_t>& stream = info.Static && m_FrameCount == 0 ? m_Setup : m_Frames;
+    Append(stream, CaptureCommand::BufferData);
+    Append(stream, command);
+    return m_Scratch.data();
+}
+
+void CommandCapture::RecordState()
+{
+    CaptureState state;
+    std::memset(&state, 0, sizeof(state));
+
+    GLint value;
+    GLboolean flags[4];
+    GLCall(glGetIntegerv(GL_VIEWPORT, state.Viewport));
+    GLCall(glGetIntegerv(GL_SCISSOR_BOX, state.Scissor));
+    GLCall(state.ScissorTest = glIsEnabled(GL_SCISSOR_TEST));
+    GLCall(state.Blend = glIsEnabled(GL_BLEND));
+    GLCall(state.DepthTest = glIsEnabled(GL_DEPTH_TEST));
+    GLCall(state.StencilTest = glIsEnabled(GL_STENCIL_TEST));
+    GLCall(state.CullFace = glIsEnabled(GL_CULL_FACE));
+    GLCall(glGetBooleanv(GL_DEPTH_WRITEMASK, flags));
+    state.DepthMask = flags[0];
+    GLCall(glGetBooleanv(GL_COLOR_WRITEMASK, flags));
+    for (int i = 0; i < 4; i++)
+        state.ColorMask[i] = flags[i];
+
+    auto get = [&](GLenum name) {
+        GLCall(glGetIntegerv(name, &value));
+        return (uint32_t)value;
+    };
+    state.BlendSrcRGB = get(GL_BLEND_SRC_RGB);
+    state.BlendDstRGB = get(GL_BLEND_DST_RGB);
+    state.BlendSrcAlpha = get(GL_BLEND_SRC_ALPHA);
+    state.BlendDstAlpha = get(GL_BLEND_DST_ALPHA);
+    state.BlendEquationRGB = get(GL_BLEND_EQUATION_RGB);
+    state.BlendEquationAlpha = get(GL_BLEND_EQUATION_ALPHA);
+    GLCall(glGetFloatv(GL_BLEND_COLOR, state.BlendColor));
+    state.DepthFunc = get(GL_DEPTH_FUNC);
+    state.StencilFunc = get(GL_STENCIL_FUNC);
+    state.StencilRef = (int32_t)get(GL_STENCIL_REF);
+    state.StencilValueMask = get(GL_STENCIL_VALUE_MASK);
+    state.StencilWriteMask = get(GL_STENCIL_WRITEMASK);
+    state.StencilFail = get(GL_STENCIL_FAIL);
+    state.StencilPassDepthFail = get(GL_STENCIL_PASS_DEPTH_FAIL);
+    state.StencilPassDepthPass = get(GL_STENCIL_PASS_DEPTH_PASS);
+    state.CullFaceMode = get(GL_CULL_FACE_MODE);
+    GLCall(glGetFloatv(GL_COLOR_CLEAR_VALUE, state.ClearColor));
+    GLCall(glGetFloatv(GL_DEPTH_CLEAR_VALUE, &state.ClearDepth));
+    state.ClearStencil = (int32_t)get(GL_STENCIL_CLEAR_VALUE);
+
+    if (m_HasState && std::memcmp(&state, &m_State, sizeof(state)) == 0)
+        return;
+    m_State = state;
+    m_HasState = true;
+    Append(m_Frames, CaptureCommand::State);
+    Append(m_Frames, state);
+}
+
+const std::vector<CommandCapture::UniformInfo>& CommandCapture::GetUniforms(unsigned int program)
+{
+    auto it = m_Uniforms.find(program);
+    if (it != m_Uniforms.end())
+        return it->second;
+
+    std::vector<UniformInfo>& uniforms = m_Uniforms[program];
+    GLint count, maxLength;
+    GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+    std::vector<char> name(std::max(maxLength, 1));
+    for (GLint i = 0; i < count; i++)
+    {
+        GLuint index = i;
+        GLint block;
+        GLCall(glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block));
+        // uniform blocks live in buffers the capture doesn't follow
+        if (block != -1)
+            continue;
+
+        GLint size;
+        GLenum type;
+        GLsizei length;
+        GLCall(glGetActiveUniform(program, index, (GLsizei)name.size(), &length, &size, &type, name.data()));
+        if (GetCaptureUniformComponents(type) == 0)
+            continue;
+
+        UniformInfo uniform;
+        uniform.Name.assign(name.data(), length);
+        uniform.Type = type;
+        // arrays are reported as "name[0]"
+        size_t bracket = uniform.Name.find('[');
+        if (bracket != std::string::npos)
+            uniform.Name.resize(bracket);
+        for (GLint element = 0; element < size; element++)
+        {
+            std::string elementName = size > 1 ? uniform.Name + "[" + std::to_string(element) + "]" : uniform.Name;
+            GLCall(GLint location = glGetUniformLocation(program, elementName.c_str()));
+            uniform.Locations.push_back(location);
+        }
+        uniforms.push_back(std::move(uniform));
+    }
+    return uniforms;
+}
+
+void CommandCapture::OnClear(GLbitfield mask)
+{
+    GLint framebuffer;
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer));
+    CaptureClear command;
+    command.Framebuffer = RecordFramebuffer(framebuffer);
+    command.Mask = mask;
+    RecordState();
+    Append(m_Frames, CaptureCommand::Clear);
+    Append(m_Frames, command);
+}
+
+void CommandCapture::OnClearBuffer(unsigned int framebuffer, GLenum buffer, GLint drawBuffer, const float* value, GLint stencil)
+{
+    CaptureClearBuffer command = {};
+    command.Framebuffer = RecordFramebuffer(framebuffer);
+    command.Buffer = buffer;
+    command.DrawBuffer = drawBuffer;
+    command.Stencil = stencil;
+    std::memcpy(command.Value, value, (buffer == GL_COLOR ? 4 : 1) * sizeof(float));
+    RecordState();
+    Append(m_Frames, CaptureCommand::ClearBuffer);
+    Append(m_Frames, command);
+}
+
+void CommandCapture::OnDraw(GLenum mode, GLsizei count, GLenum indexType, uintptr_t offset, GLint baseVertex)
+{
+    GLint program, framebuffer;
+    GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &program));
+    if (count <= 0 || !program || !RecordProgram(program))
+    {
+        m_SkippedDraws++;
+        return;
+    }
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer));
+
+    CaptureDraw draw = {};
+    draw.Framebuffer = RecordFramebuffer(framebuffer);
+    draw.Program = program;
+    draw.Mode = mode;
+    draw.Count = count;
+    draw.IndexType = indexType;
+    draw.BaseVertex = baseVertex;
+    draw.Offset = offset;
+
+    // the vertices the draw reads, only those ranges of the vertex buffers are kept
+    int64_t first = (int64_t)offset, last = (int64_t)offset + count - 1;
+    if (indexType)
+    {
+        GLint elementBuffer;
+        GLCall(glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &elementBuffer));
+        uint32_t indexSize = GetIndexSize(indexType);
+        const uint8_t* indices = elementBuffer ? RecordBufferData(elementBuffer, offset, (uint64_t)count * indexSize) : nullptr;
+        if (!indices)
+        {
+            m_SkippedDraws++;
+            return;
+        }
+        draw.ElementBuffer = elementBuffer;
+
+        uint32_t minIndex = UINT32_MAX, maxIndex = 0;
+        for (GLsizei i = 0; i < count; i++)
+        {
+            uint32_t index;
+            if (indexSize == 1)
+                index = indices[i];
+            else if (indexSize == 2)
+                index = ((const uint16_t*)indices)[i];
+            else
+                index = ((const uint32_t*)indices)[i];
+            minIndex = std::min(minIndex, index);
+            maxIndex = std::max(maxIndex, index);
+        }
+        first = (int64_t)minIndex + baseVertex;
+        last = (int64_t)maxIndex + baseVertex;
+    }
+
+    static GLint maxAttributes = 0;
+    if (maxAttributes == 0)
+    {
+        GLCall(glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttributes));
+    }
+
+    std::vector<CaptureAttribute> attributes;
+    for (GLint location = 0; location < maxAttributes; location++)
+    {
+        GLint enabled, buffer;
+        GLCall(glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &enabled));
+        if (!enabled)
+            continue;
+        GLCall(glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer));
+        if (!buffer)
+            continue;
+
+        CaptureAttribute attribute = {};
+        GLint value, binding;
+        attribute.Location = location;
+        attribute.Buffer = buffer;
+        GLCall(glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_SIZE, &value));
+        attribute.Size = value;
+        GLCall(glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_TYPE, &value));
+        attribute.Type = value;
+        GLCall(glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &value));
+        attribute.Normalized = value;
+        GLCall(glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &value));
+        attribute.Integer = value;
+        GLCall(glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_RELATIVE_OFFSET, &value));
+        attribute.RelativeOffset = value;
+        GLCall(glGetVertexAttribiv(location, GL_VERTEX_ATTRIB_BINDING, &binding));
+        GLCall(glGetIntegeri_v(GL_VERTEX_BINDING_STRIDE, binding, &value));
+        attribute.Stride = value;
+        GLCall(glGetIntegeri_v(GL_VERTEX_BINDING_DIVISOR, binding, &value));
+        attribute.Divisor = value;
+        GLint64 bindingOffset;
+        GLCall(glGetInteger64i_v(GL_VERTEX_BINDING_OFFSET, binding, &bindingOffset));
+        attribute.Offset = (uint64_t)bindingOffset;
+
+        // instanced attributes only have the first instance, draws here aren't instanced
+        uint64_t stride = attribute.Stride ? attribute.Stride : attribute.RelativeOffset + attribute.Size * 8;
+        int64_t from = attribute.Divisor ? 0 : std::max<int64_t>(first, 0);
+        int64_t to = attribute.Divisor ? 0 : std::max<int64_t>(last, 0);
+        RecordBufferData(buffer, attribute.Offset + from * stride, (uint64_t)(to - from + 1) * stride);
+        attributes.push_back(attribute);
+    }
+
+    // uniforms by value and the textures behind the samplers
+    std::vector<CaptureTextureBinding> textures;
+    m_UniformScratch.clear();
+    GLint activeTexture;
+    GLCall(glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture));
+    for (const UniformInfo& uniform : GetUniforms(program))
+    {
+        int components = GetCaptureUniformComponents(uniform.Type);
+        CaptureUniform header;
+        header.NameLength = (uint32_t)uniform.Name.size();
+        header.Type = uniform.Type;
+        header.Count = (uint32_t)uniform.Locations.size();
+        Append(m_UniformScratch, header);
+        m_UniformScratch.insert(m_UniformScratch.end(), uniform.Name.begin(), uniform.Name.end());
+        m_UniformScratch.resize((m_UniformScratch.size() + 3) & ~(size_t)3);
+
+        for (GLint location : uniform.Locations)
+        {
+            uint32_t values[16];
+            if (IsFloatUniform(uniform.Type))
+            {
+                GLCall(glGetUniformfv(program, location, (float*)values));
+            }
+            else if (IsUnsignedUniform(uniform.Type))
+            {
+                GLCall(glGetUniformuiv(program, location, values));
+            }
+            else
+            {
+                GLCall(glGetUniformiv(program, location, (GLint*)values));
+            }
+            const uint8_t* bytes = (const uint8_t*)values;
+            m_UniformScratch.insert(m_UniformScratch.end(), bytes, bytes + components * sizeof(uint32_t));
+
+            if (IsCaptureSampler(uniform.Type) && std::none_of(textures.begin(), textures.end(),
+                [&](const CaptureTextureBinding& binding) { return binding.Unit == values[0]; }))
+            {
+                GLint texture;
+                GLCall(glActiveTexture(GL_TEXTURE0 + values[0]));
+                GLCall(glGetIntegerv(GL_TEXTURE_BINDING_2D, &texture));
+                if (texture)
+                {
+                    RecordTexture(texture);
+                    textures.push_back({ values[0], (uint32_t)texture });
+                }
+            }
+        }
+    }
+    GLCall(glActiveTexture(activeTexture));
+    draw.Uniforms = m_UniformScratch.empty() ? CaptureNoBlob : AddBlob(m_UniformScratch.data(), m_UniformScratch.size());
+    draw.AttributeCount = (uint32_t)attributes.size();
+    draw.TextureCount = (uint32_t)textures.size();
+
+    // recorded last so the uploads and objects above come before it
+    RecordState();
+    Append(m_Frames, CaptureCommand::Draw);
+    Append(m_Frames, draw);
+    for (const CaptureAttribute& attribute : attributes)
+        Append(m_Frames, attribute);
+    for (const CaptureTextureBinding& binding : textures)
+        Append(m_Frames, binding);
+    m_Draws++;
+}
+
+void CommandCapture::WriteFile()
+{
+    CaptureHeader header = {};
+    header.Magic = CaptureMagic;
+    header.Version = CaptureVersion;
+    header.Width = m_Width;
+    header.Height = m_Height;
+    header.FrameCount = m_FrameCount;
+    header.BlobCount = (uint32_t)m_Blobs.size();
+
+    uint64_t offset = sizeof(CaptureHeader);
+    for (const std::vector<uint8_t>& blob : m_Blobs)
+        offset += sizeof(uint32_t) + ((blob.size() + 3) & ~(size_t)3);
+    header.SetupOffset = offset;
+    header.SetupSize = m_Setup.size();
+    header.FramesOffset = offset + m_Setup.size();
+    header.FramesSize = m_Frames.size();
+
+    std::ofstream stream(m_Path, std::ios::binary);
+    if (stream)
+    {
+        static const char padding[4] = {};
+        stream.write((const char*)&header, sizeof(header));
+        for (const std::vector<uint8_t>& blob : m_Blobs)
+        {
+            uint32_t size = (uint32_t)blob.size();
+            stream.write((const char*)&size, sizeof(size));
+            stream.write((const char*)blob.data(), blob.size());
+            stream.write(padding, ((blob.size() + 3) & ~(size_t)3) - blob.size());
+        }
+        stream.write((const char*)m_Setup.data(), m_Setup.size());
+        stream.write((const char*)m_Frames.data(), m_Frames.size());
+    }
+    if (!stream)
+    {
+        std::cout << "Failed to write '" << m_Path << "'" << std::endl;
+        return;
+    }
+
+    m_LastFile = m_Path;
+    m_LastFileBytes = (size_t)(header.FramesOffset + header.FramesSize);
+    std::cout << "Captured " << m_FrameCount << " frames, " << m_Draws << " draws to " << m_Path << ", "
+        << m_LastFileBytes / 1024 << " KB in " << m_Blobs.size() << " blobs";
+    if (m_SkippedDraws)
+        std::cout << ", " << m_SkippedDraws << " draws skipped";
+    std::cout << std::endl;
+}
+
+void CommandCapture::OnImGuiRender()
+{
+    ImGui::Begin("Command Capture");
+
+    if (IsCapturing())
+    {
+        ImGui::Text("Recording to %s, %d frames left", m_Path.c_str(), m_FramesLeft);
+        if (ImGui::Button("Stop"))
+            Stop();
+    }
+    else
+    {
+        ImGui::SliderInt("Frames", &m_DefaultFrames, 1, 120);
+        if (ImGui::Button("Record"))
+            Start(m_DefaultPath, m_DefaultFrames);
+        ImGui::SameLine();
+        ImGui::Text("to %s", m_DefaultPath.c_str());
+    }
+
+    if (!m_LastFile.empty())
+        ImGui::Text("Last: %s, %.1f KB", m_LastFile.c_str(), m_LastFileBytes / 1024.0f);
+
+    ImGui::End();
+}
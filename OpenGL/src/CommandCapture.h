@@ -0,0 +1,329 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// command stream file, written by CommandCapture and read back by CommandReplay:
+//
+//     CaptureHeader
+//     blob[BlobCount]                  uint32_t size, bytes, padded to 4
+//     setup commands                   objects and their contents before the first frame
+//     frame commands                   every frame ends with CaptureCommand::EndFrame
+//
+// a command is a CaptureCommand byte followed by its struct; a draw is followed by its
+// CaptureAttribute and CaptureTextureBinding arrays. Identical data (buffer ranges, texture
+// images, shader sources, uniform values) is stored once as a blob, every value is little
+// endian and object ids are the recording process's GL names
+static const uint32_t CaptureMagic = 0x31444d43; // "CMD1"
+static const uint32_t CaptureVersion = 1;
+static const uint32_t CaptureNoBlob = 0xffffffff;
+// draws and clears into the framebuffer bound when the frame began
+static const uint32_t CaptureOutputFramebuffer = 0;
+
+struct CaptureHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	// the output framebuffer's viewport when recording started
+	uint32_t Width, Height;
+	uint32_t FrameCount;
+	uint32_t BlobCount;
+	uint64_t SetupOffset, SetupSize;
+	uint64_t FramesOffset, FramesSize;
+};
+
+enum class CaptureCommand : uint8_t
+{
+	// setup
+	Program, Buffer, Texture, Renderbuffer, Framebuffer,
+	// setup for static buffers, in the frames for everything else
+	BufferData,
+	// frames
+	State, Clear, ClearBuffer, Draw, EndFrame
+};
+
+struct CaptureProgram
+{
+	uint32_t ID;
+	uint32_t VertexSource, FragmentSource;
+	// file and defines, for messages
+	uint32_t Name;
+};
+
+struct CaptureBuffer
+{
+	uint32_t ID;
+	uint32_t Padding;
+	uint64_t Size;
+};
+
+// RGBA8 level 0 in Pixels for color formats, depth and integer textures start out empty
+struct CaptureTexture
+{
+	uint32_t ID;
+	uint32_t Width, Height;
+	uint32_t Format;
+	uint32_t MinFilter, MagFilter, WrapS, WrapT;
+	uint32_t DepthStencilMode;
+	uint32_t Pixels;
+};
+
+struct CaptureRenderbuffer
+{
+	uint32_t ID;
+	uint32_t Width, Height;
+	uint32_t Format;
+};
+
+// ids of textures, or renderbuffers where the bit of the attachment is set, 0 for none
+struct CaptureFramebuffer
+{
+	uint32_t ID;
+	uint32_t Color[8];
+	uint32_t Depth;
+	uint32_t DepthAttachment;
+	// bit 0 - 7 color, bit 8 depth
+	uint32_t Renderbuffers;
+};
+
+struct CaptureBufferData
+{
+	uint32_t Buffer;
+	uint32_t Data;
+	uint64_t Offset;
+};
+
+// fixed function state a draw or clear depends on, recorded whenever it changed
+struct CaptureState
+{
+	int32_t Viewport[4];
+	int32_t Scissor[4];
+	uint8_t ScissorTest, Blend, DepthTest, DepthMask;
+	uint8_t StencilTest, CullFace;
+	uint8_t ColorMask[4];
+	uint8_t Padding[2];
+	uint32_t BlendSrcRGB, BlendDstRGB, BlendSrcAlpha, BlendDstAlpha;
+	uint32_t BlendEquationRGB, BlendEquationAlpha;
+	float BlendColor[4];
+	uint32_t DepthFunc;
+	uint32_t StencilFunc;
+	int32_t StencilRef;
+	uint32_t StencilValueMask, StencilWriteMask;
+	uint32_t StencilFail, StencilPassDepthFail, StencilPassDepthPass;
+	uint32_t CullFaceMode;
+	float ClearColor[4];
+	float ClearDepth;
+	int32_t ClearStencil;
+};
+
+// glClear with the clear values of the last state
+struct CaptureClear
+{
+	uint32_t Framebuffer;
+	uint32_t Mask;
+};
+
+// glClearNamedFramebuffer*, Buffer is GL_COLOR, GL_DEPTH or GL_DEPTH_STENCIL
+struct CaptureClearBuffer
+{
+	uint32_t Framebuffer;
+	uint32_t Buffer;
+	int32_t DrawBuffer;
+	int32_t Stencil;
+	float Value[4];
+};
+
+struct CaptureDraw
+{
+	uint32_t Framebuffer;
+	uint32_t Program;
+	uint32_t Mode;
+	uint32_t Count;
+	// 0 for glDrawArrays, Offset is the first vertex then
+	uint32_t IndexType;
+	uint32_t ElementBuffer;
+	int32_t BaseVertex;
+	uint32_t AttributeCount;
+	uint32_t TextureCount;
+	// blob of CaptureUniform entries, CaptureNoBlob without uniforms
+	uint32_t Uniforms;
+	uint64_t Offset;
+};
+
+struct CaptureAttribute
+{
+	uint32_t Location;
+	uint32_t Size, Type;
+	uint32_t Normalized, Integer;
+	uint32_t RelativeOffset;
+	uint32_t Buffer;
+	uint32_t Stride;
+	uint32_t Divisor;
+	uint32_t Padding;
+	uint64_t Offset;
+};
+
+struct CaptureTextureBinding
+{
+	uint32_t Unit;
+	uint32_t Texture;
+};
+
+// entry of a uniforms blob: this, the name, then Count * components 32 bit values
+struct CaptureUniform
+{
+	uint32_t NameLength;
+	uint32_t Type;
+	uint32_t Count;
+};
+
+// 32 bit values per element of a uniform type, 0 for types a capture doesn't keep
+int GetCaptureUniformComponents(GLenum type);
+bool IsCaptureSampler(GLenum type);
+
+// records what the frames between BeginFrame and EndFrame draw: every draw and clear takes
+// a snapshot of the GL state it depends on, the ranges of the vertex and index buffers it
+// reads, its uniforms and textures; objects are recorded the first time a frame uses them.
+// Nothing is queried outside of a recording, the hooks cost a branch:
+//
+//     CommandCapture::Get().RecordDraw(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0);
+//     GLCall(glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr));
+class CommandCapture
+{
+public:
+	static CommandCapture& Get();
+
+	// records the next frameCount frames into path
+	void Start(const std::string& path, int frameCount = 1);
+	// what the Record button of the ui starts
+	void SetDefaults(const std::string& path, int frameCount);
+	// writes what was recorded so far, if anything
+	void Stop();
+	inline bool IsCapturing() const { return m_FramesLeft > 0; }
+
+	// the framebuffer bound at the first BeginFrame is the output, the replay draws
+	// into its own target instead
+	void BeginFrame();
+	void EndFrame();
+
+	// call right before the GL call, offset is the byte offset into the index buffer, or
+	// the first vertex without indexType
+	inline void RecordDraw(GLenum mode, GLsizei count, GLenum indexType, uintptr_t offset, GLint baseVertex = 0)
+	{
+		if (m_Recording)
+			OnDraw(mode, count, indexType, offset, baseVertex);
+	}
+	inline void RecordClear(GLbitfield mask)
+	{
+		if (m_Recording)
+			OnClear(mask);
+	}
+	inline void RecordClearBuffer(unsigned int framebuffer, GLenum buffer, GLint drawBuffer, const float* value, GLint stencil = 0)
+	{
+		if (m_Recording)
+			OnClearBuffer(framebuffer, buffer, drawBuffer, value, stencil);
+	}
+
+	// the sources of every linked program, programs made before a capture started need them
+	void RegisterProgram(unsigned int program, const std::string& vertexSource, const std::string& fragmentSource,
+		const std::string& name);
+	void UnregisterProgram(unsigned int program);
+
+	void OnImGuiRender();
+
+private:
+	CommandCapture() = default;
+
+	struct ProgramSource
+	{
+		std::string Vertex, Fragment, Name;
+	};
+
+	struct UniformInfo
+	{
+		std::string Name;
+		GLenum Type;
+		// one per array element
+		std::vector<GLint> Locations;
+	};
+
+	// a range of a buffer as the replay will have it
+	struct UploadedRange
+	{
+		uint64_t Offset, Size;
+		uint64_t Hash;
+	};
+
+	struct BufferInfo
+	{
+		uint64_t Size;
+		// immutable without dynamic storage, or GL_STATIC_DRAW, uploaded in the setup
+		bool Static;
+		std::vector<UploadedRange> Ranges;
+	};
+
+	void OnDraw(GLenum mode, GLsizei count, GLenum indexType, uintptr_t offset, GLint baseVertex);
+	void OnClear(GLbitfield mask);
+	void OnClearBuffer(unsigned int framebuffer, GLenum buffer, GLint drawBuffer, const float* value, GLint stencil);
+
+	// objects are recorded on first use, the framebuffer returns the id to store in a command
+	// and the program false if its sources are unknown
+	uint32_t RecordFramebuffer(unsigned int framebuffer);
+	bool RecordProgram(unsigned int program);
+	void RecordTexture(unsigned int texture);
+	void RecordRenderbuffer(unsigned int renderbuffer);
+	BufferInfo& RecordBuffer(unsigned int buffer);
+	// reads the range into m_Scratch and records it unless the replay already has these contents
+	const uint8_t* RecordBufferData(unsigned int buffer, uint64_t offset, uint64_t size);
+	void RecordState();
+
+	const std::vector<UniformInfo>& GetUniforms(unsigned int program);
+	uint32_t AddBlob(const void* data, size_t size);
+	void WriteFile();
+	void Reset();
+
+	template<typename T>
+	static void Append(std::vector<uint8_t>& stream, const T& value)
+	{
+		const uint8_t* bytes = (const uint8_t*)&value;
+		stream.insert(stream.end(), bytes, bytes + sizeof(T));
+	}
+
+	bool m_Recording = false;
+	int m_FramesLeft = 0;
+	uint32_t m_FrameCount = 0;
+	std::string m_Path;
+	std::string m_DefaultPath = "capture.cmd";
+	int m_DefaultFrames = 1;
+	int m_OutputFramebuffer = 0;
+	int m_Width = 0, m_Height = 0;
+
+	std::unordered_map<unsigned int, ProgramSource> m_Sources;
+
+	// what this capture recorded so far
+	std::vector<uint8_t> m_Setup, m_Frames;
+	std::vector<std::vector<uint8_t>> m_Blobs;
+	// content hash to blob indices with that hash
+	std::unordered_map<uint64_t, std::vector<uint32_t>> m_BlobLookup;
+	std::unordered_set<unsigned int> m_Programs, m_Textures, m_Renderbuffers, m_Framebuffers;
+	std::unordered_map<unsigned int, BufferInfo> m_Buffers;
+	CaptureState m_State;
+	bool m_HasState = false;
+	std::vector<uint8_t> m_Scratch, m_UniformScratch;
+	// active uniforms per program, kept across captures until the program is deleted
+	std::unordered_map<unsigned int, std::vector<UniformInfo>> m_Uniforms;
+	// programs without sources, reported once
+	std::unordered_set<unsigned int> m_Missing;
+
+	// status for the ui
+	std::string m_LastFile;
+	size_t m_LastFileBytes = 0;
+	uint32_t m_Draws = 0;
+	uint32_t m_SkippedDraws = 0;
+};
@@ -0,0 +1,743 @@
+#include "CommandReplay.h"
+
+#include "GpuMemoryTracker.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+    // bounds checked reads of a command stream
+    struct Reader
+    {
+        const uint8_t* Data;
+        size_t Size;
+        size_t Position = 0;
+
+        Reader(const uint8_t* data, size_t size) : Data(data), Size(size) {}
+
+        template<typename T>
+        bool Read(T& value)
+        {
+            if (Size - Position < sizeof(T))
+                return false;
+            std::memcpy(&value, Data + Position, sizeof(T));
+            Position += sizeof(T);
+            return true;
+        }
+
+        bool Skip(size_t size)
+        {
+            if (Size - Position < size)
+                return false;
+            Position += size;
+            return true;
+        }
+
+        inline bool AtEnd() const { return Position == Size; }
+    };
+
+}
+
+// glTextureStorage2D takes sized formats only
+static GLenum GetSizedFormat(GLenum format)
+{
+    switch (format)
+    {
+    case GL_RED: return GL_R8;
+    case GL_RG: return GL_RG8;
+    case GL_RGB: return GL_RGB8;
+    case GL_RGBA: return GL_RGBA8;
+    case GL_DEPTH_COMPONENT: return GL_DEPTH_COMPONENT24;
+    case GL_DEPTH_STENCIL: return GL_DEPTH24_STENCIL8;
+    default: return format;
+    }
+}
+
+static void SetEnabled(GLenum capability, bool enabled)
+{
+    if (enabled)
+    {
+        GLCall(glEnable(capability));
+    }
+    else
+    {
+        GLCall(glDisable(capability));
+    }
+}
+
+CommandReplay::CommandReplay()
+{
+}
+
+CommandReplay::~CommandReplay()
+{
+    Release();
+}
+
+bool CommandReplay::ReadHeader(const std::string& path, CaptureHeader& header)
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.read((char*)&header, sizeof(header)))
+        return false;
+    return header.Magic == CaptureMagic && header.Version == CaptureVersion;
+}
+
+bool CommandReplay::Load(const std::string& path)
+{
+    Release();
+    m_Path = path;
+    if (!m_File.Open(path))
+    {
+        std::cout << "Failed to open '" << path << "'" << std::endl;
+        return false;
+    }
+
+    const uint8_t* data = m_File.GetData();
+    size_t size = m_File.GetSize();
+    Reader reader(data, size);
+    if (!reader.Read(m_Header) || m_Header.Magic != CaptureMagic || m_Header.Version != CaptureVersion)
+    {
+        std::cout << "'" << path << "' is not a version " << CaptureVersion << " command capture" << std::endl;
+        Release();
+        return false;
+    }
+
+    m_Blobs.reserve(m_Header.BlobCount);
+    for (uint32_t i = 0; i < m_Header.BlobCount; i++)
+    {
+        uint32_t blobSize;
+        if (!reader.Read(blobSize) || !reader.Skip((blobSize + 3) & ~3u))
+        {
+            std::cout << "'" << path << "' is truncated" << std::endl;
+            Release();
+            return false;
+        }
+        m_Blobs.push_back({ data + reader.Position - ((blobSize + 3) & ~3u), blobSize });
+    }
+
+    bool valid = m_Header.SetupOffset <= size && m_Header.SetupSize <= size - m_Header.SetupOffset
+        && m_Header.FramesOffset <= size && m_Header.FramesSize <= size - m_Header.FramesOffset;
+    // the setup runs now, the frames are decoded into m_Commands
+    if (!valid || !Parse(data + m_Header.SetupOffset, (size_t)m_Header.SetupSize, true)
+        || !Parse(data + m_Header.FramesOffset, (size_t)m_Header.FramesSize, false) || m_FrameStarts.empty())
+    {
+        std::cout << "'" << path << "' is corrupt" << std::endl;
+        Release();
+        return false;
+    }
+
+    m_Stats.Programs = (uint32_t)m_Programs.size();
+    m_Stats.Buffers = (uint32_t)m_Buffers.size();
+    m_Stats.Textures = (uint32_t)m_Textures.size();
+    m_Stats.Framebuffers = (uint32_t)m_Framebuffers.size();
+    m_Stats.VertexArrays = (uint32_t)m_VertexArrays.size();
+    m_Stats.FileBytes = size;
+    for (const Command& command : m_Commands)
+    {
+        if (command.Type == CaptureCommand::Draw)
+            m_Stats.Draws++;
+        else if (command.Type == CaptureCommand::Clear || command.Type == CaptureCommand::ClearBuffer)
+            m_Stats.Clears++;
+        else if (command.Type == CaptureCommand::State)
+            m_Stats.StateChanges++;
+        else if (command.Type == CaptureCommand::BufferData)
+        {
+            m_Stats.Uploads++;
+            m_Stats.UploadBytes += m_Uploads[command.Index].Data.Size;
+        }
+    }
+    return true;
+}
+
+void CommandReplay::Release()
+{
+    m_Programs.clear();
+    for (auto& [id, buffer] : m_Buffers)
+    {
+        GPU_UNTRACK(GpuResourceType::Buffer, buffer);
+        GLCall(glDeleteBuffers(1, &buffer));
+    }
+    for (auto& [id, texture] : m_Textures)
+    {
+        if (texture)
+        {
+            GPU_UNTRACK(GpuResourceType::Texture, texture);
+            GLCall(glDeleteTextures(1, &texture));
+        }
+    }
+    for (auto& [id, renderbuffer] : m_Renderbuffers)
+    {
+        GPU_UNTRACK(GpuResourceType::Renderbuffer, renderbuffer);
+        GLCall(glDeleteRenderbuffers(1, &renderbuffer));
+    }
+    for (auto& [id, framebuffer] : m_Framebuffers)
+    {
+        GPU_UNTRACK(GpuResourceType::Framebuffer, framebuffer);
+        GLCall(glDeleteFramebuffers(1, &framebuffer));
+    }
+    for (auto& [key, vertexArray] : m_VertexArrays)
+    {
+        GPU_UNTRACK(GpuResourceType::VertexArray, vertexArray);
+        GLCall(glDeleteVertexArrays(1, &vertexArray));
+    }
+
+    m_ProgramIndices.clear();
+    m_Buffers.clear();
+    m_Textures.clear();
+    m_Renderbuffers.clear();
+    m_Framebuffers.clear();
+    m_VertexArrays.clear();
+    m_UniformSetLookup.clear();
+    m_Blobs.clear();
+    m_Commands.clear();
+    m_FrameStarts.clear();
+    m_Uploads.clear();
+    m_States.clear();
+    m_Clears.clear();
+    m_ClearBuffers.clear();
+    m_Draws.clear();
+    m_TextureBindings.clear();
+    m_UniformSets.clear();
+    m_Uniforms.clear();
+    m_UniformValues.clear();
+    m_Frame = 0;
+    m_Stats = Stats();
+    m_File.Close();
+}
+
+unsigned int CommandReplay::Find(const std::unordered_map<uint32_t, unsigned int>& objects, uint32_t id) const
+{
+    auto it = objects.find(id);
+    return it == objects.end() ? 0 : it->second;
+}
+
+bool CommandReplay::Parse(const uint8_t* data, size_t size, bool setup)
+{
+    Reader reader(data, size);
+    if (!setup && size)
+        m_FrameStarts.push_back(0);
+
+    while (!reader.AtEnd())
+    {
+        CaptureCommand type;
+        if (!reader.Read(type))
+            return false;
+
+        switch (type)
+        {
+        case CaptureCommand::Program:
+        {
+            CaptureProgram command;
+            if (!reader.Read(command) || !LoadProgram(command))
+                return false;
+            break;
+        }
+        case CaptureCommand::Buffer:
+        {
+            CaptureBuffer command;
+            if (!reader.Read(command))
+                return false;
+            unsigned int buffer;
+            GLCall(glCreateBuffers(1, &buffer));
+            GLCall(glNamedBufferStorage(buffer, (GLsizeiptr)command.Size, nullptr, GL_DYNAMIC_STORAGE_BIT));
+            GPU_TRACK(GpuResourceType::Buffer, buffer, (size_t)command.Size, "Replay buffer");
+            m_Buffers[command.ID] = buffer;
+            break;
+        }
+        case CaptureCommand::Texture:
+        {
+            CaptureTexture command;
+            if (!reader.Read(command) || (command.Pixels != CaptureNoBlob && command.Pixels >= m_Blobs.size()))
+                return false;
+            LoadTexture(command);
+            break;
+        }
+        case CaptureCommand::Renderbuffer:
+        {
+            CaptureRenderbuffer command;
+            if (!reader.Read(command))
+                return false;
+            unsigned int renderbuffer;
+            GLCall(glCreateRenderbuffers(1, &renderbuffer));
+            GLCall(glNamedRenderbufferStorage(renderbuffer, command.Format, command.Width, command.Height));
+            GPU_TRACK(GpuResourceType::Renderbuffer, renderbuffer,
+                (size_t)command.Width * command.Height * GetGpuFormatSize(command.Format), "Replay renderbuffer");
+            m_Renderbuffers[command.ID] = renderbuffer;
+            break;
+        }
+        case CaptureCommand::Framebuffer:
+        {
+            CaptureFramebuffer command;
+            if (!reader.Read(command))
+                return false;
+            LoadFramebuffer(command);
+            break;
+        }
+        case CaptureCommand::BufferData:
+        {
+            CaptureBufferData command;
+            if (!reader.Read(command) || command.Data >= m_Blobs.size())
+                return false;
+            Upload upload = { Find(m_Buffers, command.Buffer), command.Offset, m_Blobs[command.Data] };
+            if (!upload.Buffer)
+                return false;
+            if (setup)
+            {
+                GLCall(glNamedBufferSubData(upload.Buffer, (GLintptr)upload.Offset, upload.Data.Size, upload.Data.Data));
+            }
+            else
+            {
+                m_Commands.push_back({ type, (uint32_t)m_Uploads.size() });
+                m_Uploads.push_back(upload);
+            }
+            break;
+        }
+        case CaptureCommand::State:
+        {
+            CaptureState state;
+            if (setup || !reader.Read(state))
+                return false;
+            m_Commands.push_back({ type, (uint32_t)m_States.size() });
+            m_States.push_back(state);
+            break;
+        }
+        case CaptureCommand::Clear:
+        {
+            CaptureClear command;
+            if (setup || !reader.Read(command))
+                return false;
+            bool output = command.Framebuffer == CaptureOutputFramebuffer;
+            m_Commands.push_back({ type, (uint32_t)m_Clears.size() });
+            m_Clears.push_back({ output ? 0 : Find(m_Framebuffers, command.Framebuffer), output, command.Mask });
+            break;
+        }
+        case CaptureCommand::ClearBuffer:
+        {
+            CaptureClearBuffer command;
+            if (setup || !reader.Read(command))
+                return false;
+            bool output = command.Framebuffer == CaptureOutputFramebuffer;
+            m_Commands.push_back({ type, (uint32_t)m_ClearBuffers.size() });
+            m_ClearBuffers.push_back({ output ? 0 : Find(m_Framebuffers, command.Framebuffer), output, command });
+            break;
+        }
+        case CaptureCommand::Draw:
+        {
+            CaptureDraw command;
+            if (setup || !reader.Read(command) || command.AttributeCount > 64 || command.TextureCount > 256)
+                return false;
+            CaptureAttribute attributes[64];
+            for (uint32_t i = 0; i < command.AttributeCount; i++)
+            {
+                if (!reader.Read(attributes[i]))
+                    return false;
+            }
+
+            auto program = m_ProgramIndices.find(command.Program);
+            if (program == m_ProgramIndices.end())
+                return false;
+            Draw draw;
+            draw.Output = command.Framebuffer == CaptureOutputFramebuffer;
+            draw.Framebuffer = draw.Output ? 0 : Find(m_Framebuffers, command.Framebuffer);
+            draw.Program = program->second;
+            draw.VertexArray = GetVertexArray(command, attributes);
+            draw.Mode = command.Mode;
+            draw.Count = command.Count;
+            draw.IndexType = command.IndexType;
+            draw.BaseVertex = command.BaseVertex;
+            draw.Offset = command.Offset;
+            draw.FirstTexture = (uint32_t)m_TextureBindings.size();
+            draw.TextureCount = command.TextureCount;
+            for (uint32_t i = 0; i < command.TextureCount; i++)
+            {
+                CaptureTextureBinding binding;
+                if (!reader.Read(binding))
+                    return false;
+                binding.Texture = Find(m_Textures, binding.Texture);
+                m_TextureBindings.push_back(binding);
+            }
+            draw.Uniforms = UINT32_MAX;
+            if (command.Uniforms != CaptureNoBlob)
+            {
+                if (command.Uniforms >= m_Blobs.size())
+                    return false;
+                draw.Uniforms = GetUniformSet(draw.Program, command.Uniforms);
+                if (draw.Uniforms == UINT32_MAX)
+                    return false;
+            }
+            m_Commands.push_back({ type, (uint32_t)m_Draws.size() });
+            m_Draws.push_back(draw);
+            break;
+        }
+        case CaptureCommand::EndFrame:
+            if (setup)
+                return false;
+            m_Commands.push_back({ type, 0 });
+            if (!reader.AtEnd())
+                m_FrameStarts.push_back((uint32_t)m_Commands.size());
+            break;
+        default:
+            return false;
+        }
+    }
+
+    // every frame has to be closed, ReplayFrame runs up to the EndFrame
+    return setup || m_Commands.empty() || m_Commands.back().Type == CaptureCommand::EndFrame;
+}
+
+bool CommandReplay::LoadProgram(const CaptureProgram& command)
+{
+    if (command.VertexSource >= m_Blobs.size() || command.FragmentSource >= m_Blobs.size() || command.Name >= m_Blobs.size())
+        return false;
+
+    auto text = [&](uint32_t blob) {
+        return std::string((const char*)m_Blobs[blob].Data, m_Blobs[blob].Size);
+    };
+    // the sources already have the defines in them
+    ShaderProgramSource source = { text(command.VertexSource), text(command.FragmentSource) };
+    m_ProgramIndices[command.ID] = (uint32_t)m_Programs.size();
+    m_Programs.push_back({ std::make_unique<Shader>(text(command.Name), source), UINT32_MAX });
+    return true;
+}
+
+void CommandReplay::LoadTexture(const CaptureTexture& command)
+{
+    if (command.Width == 0 || command.Height == 0)
+    {
+        m_Textures[command.ID] = 0;
+        return;
+    }
+
+    bool mipmaps = command.MinFilter != GL_NEAREST && command.MinFilter != GL_LINEAR;
+    int levels = 1;
+    if (mipmaps)
+    {
+        for (uint32_t size = std::max(command.Width, command.Height); size > 1; size /= 2)
+            levels++;
+    }
+
+    unsigned int texture;
+    GLenum format = GetSizedFormat(command.Format);
+    GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &texture));
+    GLCall(glTextureStorage2D(texture, levels, format, command.Width, command.Height));
+    GLCall(glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, command.MinFilter));
+    GLCall(glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, command.MagFilter));
+    GLCall(glTextureParameteri(texture, GL_TEXTURE_WRAP_S, command.WrapS));
+    GLCall(glTextureParameteri(texture, GL_TEXTURE_WRAP_T, command.WrapT));
+    if (command.DepthStencilMode == GL_STENCIL_INDEX)
+    {
+        GLCall(glTextureParameteri(texture, GL_DEPTH_STENCIL_TEXTURE_MODE, GL_STENCIL_INDEX));
+    }
+    if (command.Pixels != CaptureNoBlob && m_Blobs[command.Pixels].Size == (size_t)command.Width * command.Height * 4)
+    {
+        GLCall(glTextureSubImage2D(texture, 0, 0, 0, command.Width, command.Height, GL_RGBA, GL_UNSIGNED_BYTE,
+            m_Blobs[command.Pixels].Data));
+        if (mipmaps)
+        {
+            GLCall(glGenerateTextureMipmap(texture));
+        }
+    }
+    GPU_TRACK(GpuResourceType::Texture, texture, (size_t)command.Width * command.Height * GetGpuFormatSize(format),
+        "Replay texture");
+    m_Textures[command.ID] = texture;
+}
+
+void CommandReplay::LoadFramebuffer(const CaptureFramebuffer& command)
+{
+    unsigned int framebuffer;
+    GLCall(glCreateFramebuffers(1, &framebuffer));
+
+    auto attach = [&](GLenum point, uint32_t id, uint32_t bit) {
+        if (command.Renderbuffers & bit)
+        {
+            GLCall(glNamedFramebufferRenderbuffer(framebuffer, point, GL_RENDERBUFFER, Find(m_Renderbuffers, id)));
+        }
+        else
+        {
+            GLCall(glNamedFramebufferTexture(framebuffer, point, Find(m_Textures, id), 0));
+        }
+    };
+
+    GLenum drawBuffers[8];
+    int drawBufferCount = 0;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        drawBuffers[i] = GL_NONE;
+        if (!command.Color[i])
+            continue;
+        attach(GL_COLOR_ATTACHMENT0 + i, command.Color[i], 1u << i);
+        drawBuffers[i] = GL_COLOR_ATTACHMENT0 + i;
+        drawBufferCount = i + 1;
+    }
+    if (command.Depth)
+        attach(command.DepthAttachment, command.Depth, 1u << 8);
+    if (drawBufferCount)
+    {
+        GLCall(glNamedFramebufferDrawBuffers(framebuffer, drawBufferCount, drawBuffers));
+    }
+    else
+    {
+        GLCall(glNamedFramebufferDrawBuffer(framebuffer, GL_NONE));
+    }
+
+    GLCall(GLenum status = glCheckNamedFramebufferStatus(framebuffer, GL_DRAW_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Replay framebuffer " << command.ID << " is incomplete (" << status << ")" << std::endl;
+
+    GPU_TRACK(GpuResourceType::Framebuffer, framebuffer, 0, "Replay framebuffer");
+    m_Framebuffers[command.ID] = framebuffer;
+}
+
+unsigned int CommandReplay::GetVertexArray(const CaptureDraw& draw, const CaptureAttribute* attributes)
+{
+    // draws with the same layout and buffers share a vertex array
+    std::string key((const char*)&draw.ElementBuffer, sizeof(draw.ElementBuffer));
+    key.append((const char*)attributes, draw.AttributeCount * sizeof(CaptureAttribute));
+    auto it = m_VertexArrays.find(key);
+    if (it != m_VertexArrays.end())
+        return it->second;
+
+    unsigned int vertexArray;
+    GLCall(glCreateVertexArrays(1, &vertexArray));
+    for (uint32_t i = 0; i < draw.AttributeCount; i++)
+    {
+        // one binding per attribute, named after its location
+        const CaptureAttribute& attribute = attributes[i];
+        GLuint location = attribute.Location;
+        GLCall(glEnableVertexArrayAttrib(vertexArray, location));
+        GLCall(glVertexArrayVertexBuffer(vertexArray, location, Find(m_Buffers, attribute.Buffer),
+            (GLintptr)attribute.Offset, attribute.Stride));
+        if (attribute.Integer)
+        {
+            GLCall(glVertexArrayAttribIFormat(vertexArray, location, attribute.Size, attribute.Type, attribute.RelativeOffset));
+        }
+        else
+        {
+            GLCall(glVertexArrayAttribFormat(vertexArray, location, attribute.Size, attribute.Type,
+                attribute.Normalized ? GL_TRUE : GL_FALSE, attribute.RelativeOffset));
+        }
+        GLCall(glVertexArrayAttribBinding(vertexArray, location, location));
+        GLCall(glVertexArrayBindingDivisor(vertexArray, location, attribute.Divisor));
+    }
+    if (draw.ElementBuffer)
+    {
+        GLCall(glVertexArrayElementBuffer(vertexArray, Find(m_Buffers, draw.ElementBuffer)));
+    }
+    GPU_TRACK(GpuResourceType::VertexArray, vertexArray, 0, "Replay vertex array");
+    m_VertexArrays.emplace(std::move(key), vertexArray);
+    return vertexArray;
+}
+
+uint32_t CommandReplay::GetUniformSet(uint32_t program, uint32_t blob)
+{
+    uint64_t key = (uint64_t)program << 32 | blob;
+    auto it = m_UniformSetLookup.find(key);
+    if (it != m_UniformSetLookup.end())
+        return it->second;
+
+    UniformSet set = { (uint32_t)m_Uniforms.size(), 0 };
+    unsigned int id = m_Programs[program].Object->GetRendererID();
+    Reader reader(m_Blobs[blob].Data, m_Blobs[blob].Size);
+    while (!reader.AtEnd())
+    {
+        CaptureUniform header;
+        if (!reader.Read(header) || reader.Size - reader.Position < header.NameLength)
+            return UINT32_MAX;
+        std::string name((const char*)reader.Data + reader.Position, header.NameLength);
+        uint32_t components = GetCaptureUniformComponents(header.Type);
+        size_t valueBytes = (size_t)header.Count * components * sizeof(uint32_t);
+        if (!reader.Skip((header.NameLength + 3) & ~3u) || components == 0 || reader.Size - reader.Position < valueBytes)
+            return UINT32_MAX;
+
+        // the name of an array is its first element, the others follow from the count
+        GLCall(GLint location = glGetUniformLocation(id, name.c_str()));
+        if (location != -1)
+        {
+            m_Uniforms.push_back({ location, header.Type, (GLsizei)header.Count, (uint32_t)m_UniformValues.size() });
+            const uint32_t* values = (const uint32_t*)(reader.Data + reader.Position);
+            m_UniformValues.insert(m_UniformValues.end(), values, values + header.Count * components);
+            set.Count++;
+        }
+        reader.Skip(valueBytes);
+    }
+
+    uint32_t index = (uint32_t)m_UniformSets.size();
+    m_UniformSets.push_back(set);
+    m_UniformSetLookup[key] = index;
+    return index;
+}
+
+void CommandReplay::ApplyState(const CaptureState& state)
+{
+    GLCall(glViewport(state.Viewport[0], state.Viewport[1], state.Viewport[2], state.Viewport[3]));
+    GLCall(glScissor(state.Scissor[0], state.Scissor[1], state.Scissor[2], state.Scissor[3]));
+    SetEnabled(GL_SCISSOR_TEST, state.ScissorTest);
+    SetEnabled(GL_BLEND, state.Blend);
+    SetEnabled(GL_DEPTH_TEST, state.DepthTest);
+    SetEnabled(GL_STENCIL_TEST, state.StencilTest);
+    SetEnabled(GL_CULL_FACE, state.CullFace);
+    GLCall(glDepthMask(state.DepthMask));
+    GLCall(glColorMask(state.ColorMask[0], state.ColorMask[1], state.ColorMask[2], state.ColorMask[3]));
+    GLCall(glBlendFuncSeparate(state.BlendSrcRGB, state.BlendDstRGB, state.BlendSrcAlpha, state.BlendDstAlpha));
+    GLCall(glBlendEquationSeparate(state.BlendEquationRGB, state.BlendEquationAlpha));
+    GLCall(glBlendColor(state.BlendColor[0], state.BlendColor[1], state.BlendColor[2], state.BlendColor[3]));
+    GLCall(glDepthFunc(state.DepthFunc));
+    GLCall(glStencilFunc(state.StencilFunc, state.StencilRef, state.StencilValueMask));
+    GLCall(glStencilMask(state.StencilWriteMask));
+    GLCall(glStencilOp(state.StencilFail, state.StencilPassDepthFail, state.StencilPassDepthPass));
+    GLCall(glCullFace(state.CullFaceMode));
+    GLCall(glClearColor(state.ClearColor[0], state.ClearColor[1], state.ClearColor[2], state.ClearColor[3]));
+    GLCall(glClearDepth(state.ClearDepth));
+    GLCall(glClearStencil(state.ClearStencil));
+}
+
+void CommandReplay::ApplyUniforms(const Program& program, const UniformSet& set)
+{
+    unsigned int id = program.Object->GetRendererID();
+    for (uint32_t i = set.First; i < set.First + set.Count; i++)
+    {
+        const Uniform& uniform = m_Uniforms[i];
+        const void* value = &m_UniformValues[uniform.Value];
+        const GLfloat* f = (const GLfloat*)value;
+        const GLint* n = (const GLint*)value;
+        const GLuint* u = (const GLuint*)value;
+        switch (uniform.Type)
+        {
+        case GL_FLOAT: GLCall(glProgramUniform1fv(id, uniform.Location, uniform.Count, f)); break;
+        case GL_FLOAT_VEC2: GLCall(glProgramUniform2fv(id, uniform.Location, uniform.Count, f)); break;
+        case GL_FLOAT_VEC3: GLCall(glProgramUniform3fv(id, uniform.Location, uniform.Count, f)); break;
+        case GL_FLOAT_VEC4: GLCall(glProgramUniform4fv(id, uniform.Location, uniform.Count, f)); break;
+        case GL_INT_VEC2: case GL_BOOL_VEC2: GLCall(glProgramUniform2iv(id, uniform.Location, uniform.Count, n)); break;
+        case GL_INT_VEC3: case GL_BOOL_VEC3: GLCall(glProgramUniform3iv(id, uniform.Location, uniform.Count, n)); break;
+        case GL_INT_VEC4: case GL_BOOL_VEC4: GLCall(glProgramUniform4iv(id, uniform.Location, uniform.Count, n)); break;
+        case GL_UNSIGNED_INT: GLCall(glProgramUniform1uiv(id, uniform.Location, uniform.Count, u)); break;
+        case GL_UNSIGNED_INT_VEC2: GLCall(glProgramUniform2uiv(id, uniform.Location, uniform.Count, u)); break;
+        case GL_UNSIGNED_INT_VEC3: GLCall(glProgramUniform3uiv(id, uniform.Location, uniform.Count, u)); break;
+        case GL_UNSIGNED_INT_VEC4: GLCall(glProgramUniform4uiv(id, uniform.Location, uniform.Count, u)); break;
+        case GL_FLOAT_MAT2: GLCall(glProgramUniformMatrix2fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        case GL_FLOAT_MAT3: GLCall(glProgramUniformMatrix3fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        case GL_FLOAT_MAT4: GLCall(glProgramUniformMatrix4fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        case GL_FLOAT_MAT2x3: GLCall(glProgramUniformMatrix2x3fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        case GL_FLOAT_MAT2x4: GLCall(glProgramUniformMatrix2x4fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        case GL_FLOAT_MAT3x2: GLCall(glProgramUniformMatrix3x2fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        case GL_FLOAT_MAT3x4: GLCall(glProgramUniformMatrix3x4fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        case GL_FLOAT_MAT4x2: GLCall(glProgramUniformMatrix4x2fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        case GL_FLOAT_MAT4x3: GLCall(glProgramUniformMatrix4x3fv(id, uniform.Location, uniform.Count, GL_FALSE, f)); break;
+        // int, bool and samplers
+        default: GLCall(glProgramUniform1iv(id, uniform.Location, uniform.Count, n)); break;
+        }
+    }
+}
+
+void CommandReplay::BindFramebuffer(unsigned int framebuffer, bool output)
+{
+    unsigned int target = output ? m_Output : framebuffer;
+    if (target == m_BoundFramebuffer)
+        return;
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, target));
+    m_BoundFramebuffer = target;
+}
+
+void CommandReplay::ReplayFrame()
+{
+    if (!IsLoaded())
+        return;
+
+    GLint output, viewport[4];
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &output));
+    GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+    m_Output = output;
+    m_BoundFramebuffer = output;
+
+    FrameStats& stats = Renderer::GetFrameStats();
+    uint32_t program = UINT32_MAX;
+    unsigned int vertexArray = UINT_MAX;
+    for (uint32_t i = m_FrameStarts[m_Frame]; m_Commands[i].Type != CaptureCommand::EndFrame; i++)
+    {
+        const Command& command = m_Commands[i];
+        switch (command.Type)
+        {
+        case CaptureCommand::BufferData:
+        {
+            const Upload& upload = m_Uploads[command.Index];
+            GLCall(glNamedBufferSubData(upload.Buffer, (GLintptr)upload.Offset, upload.Data.Size, upload.Data.Data));
+            stats.BytesUploaded += upload.Data.Size;
+            break;
+        }
+        case CaptureCommand::State:
+            ApplyState(m_States[command.Index]);
+            break;
+        case CaptureCommand::Clear:
+        {
+            const Clear& clear = m_Clears[command.Index];
+            BindFramebuffer(clear.Framebuffer, clear.Output);
+            GLCall(glClear(clear.Mask));
+            break;
+        }
+        case CaptureCommand::ClearBuffer:
+        {
+            const ClearBuffer& clear = m_ClearBuffers[command.Index];
+            unsigned int framebuffer = clear.Output ? m_Output : clear.Framebuffer;
+            if (clear.Values.Buffer == GL_DEPTH_STENCIL)
+            {
+                GLCall(glClearNamedFramebufferfi(framebuffer, GL_DEPTH_STENCIL, 0, clear.Values.Value[0], clear.Values.Stencil));
+            }
+            else
+            {
+                GLCall(glClearNamedFramebufferfv(framebuffer, clear.Values.Buffer, clear.Values.DrawBuffer, clear.Values.Value));
+            }
+            break;
+        }
+        case CaptureCommand::Draw:
+        {
+            const Draw& draw = m_Draws[command.Index];
+            BindFramebuffer(draw.Framebuffer, draw.Output);
+            Program& drawProgram = m_Programs[draw.Program];
+            if (draw.Program != program)
+            {
+                drawProgram.Object->Bind();
+                program = draw.Program;
+            }
+            if (draw.Uniforms != UINT32_MAX && drawProgram.AppliedUniforms != draw.Uniforms)
+            {
+                ApplyUniforms(drawProgram, m_UniformSets[draw.Uniforms]);
+                drawProgram.AppliedUniforms = draw.Uniforms;
+            }
+            if (draw.VertexArray != vertexArray)
+            {
+                GLCall(glBindVertexArray(draw.VertexArray));
+                vertexArray = draw.VertexArray;
+            }
+            for (uint32_t t = draw.FirstTexture; t < draw.FirstTexture + draw.TextureCount; t++)
+            {
+                GLCall(glBindTextureUnit(m_TextureBindings[t].Unit, m_TextureBindings[t].Texture));
+            }
+
+            if (draw.IndexType)
+            {
+                GLCall(glDrawElementsBaseVertex(draw.Mode, draw.Count, draw.IndexType, (const void*)(uintptr_t)draw.Offset,
+                    draw.BaseVertex));
+            }
+            else
+            {
+                GLCall(glDrawArrays(draw.Mode, (GLint)draw.Offset, draw.Count));
+            }
+            stats.DrawCalls++;
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    BindFramebuffer(0, true);
+    GLCall(glViewport(viewport[0], viewport[1], viewport[2], viewport[3]));
+    GLCall(glBindVertexArray(0));
+    GLCall(glUseProgram(0));
+    m_Frame = (m_Frame + 1) % GetFrameCount();
+}
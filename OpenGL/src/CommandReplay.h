@@ -0,0 +1,168 @@
+#pragma once
+
+#include "CommandCapture.h"
+#include "MappedFile.h"
+#include "Shader.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// plays back a file written by CommandCapture: Load creates every object the capture
+// recorded, builds the vertex arrays and looks up the uniforms once, after that a frame
+// is the recorded uploads, state changes, clears and draws and nothing else. Frames go
+// into the framebuffer bound when ReplayFrame is called, wrapping to the first one
+class CommandReplay
+{
+public:
+	struct Stats
+	{
+		uint32_t Programs = 0, Buffers = 0, Textures = 0, Framebuffers = 0, VertexArrays = 0;
+		// for all frames of one loop
+		uint32_t Draws = 0, Clears = 0, StateChanges = 0, Uploads = 0;
+		uint64_t UploadBytes = 0;
+		size_t FileBytes = 0;
+	};
+
+	CommandReplay();
+	~CommandReplay();
+
+	CommandReplay(const CommandReplay&) = delete;
+	CommandReplay& operator=(const CommandReplay&) = delete;
+
+	// false if the file is missing or not a capture of this version
+	static bool ReadHeader(const std::string& path, CaptureHeader& header);
+
+	// needs a context, prints what's wrong with the file and returns false
+	bool Load(const std::string& path);
+	void Release();
+
+	void ReplayFrame();
+
+	inline bool IsLoaded() const { return !m_FrameStarts.empty(); }
+	inline uint32_t GetFrameCount() const { return (uint32_t)m_FrameStarts.size(); }
+	inline uint32_t GetCurrentFrame() const { return m_Frame; }
+	inline int GetWidth() const { return m_Header.Width; }
+	inline int GetHeight() const { return m_Header.Height; }
+	inline const Stats& GetStats() const { return m_Stats; }
+
+private:
+	struct Blob
+	{
+		const uint8_t* Data;
+		uint32_t Size;
+	};
+
+	struct Command
+	{
+		CaptureCommand Type;
+		// into the array for the type
+		uint32_t Index;
+	};
+
+	struct Upload
+	{
+		unsigned int Buffer;
+		uint64_t Offset;
+		Blob Data;
+	};
+
+	// framebuffers are GL names, Output means the one bound when the frame started
+	struct Clear
+	{
+		unsigned int Framebuffer;
+		bool Output;
+		GLbitfield Mask;
+	};
+
+	struct ClearBuffer
+	{
+		unsigned int Framebuffer;
+		bool Output;
+		CaptureClearBuffer Values;
+	};
+
+	struct Draw
+	{
+		unsigned int Framebuffer;
+		bool Output;
+		// into m_Programs
+		uint32_t Program;
+		unsigned int VertexArray;
+		GLenum Mode;
+		GLsizei Count;
+		GLenum IndexType;
+		GLint BaseVertex;
+		uint64_t Offset;
+		// range in m_TextureBindings
+		uint32_t FirstTexture, TextureCount;
+		// index into m_UniformSets, UINT32_MAX for none
+		uint32_t Uniforms;
+	};
+
+	struct Program
+	{
+		std::unique_ptr<Shader> Object;
+		// the values are kept by the program, a set already applied is skipped
+		uint32_t AppliedUniforms;
+	};
+
+	struct Uniform
+	{
+		GLint Location;
+		GLenum Type;
+		GLsizei Count;
+		// into m_UniformValues
+		uint32_t Value;
+	};
+
+	struct UniformSet
+	{
+		uint32_t First, Count;
+	};
+
+	bool Parse(const uint8_t* data, size_t size, bool setup);
+	bool LoadProgram(const CaptureProgram& command);
+	void LoadTexture(const CaptureTexture& command);
+	void LoadFramebuffer(const CaptureFramebuffer& command);
+	unsigned int GetVertexArray(const CaptureDraw& draw, const CaptureAttribute* attributes);
+	uint32_t GetUniformSet(uint32_t program, uint32_t blob);
+	unsigned int Find(const std::unordered_map<uint32_t, unsigned int>& objects, uint32_t id) const;
+
+	void ApplyState(const CaptureState& state);
+	void ApplyUniforms(const Program& program, const UniformSet& set);
+	void BindFramebuffer(unsigned int framebuffer, bool output);
+
+	MappedFile m_File;
+	std::string m_Path;
+	CaptureHeader m_Header = {};
+	std::vector<Blob> m_Blobs;
+
+	// recorded ids to the objects made for them
+	std::unordered_map<uint32_t, uint32_t> m_ProgramIndices;
+	std::unordered_map<uint32_t, unsigned int> m_Buffers, m_Textures, m_Renderbuffers, m_Framebuffers;
+	std::unordered_map<std::string, unsigned int> m_VertexArrays;
+	std::unordered_map<uint64_t, uint32_t> m_UniformSetLookup;
+	std::vector<Program> m_Programs;
+
+	std::vector<Command> m_Commands;
+	// first command of every frame
+	std::vector<uint32_t> m_FrameStarts;
+	std::vector<Upload> m_Uploads;
+	std::vector<CaptureState> m_States;
+	std::vector<Clear> m_Clears;
+	std::vector<ClearBuffer> m_ClearBuffers;
+	std::vector<Draw> m_Draws;
+	std::vector<CaptureTextureBinding> m_TextureBindings;
+	std::vector<UniformSet> m_UniformSets;
+	std::vector<Uniform> m_Uniforms;
+	std::vector<uint32_t> m_UniformValues;
+
+	uint32_t m_Frame = 0;
+	// while a frame replays
+	unsigned int m_Output = 0;
+	unsigned int m_BoundFramebuffer = 0;
+	Stats m_Stats;
+};
@@ -0,0 +1,102 @@
+#include "DirtyRegion.h"
+
+#include <algorithm>
+
+DirtyRect Union(const DirtyRect& a, const DirtyRect& b)
+{
+    return { std::min(a.X0, b.X0), std::min(a.Y0, b.Y0), std::max(a.X1, b.X1), std::max(a.Y1, b.Y1) };
+}
+
+void DirtyRegion::Reset(const DirtyRect& bounds)
+{
+    m_Bounds = bounds;
+    m_Rects.clear();
+    m_Full = false;
+}
+
+void DirtyRegion::Add(const DirtyRect& rect)
+{
+    if (m_Full)
+        return;
+
+    DirtyRect clipped = { std::max(rect.X0, m_Bounds.X0), std::max(rect.Y0, m_Bounds.Y0),
+        std::min(rect.X1, m_Bounds.X1), std::min(rect.Y1, m_Bounds.Y1) };
+    if (clipped.IsEmpty())
+        return;
+
+    if (m_Rects.size() >= MaxTrackedRects)
+    {
+        SetFull();
+        return;
+    }
+    m_Rects.push_back(clipped);
+}
+
+void DirtyRegion::SetFull()
+{
+    m_Full = true;
+    m_Rects.clear();
+}
+
+void DirtyRegion::Merge()
+{
+    if (m_Full)
+        return;
+
+    // touching rectangles become one, repeated since a union can reach new neighbours
+    bool merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < m_Rects.size(); i++)
+        {
+            for (size_t j = i + 1; j < m_Rects.size(); j++)
+            {
+                if (!m_Rects[i].Touches(m_Rects[j]))
+                    continue;
+                m_Rects[i] = Union(m_Rects[i], m_Rects[j]);
+                m_Rects.erase(m_Rects.begin() + j);
+                merged = true;
+                j = i;
+            }
+        }
+    }
+
+    // still too many, join the pair whose union adds the least area
+    while (m_Rects.size() > MaxRects)
+    {
+        size_t bestI = 0, bestJ = 1;
+        long long bestWaste = -1;
+        for (size_t i = 0; i < m_Rects.size(); i++)
+        {
+            for (size_t j = i + 1; j < m_Rects.size(); j++)
+            {
+                long long waste = Union(m_Rects[i], m_Rects[j]).GetArea() - m_Rects[i].GetArea() - m_Rects[j].GetArea();
+                if (bestWaste < 0 || waste < bestWaste)
+                {
+                    bestWaste = waste;
+                    bestI = i;
+                    bestJ = j;
+                }
+            }
+        }
+        m_Rects[bestI] = Union(m_Rects[bestI], m_Rects[bestJ]);
+        m_Rects.erase(m_Rects.begin() + bestJ);
+    }
+
+    if (GetCoverage() > FullThreshold)
+        SetFull();
+}
+
+float DirtyRegion::GetCoverage() const
+{
+    long long total = m_Bounds.GetArea();
+    if (m_Full || total == 0)
+        return 1.0f;
+
+    // overlaps after cost based merging are counted twice, close enough for a threshold
+    long long area = 0;
+    for (const DirtyRect& rect : m_Rects)
+        area += rect.GetArea();
+    return std::min(1.0f, (float)((double)area / total));
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// pixel rectangle in window coordinates, max is exclusive
+struct DirtyRect
+{
+	int X0 = 0, Y0 = 0, X1 = 0, Y1 = 0;
+
+	inline bool IsEmpty() const { return X1 <= X0 || Y1 <= Y0; }
+	inline long long GetArea() const { return IsEmpty() ? 0 : (long long)(X1 - X0) * (Y1 - Y0); }
+	// overlapping or sharing an edge
+	inline bool Touches(const DirtyRect& other) const
+	{
+		return X0 <= other.X1 && other.X0 <= X1 && Y0 <= other.Y1 && other.Y0 <= Y1;
+	}
+	inline bool Intersects(const DirtyRect& other) const
+	{
+		return X0 < other.X1 && other.X0 < X1 && Y0 < other.Y1 && other.Y0 < Y1;
+	}
+};
+
+DirtyRect Union(const DirtyRect& a, const DirtyRect& b);
+
+// collects the screen areas that changed since the last frame and merges them into a
+// few rectangles to scissor the redraw with, falls back to a full redraw when they
+// would cover most of the target anyway
+class DirtyRegion
+{
+public:
+	// rectangles left after merging
+	static const size_t MaxRects = 8;
+	// more raw rectangles than this in one frame and the whole target is redrawn
+	static const size_t MaxTrackedRects = 1024;
+	// share of the target above which a full redraw is cheaper than scissoring
+	static constexpr float FullThreshold = 0.6f;
+
+	// empty region inside bounds
+	void Reset(const DirtyRect& bounds);
+	// clipped to the bounds
+	void Add(const DirtyRect& rect);
+	void SetFull();
+	void Merge();
+
+	inline bool IsFull() const { return m_Full; }
+	inline bool IsEmpty() const { return !m_Full && m_Rects.empty(); }
+	inline const DirtyRect& GetBounds() const { return m_Bounds; }
+	// only meaningful when not full
+	inline const std::vector<DirtyRect>& GetRects() const { return m_Rects; }
+	// share of the bounds that gets redrawn
+	float GetCoverage() const;
+
+private:
+	DirtyRect m_Bounds;
+	std::vector<DirtyRect> m_Rects;
+	bool m_Full = false;
+};
@@ -0,0 +1,200 @@
+#include "Font.h"
+
+#include "GpuMemoryTracker.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "imgui/imstb_truetype.h"
+
+Font::Font(const std::string& path, float pixelHeight)
+    : m_RendererID(0), m_PixelHeight(pixelHeight), m_LineHeight(pixelHeight),
+    m_AtlasWidth(512), m_AtlasHeight(0), m_Glyphs{}
+{
+    std::ifstream stream(path, std::ios::binary);
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    stbtt_fontinfo info;
+    if (data.empty() || !stbtt_InitFont(&info, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0)))
+    {
+        std::cout << "Failed to load font '" << path << "'" << std::endl;
+        // no glyphs and no kerning, Layout returns nothing to draw
+        m_Kerning.assign(CharCount * CharCount, 0.0f);
+        return;
+    }
+
+    float scale = stbtt_ScaleForPixelHeight(&info, pixelHeight);
+
+    int ascent, descent, lineGap;
+    stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+    m_LineHeight = (ascent - descent + lineGap) * scale;
+
+    // distance field spans padding pixels either side of the edge, edge sits at 0.5
+    const int padding = 6;
+    const unsigned char onEdge = 128;
+    const float distanceScale = (float)onEdge / padding;
+
+    struct Bitmap
+    {
+        unsigned char* Pixels;
+        int Width, Height, X, Y;
+    };
+    Bitmap bitmaps[CharCount]{};
+
+    // shelf packing, one row at a time
+    int penX = 0, penY = 0, rowHeight = 0;
+    for (int i = 0; i < CharCount; i++)
+    {
+        int codepoint = FirstChar + i;
+        Bitmap& bitmap = bitmaps[i];
+        int xoff = 0, yoff = 0;
+        bitmap.Pixels = stbtt_GetCodepointSDF(&info, scale, codepoint, padding, onEdge, distanceScale,
+            &bitmap.Width, &bitmap.Height, &xoff, &yoff);
+
+        int advance, leftBearing;
+        stbtt_GetCodepointHMetrics(&info, codepoint, &advance, &leftBearing);
+
+        if (penX + bitmap.Width + 1 > m_AtlasWidth)
+        {
+            penX = 0;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+        bitmap.X = penX;
+        bitmap.Y = penY;
+        penX += bitmap.Width + 1;
+        rowHeight = std::max(rowHeight, bitmap.Height);
+
+        Glyph& glyph = m_Glyphs[i];
+        glyph.Offset = { (float)xoff, (float)-(yoff + bitmap.Height) };
+        glyph.Size = { (float)bitmap.Width, (float)bitmap.Height };
+        glyph.Advance = advance * scale;
+    }
+
+    m_AtlasHeight = 1;
+    while (m_AtlasHeight < penY + rowHeight)
+        m_AtlasHeight *= 2;
+
+    // atlas rows are top down, so the bottom of a glyph has the larger v
+    std::vector<unsigned char> atlas((size_t)m_AtlasWidth * m_AtlasHeight, 0);
+    for (int i = 0; i < CharCount; i++)
+    {
+        Bitmap& bitmap = bitmaps[i];
+        for (int y = 0; y < bitmap.Height; y++)
+            memcpy(&atlas[(size_t)(bitmap.Y + y) * m_AtlasWidth + bitmap.X],
+                bitmap.Pixels + (size_t)y * bitmap.Width, bitmap.Width);
+
+        Glyph& glyph = m_Glyphs[i];
+        glyph.UVMin = { (float)bitmap.X / m_AtlasWidth, (float)(bitmap.Y + bitmap.Height) / m_AtlasHeight };
+        glyph.UVMax = { (float)(bitmap.X + bitmap.Width) / m_AtlasWidth, (float)bitmap.Y / m_AtlasHeight };
+
+        if (bitmap.Pixels)
+            stbtt_FreeSDF(bitmap.Pixels, nullptr);
+    }
+
+    m_Kerning.resize(CharCount * CharCount);
+    for (int a = 0; a < CharCount; a++)
+        for (int b = 0; b < CharCount; b++)
+            m_Kerning[a * CharCount + b] = stbtt_GetCodepointKernAdvance(&info, FirstChar + a, FirstChar + b) * scale;
+
+    GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID));
+    GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+
+    GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, m_AtlasWidth, m_AtlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data()));
+    GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+    GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+    GPU_TRACK(GpuResourceType::Texture, m_RendererID, (size_t)m_AtlasWidth * m_AtlasHeight, "Font atlas " + path);
+}
+
+Font::~Font()
+{
+    GPU_UNTRACK(GpuResourceType::Texture, m_RendererID);
+    GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+const std::vector<Font::GlyphQuad>& Font::Layout(const std::string& text)
+{
+    m_LayoutCalls++;
+    auto it = m_LayoutCache.find(text);
+    if (it != m_LayoutCache.end())
+    {
+        it->second.LastUsed = m_LayoutCalls;
+        return it->second.Quads;
+    }
+
+    // strings that change every frame would grow the cache forever: a full cache drops what
+    // wasn't asked for within the last two cache sizes of calls, a string drawn every frame
+    // comes back sooner than that however many there are, a frame counter never does
+    if (m_LayoutCache.size() >= m_EvictAt)
+    {
+        uint64_t maxAge = 2 * (uint64_t)m_LayoutCache.size();
+        for (auto entry = m_LayoutCache.begin(); entry != m_LayoutCache.end();)
+        {
+            if (m_LayoutCalls - entry->second.LastUsed > maxAge)
+                entry = m_LayoutCache.erase(entry);
+            else
+                ++entry;
+        }
+        // when most of it is in use the cache grows, the next pass waits until it doubled
+        size_t live = m_LayoutCache.size() * 2;
+        m_EvictAt = live > MaxCachedLayouts ? live : MaxCachedLayouts;
+    }
+
+    CachedLayout& layout = m_LayoutCache[text];
+    layout.LastUsed = m_LayoutCalls;
+    Shape(text, layout.Quads);
+    return layout.Quads;
+}
+
+void Font::ClearLayoutCache()
+{
+    m_LayoutCache.clear();
+    m_EvictAt = MaxCachedLayouts;
+}
+
+void Font::Shape(const std::string& text, std::vector<GlyphQuad>& quads) const
+{
+    quads.reserve(text.size());
+
+    glm::vec2 pen = { 0.0f, 0.0f };
+    int previous = -1;
+    for (char c : text)
+    {
+        if (c == '\n')
+        {
+            pen.x = 0.0f;
+            pen.y -= m_LineHeight;
+            previous = -1;
+            continue;
+        }
+
+        int index = (unsigned char)c - FirstChar;
+        if (index < 0 || index >= CharCount)
+            index = '?' - FirstChar;
+
+        if (previous >= 0)
+            pen.x += m_Kerning[previous * CharCount + index];
+
+        const Glyph& glyph = m_Glyphs[index];
+        if (glyph.Size.x > 0.0f)
+        {
+            glm::vec2 min = pen + glyph.Offset;
+            quads.push_back({ min, min + glyph.Size, glyph.UVMin, glyph.UVMax });
+        }
+
+        pen.x += glyph.Advance;
+        previous = index;
+    }
+}
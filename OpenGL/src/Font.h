@@ -0,0 +1,66 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// signed distance field font, ASCII 32-126 baked into a single GL_R8 atlas
+class Font
+{
+public:
+	static const int FirstChar = 32;
+	static const int CharCount = 95;
+	// the layout cache drops stale entries once it holds this many, see Layout
+	static const size_t MaxCachedLayouts = 4096;
+
+	struct Glyph
+	{
+		glm::vec2 Offset;   // bitmap bottom-left relative to the pen, y up
+		glm::vec2 Size;
+		glm::vec2 UVMin, UVMax;
+		float Advance;
+	};
+
+	// one glyph quad of a laid out string, in atlas pixels relative to the origin
+	struct GlyphQuad
+	{
+		glm::vec2 Min, Max;
+		glm::vec2 UVMin, UVMax;
+	};
+
+	Font(const std::string& path, float pixelHeight = 48.0f);
+	~Font();
+
+	// shapes the string once, later calls with the same text return the cached quads
+	const std::vector<GlyphQuad>& Layout(const std::string& text);
+
+	inline unsigned int GetTextureID() const { return m_RendererID; }
+	inline float GetPixelHeight() const { return m_PixelHeight; }
+	inline float GetLineHeight() const { return m_LineHeight; }
+	inline size_t GetCachedLayoutCount() const { return m_LayoutCache.size(); }
+	void ClearLayoutCache();
+
+private:
+	void Shape(const std::string& text, std::vector<GlyphQuad>& quads) const;
+
+	unsigned int m_RendererID;
+	float m_PixelHeight;
+	float m_LineHeight;
+	int m_AtlasWidth, m_AtlasHeight;
+
+	Glyph m_Glyphs[CharCount];
+	std::vector<float> m_Kerning;
+
+	struct CachedLayout
+	{
+		std::vector<GlyphQuad> Quads;
+		// m_LayoutCalls when it was last asked for
+		uint64_t LastUsed;
+	};
+	std::unordered_map<std::string, CachedLayout> m_LayoutCache;
+	uint64_t m_LayoutCalls = 0;
+	// cache size that triggers the next eviction pass
+	size_t m_EvictAt = MaxCachedLayouts;
+};
@@ -0,0 +1,104 @@
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <mutex>
+#include <new>
+
+// every thread's arena, so the main thread can reset them all
+static std::mutex s_ArenasMutex;
+static std::vector<FrameArena*> s_Arenas;
+
+namespace {
+
+    // registers the thread's arena for ResetAll and takes it out when the thread ends
+    struct ThreadArena
+    {
+        FrameArena Arena;
+
+        ThreadArena()
+        {
+            std::lock_guard<std::mutex> lock(s_ArenasMutex);
+            s_Arenas.push_back(&Arena);
+        }
+
+        ~ThreadArena()
+        {
+            std::lock_guard<std::mutex> lock(s_ArenasMutex);
+            s_Arenas.erase(std::find(s_Arenas.begin(), s_Arenas.end(), &Arena));
+        }
+    };
+
+}
+
+FrameArena& FrameArena::Get()
+{
+    static thread_local ThreadArena arena;
+    return arena.Arena;
+}
+
+void FrameArena::ResetAll()
+{
+    std::lock_guard<std::mutex> lock(s_ArenasMutex);
+    for (FrameArena* arena : s_Arenas)
+        arena->Reset();
+}
+
+FrameArena::FrameArena(size_t capacity)
+{
+    AddBlock(capacity);
+}
+
+FrameArena::~FrameArena()
+{
+    for (const Block& block : m_Blocks)
+        ::operator delete(block.Data, std::align_val_t(BlockAlignment));
+}
+
+void FrameArena::AddBlock(size_t size)
+{
+    size = (std::max<size_t>(size, 1) + BlockAlignment - 1) / BlockAlignment * BlockAlignment;
+    m_Blocks.push_back({ (uint8_t*)::operator new(size, std::align_val_t(BlockAlignment)), size });
+    m_Offset = 0;
+}
+
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+    Block& block = m_Blocks.back();
+    size_t offset = (m_Offset + alignment - 1) / alignment * alignment;
+    if (offset + size > block.Size)
+    {
+        // at least as big as the last block so a growing frame needs few of them
+        AddBlock(std::max(size + alignment, m_Blocks.back().Size));
+        offset = 0;
+    }
+
+    uint8_t* memory = m_Blocks.back().Data + offset;
+    m_Used += offset + size - m_Offset;
+    m_Offset = offset + size;
+    m_Peak = std::max(m_Peak, m_Used);
+    return memory;
+}
+
+void FrameArena::Reset()
+{
+    if (m_Blocks.size() > 1)
+    {
+        // one block big enough for the whole frame from now on
+        size_t capacity = GetCapacity();
+        for (const Block& block : m_Blocks)
+            ::operator delete(block.Data, std::align_val_t(BlockAlignment));
+        m_Blocks.clear();
+        AddBlock(capacity);
+    }
+
+    m_Offset = 0;
+    m_Used = 0;
+}
+
+size_t FrameArena::GetCapacity() const
+{
+    size_t capacity = 0;
+    for (const Block& block : m_Blocks)
+        capacity += block.Size;
+    return capacity;
+}
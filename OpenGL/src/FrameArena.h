@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+// bump allocator for data that dies with the frame: Allocate moves a pointer forward and
+// ResetAll at the end of the frame takes everything back at once; a frame that needs more
+// than the arena holds gets extra blocks, which are folded into one bigger block at the
+// next reset, so after the first few frames nothing reaches the heap
+class FrameArena
+{
+public:
+	static const size_t DefaultCapacity = 1 << 20;
+	static const size_t BlockAlignment = 64;
+
+	// the calling thread's arena, made on first use; only for threads that are idle when
+	// the frame ends, e.g. the main thread and WorkerPool ranges, not the loader threads
+	static FrameArena& Get();
+	// resets every thread's arena, call from the main thread once the frame is done
+	static void ResetAll();
+
+	FrameArena(size_t capacity = DefaultCapacity);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// uninitialized, nothing is destroyed on reset
+	template<typename T>
+	T* Allocate(size_t count)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "frame arena memory is never destroyed");
+		return (T*)Allocate(count * sizeof(T), alignof(T));
+	}
+
+	void Reset();
+
+	// this frame so far, the most any frame used and what the blocks hold
+	inline size_t GetUsed() const { return m_Used; }
+	inline size_t GetPeak() const { return m_Peak; }
+	size_t GetCapacity() const;
+
+private:
+	struct Block
+	{
+		uint8_t* Data;
+		size_t Size;
+	};
+
+	void AddBlock(size_t size);
+
+	std::vector<Block> m_Blocks;
+	// offset into the last block
+	size_t m_Offset = 0;
+	size_t m_Used = 0;
+	size_t m_Peak = 0;
+};
@@ -0,0 +1,405 @@
+#include "FrameCapture.h"
+
+#include "GpuMemoryTracker.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    static uint32_t table[256];
+    static bool initialized = false;
+    if (!initialized)
+    {
+        for (uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++)
+                c = c & 1 ? 0xedb88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+        initialized = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void PushBigEndian(std::vector<uint8_t>& out, uint32_t value)
+{
+    out.push_back((uint8_t)(value >> 24));
+    out.push_back((uint8_t)(value >> 16));
+    out.push_back((uint8_t)(value >> 8));
+    out.push_back((uint8_t)value);
+}
+
+static void WriteChunk(std::ofstream& stream, const char* type, const std::vector<uint8_t>& data)
+{
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    PushBigEndian(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    PushBigEndian(chunk, Crc32(chunk.data() + 4, data.size() + 4));
+    stream.write((const char*)chunk.data(), chunk.size());
+}
+
+// RGBA8 png with stored (uncompressed) deflate blocks, writing stays far cheaper
+// than the frame it captures and the output is still a valid png for diffing
+static bool WritePng(const std::string& path, const uint8_t* pixels, int width, int height)
+{
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream)
+        return false;
+
+    static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    stream.write((const char*)signature, sizeof(signature));
+
+    std::vector<uint8_t> header;
+    PushBigEndian(header, width);
+    PushBigEndian(header, height);
+    header.push_back(8); // bit depth
+    header.push_back(6); // RGBA
+    header.push_back(0);
+    header.push_back(0);
+    header.push_back(0);
+    WriteChunk(stream, "IHDR", header);
+
+    // filter byte per row, rows top down while GL returns them bottom up
+    size_t stride = (size_t)width * 4;
+    std::vector<uint8_t> scanlines;
+    scanlines.reserve((stride + 1) * height);
+    for (int y = height - 1; y >= 0; y--)
+    {
+        scanlines.push_back(0);
+        const uint8_t* row = pixels + y * stride;
+        scanlines.insert(scanlines.end(), row, row + stride);
+    }
+
+    const size_t MaxBlock = 65535;
+    std::vector<uint8_t> data;
+    data.reserve(scanlines.size() + scanlines.size() / MaxBlock * 5 + 16);
+    data.push_back(0x78);
+    data.push_back(0x01);
+    uint32_t a = 1, b = 0;
+    for (size_t offset = 0; offset < scanlines.size(); offset += MaxBlock)
+    {
+        size_t size = std::min(MaxBlock, scanlines.size() - offset);
+        data.push_back(offset + size == scanlines.size() ? 1 : 0);
+        data.push_back((uint8_t)size);
+        data.push_back((uint8_t)(size >> 8));
+        data.push_back((uint8_t)~size);
+        data.push_back((uint8_t)(~size >> 8));
+        data.insert(data.end(), scanlines.begin() + offset, scanlines.begin() + offset + size);
+
+        for (size_t i = offset; i < offset + size; i++)
+        {
+            a = (a + scanlines[i]) % 65521;
+            b = (b + a) % 65521;
+        }
+    }
+    PushBigEndian(data, (b << 16) | a);
+    WriteChunk(stream, "IDAT", data);
+    WriteChunk(stream, "IEND", {});
+    return true;
+}
+
+FrameCapture::FrameCapture()
+{
+}
+
+FrameCapture::~FrameCapture()
+{
+    if (m_Capturing)
+        Stop();
+
+    if (m_Worker.joinable())
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            m_Quit = true;
+        }
+        m_Condition.notify_one();
+        m_Worker.join();
+    }
+
+    ReleaseBuffers();
+}
+
+void FrameCapture::Start(const std::string& prefix, CaptureFormat format, int frameCount)
+{
+    if (m_Capturing)
+        Stop();
+
+    m_Prefix = prefix;
+    m_Format = format;
+    m_FramesLeft = frameCount;
+    m_NextFrame = 0;
+    m_FramesQueued = 0;
+    m_FramesDropped = 0;
+    m_Stalls = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_FramesWritten = 0;
+    }
+    m_Capturing = true;
+
+    if (!m_Worker.joinable())
+        m_Worker = std::thread(&FrameCapture::WorkerLoop, this);
+}
+
+void FrameCapture::Stop()
+{
+    // oldest first so the worker gets the frames in order
+    for (int i = 0; i < RingSize; i++)
+    {
+        Slot& slot = m_Slots[(m_SlotIndex + i) % RingSize];
+        if (slot.Fence)
+            Resolve(slot, true);
+    }
+    m_Capturing = false;
+
+    std::cout << "Captured " << m_FramesQueued << " frames to " << m_Prefix << "*, "
+        << m_FramesDropped << " dropped, " << m_Stalls << " stalls" << std::endl;
+}
+
+void FrameCapture::Resize(int width, int height)
+{
+    // frames of the old size still in flight are finished first
+    for (int i = 0; i < RingSize; i++)
+    {
+        Slot& slot = m_Slots[(m_SlotIndex + i) % RingSize];
+        if (slot.Fence)
+            Resolve(slot, true);
+    }
+    ReleaseBuffers();
+
+    m_Width = width;
+    m_Height = height;
+    for (Slot& slot : m_Slots)
+    {
+        GLCall(glCreateBuffers(1, &slot.Buffer));
+        GLCall(glNamedBufferStorage(slot.Buffer, (GLsizeiptr)width * height * 4, nullptr, GL_MAP_READ_BIT | GL_CLIENT_STORAGE_BIT));
+        GPU_TRACK(GpuResourceType::Buffer, slot.Buffer, (size_t)width * height * 4, "FrameCapture readback");
+    }
+    m_SlotIndex = 0;
+}
+
+void FrameCapture::ReleaseBuffers()
+{
+    for (Slot& slot : m_Slots)
+    {
+        if (slot.Fence)
+        {
+            GLCall(glDeleteSync((GLsync)slot.Fence));
+            slot.Fence = nullptr;
+        }
+        if (slot.Buffer)
+        {
+            GPU_UNTRACK(GpuResourceType::Buffer, slot.Buffer);
+            GLCall(glDeleteBuffers(1, &slot.Buffer));
+            slot.Buffer = 0;
+        }
+    }
+}
+
+void FrameCapture::Capture(unsigned int framebuffer, int width, int height)
+{
+    if (!m_Capturing || width <= 0 || height <= 0)
+        return;
+
+    PROFILE_SCOPE("FrameCapture");
+    auto start = std::chrono::high_resolution_clock::now();
+
+    if (width != m_Width || height != m_Height)
+        Resize(width, height);
+
+    // this slot was filled RingSize frames ago, normally its copy is long done
+    Slot& slot = m_Slots[m_SlotIndex];
+    if (slot.Fence && !Resolve(slot, false))
+    {
+        m_Stalls++;
+        Resolve(slot, true);
+    }
+
+    GLint previous = 0;
+    GLCall(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previous));
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer));
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.Buffer));
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+    // with a pack buffer bound this only queues the copy
+    GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    GLCall(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0));
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, previous));
+
+    GLCall(slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    slot.Frame = m_NextFrame++;
+    m_SlotIndex = (m_SlotIndex + 1) % RingSize;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_LastCaptureMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+    if (m_FramesLeft > 0 && --m_FramesLeft == 0)
+        Stop();
+}
+
+bool FrameCapture::Resolve(Slot& slot, bool wait)
+{
+    GLenum result;
+    if (wait)
+    {
+        GLCall(result = glClientWaitSync((GLsync)slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+    }
+    else
+    {
+        GLCall(result = glClientWaitSync((GLsync)slot.Fence, 0, 0));
+    }
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        if (!wait)
+            return false;
+        std::cout << "Frame capture timed out waiting for frame " << slot.Frame << std::endl;
+    }
+
+    GLCall(glDeleteSync((GLsync)slot.Fence));
+    slot.Fence = nullptr;
+    if (result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED)
+    {
+        m_FramesDropped++;
+        return true;
+    }
+
+    Job job;
+    job.Frame = slot.Frame;
+    job.Width = m_Width;
+    job.Height = m_Height;
+    job.Prefix = m_Prefix;
+    job.Format = m_Format;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        // the disk can't keep up, skip the frame rather than grow without bound
+        if (m_Jobs.size() >= MaxQueuedFrames)
+        {
+            m_FramesDropped++;
+            return true;
+        }
+        if (!m_FreeBuffers.empty())
+        {
+            job.Pixels.swap(m_FreeBuffers.back());
+            m_FreeBuffers.pop_back();
+        }
+    }
+
+    size_t size = (size_t)m_Width * m_Height * 4;
+    job.Pixels.resize(size);
+    GLCall(const void* data = glMapNamedBufferRange(slot.Buffer, 0, size, GL_MAP_READ_BIT));
+    if (data)
+    {
+        memcpy(job.Pixels.data(), data, size);
+        GLCall(glUnmapNamedBuffer(slot.Buffer));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Jobs.push_back(std::move(job));
+    }
+    m_Condition.notify_one();
+    m_FramesQueued++;
+    return true;
+}
+
+void FrameCapture::WorkerLoop()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Condition.wait(lock, [this]() { return m_Quit || !m_Jobs.empty(); });
+            if (m_Jobs.empty())
+                return;
+            job = std::move(m_Jobs.front());
+            m_Jobs.pop_front();
+        }
+
+        WriteFrame(job);
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_FreeBuffers.push_back(std::move(job.Pixels));
+        m_FramesWritten++;
+    }
+}
+
+void FrameCapture::WriteFrame(const Job& job)
+{
+    std::string number = std::to_string(job.Frame);
+    if (number.size() < 6)
+        number.insert(0, 6 - number.size(), '0');
+
+    std::string path;
+    bool written;
+    if (job.Format == CaptureFormat::Png)
+    {
+        path = job.Prefix + number + ".png";
+        written = WritePng(path, job.Pixels.data(), job.Width, job.Height);
+    }
+    else
+    {
+        // bottom up RGBA8 rows exactly as read back, the size goes in the name
+        path = job.Prefix + number + "_" + std::to_string(job.Width) + "x" + std::to_string(job.Height) + ".rgba";
+        std::ofstream stream(path, std::ios::binary);
+        stream.write((const char*)job.Pixels.data(), job.Pixels.size());
+        written = (bool)stream;
+    }
+
+    if (!written)
+        std::cout << "Failed to write '" << path << "'" << std::endl;
+}
+
+void FrameCapture::OnImGuiRender()
+{
+    ImGui::Begin("Frame Capture");
+
+    uint32_t written;
+    size_t queued;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        written = m_FramesWritten;
+        queued = m_Jobs.size();
+    }
+
+    if (m_Capturing)
+    {
+        ImGui::Text("Capturing to %s*", m_Prefix.c_str());
+        if (ImGui::Button("Stop"))
+            Stop();
+    }
+    else
+    {
+        static int format = 0;
+        ImGui::RadioButton("PNG", &format, 0);
+        ImGui::SameLine();
+        ImGui::RadioButton("Raw", &format, 1);
+        CaptureFormat selected = format == 0 ? CaptureFormat::Png : CaptureFormat::Raw;
+
+        if (ImGui::Button("Screenshot"))
+            Start("screenshot_", selected, 1);
+        ImGui::SameLine();
+        if (ImGui::Button("Record"))
+            Start("capture_", selected);
+    }
+
+    ImGui::Text("%u queued, %u written, %u dropped, %u stalls",
+        (unsigned int)queued, written, m_FramesDropped, m_Stalls);
+    ImGui::Text("Readback %.3f ms/frame", m_LastCaptureMs);
+
+    ImGui::End();
+}
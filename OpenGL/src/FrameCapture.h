@@ -0,0 +1,91 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class CaptureFormat
+{
+	Png, Raw
+};
+
+// reads frames back through a ring of pixel pack buffers, each one is mapped a few
+// frames after its glReadPixels so the CPU never waits on the GPU, a worker thread
+// does the file encoding
+class FrameCapture
+{
+public:
+	// a slot is mapped this many frames after it was filled
+	static const int RingSize = 3;
+	// frames waiting for the worker, more than this and new frames are dropped
+	static const size_t MaxQueuedFrames = 8;
+
+	FrameCapture();
+	~FrameCapture();
+
+	// writes <prefix>000000.png, ... frameCount < 0 captures until Stop
+	void Start(const std::string& prefix, CaptureFormat format, int frameCount = -1);
+	// reads back everything still in flight and stops capturing
+	void Stop();
+	inline bool IsCapturing() const { return m_Capturing; }
+
+	// queues a readback of the framebuffer (0 is the back buffer), call before the swap
+	void Capture(unsigned int framebuffer, int width, int height);
+
+	void OnImGuiRender();
+
+private:
+	struct Slot
+	{
+		unsigned int Buffer = 0;
+		void* Fence = nullptr;
+		uint32_t Frame = 0;
+	};
+
+	struct Job
+	{
+		std::vector<uint8_t> Pixels;
+		uint32_t Frame;
+		int Width, Height;
+		// copied so a restart can't change the name of frames still queued
+		std::string Prefix;
+		CaptureFormat Format;
+	};
+
+	void Resize(int width, int height);
+	// copies a finished slot into a job for the worker, waits on the fence if asked to
+	bool Resolve(Slot& slot, bool wait);
+	void ReleaseBuffers();
+
+	void WorkerLoop();
+	void WriteFrame(const Job& job);
+
+	Slot m_Slots[RingSize];
+	int m_SlotIndex = 0;
+	int m_Width = 0, m_Height = 0;
+
+	bool m_Capturing = false;
+	std::string m_Prefix;
+	CaptureFormat m_Format = CaptureFormat::Png;
+	int m_FramesLeft = 0;
+	uint32_t m_NextFrame = 0;
+
+	// stats
+	uint32_t m_FramesQueued = 0;
+	uint32_t m_FramesDropped = 0;
+	uint32_t m_Stalls = 0;
+	float m_LastCaptureMs = 0.0f;
+
+	std::thread m_Worker;
+	std::mutex m_Mutex;
+	std::condition_variable m_Condition;
+	std::deque<Job> m_Jobs;
+	// pixel storage handed back by the worker so steady state capture doesn't allocate
+	std::vector<std::vector<uint8_t>> m_FreeBuffers;
+	uint32_t m_FramesWritten = 0;
+	bool m_Quit = false;
+};
@@ -0,0 +1,128 @@
+#include "FramePacer.h"
+
+#include <GLFW/glfw3.h>
+
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "winmm.lib")
+#endif
+
+FramePacer::FramePacer(GLFWwindow* window)
+    : m_Window(window), m_Mode(PacingMode::VSync), m_TargetFps(60.0f),
+    m_FrameStart(Clock::now()), m_DeltaTime(0.0f),
+    m_FixedTimestep(false), m_FixedStep(1.0f / 60.0f), m_Accumulator(0.0f)
+{
+#ifdef _WIN32
+    // 1ms scheduler granularity, otherwise sleep_for overshoots by up to 15ms
+    timeBeginPeriod(1);
+#endif
+    ApplySwapInterval();
+}
+
+FramePacer::~FramePacer()
+{
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SetMode(PacingMode mode)
+{
+    m_Mode = mode;
+    ApplySwapInterval();
+}
+
+void FramePacer::ApplySwapInterval()
+{
+    if (!m_Window)
+        return;
+
+    switch (m_Mode)
+    {
+    case PacingMode::VSync:
+        glfwSwapInterval(1);
+        break;
+    case PacingMode::AdaptiveVSync:
+        // late frames tear instead of waiting a whole extra interval
+        if (glfwExtensionSupported("WGL_EXT_swap_control_tear") || glfwExtensionSupported("GLX_EXT_swap_control_tear"))
+            glfwSwapInterval(-1);
+        else
+            glfwSwapInterval(1);
+        break;
+    case PacingMode::Uncapped:
+    case PacingMode::TargetFps:
+        glfwSwapInterval(0);
+        break;
+    }
+}
+
+float FramePacer::BeginFrame()
+{
+    Clock::time_point now = Clock::now();
+    m_DeltaTime = std::min(std::chrono::duration<float>(now - m_FrameStart).count(), MaxDeltaTime);
+    m_FrameStart = now;
+
+    if (m_FixedTimestep)
+        m_Accumulator += m_DeltaTime;
+
+    return m_DeltaTime;
+}
+
+void FramePacer::EndFrame()
+{
+    if (m_Mode != PacingMode::TargetFps || m_TargetFps <= 0.0f)
+        return;
+
+    Clock::time_point deadline = m_FrameStart +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_TargetFps));
+
+    // sleep most of the way, then spin for the last stretch the scheduler can't hit
+    const auto spinThreshold = std::chrono::milliseconds(2);
+    Clock::time_point now = Clock::now();
+    if (deadline - now > spinThreshold)
+        std::this_thread::sleep_for(deadline - now - spinThreshold);
+
+    while (Clock::now() < deadline)
+        std::this_thread::yield();
+}
+
+int FramePacer::ConsumeFixedSteps()
+{
+    int steps = 0;
+    while (m_Accumulator >= m_FixedStep && steps < MaxFixedSteps)
+    {
+        m_Accumulator -= m_FixedStep;
+        steps++;
+    }
+
+    // too far behind, drop the backlog instead of spiralling
+    if (steps == MaxFixedSteps)
+        m_Accumulator = 0.0f;
+
+    return steps;
+}
+
+void FramePacer::OnImGuiRender()
+{
+    ImGui::Begin("Frame Pacing");
+
+    const char* modes[] = { "Uncapped", "VSync", "Adaptive VSync", "Target FPS" };
+    int mode = (int)m_Mode;
+    if (ImGui::Combo("Mode", &mode, modes, 4))
+        SetMode((PacingMode)mode);
+
+    if (m_Mode == PacingMode::TargetFps)
+        ImGui::SliderFloat("Target FPS", &m_TargetFps, 10.0f, 500.0f);
+
+    ImGui::Checkbox("Fixed timestep", &m_FixedTimestep);
+    ImGui::Text("Delta time %.3f ms", m_DeltaTime * 1000.0f);
+
+    ImGui::End();
+}
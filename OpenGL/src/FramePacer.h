@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+
+struct GLFWwindow;
+
+enum class PacingMode
+{
+	Uncapped, VSync, AdaptiveVSync, TargetFps
+};
+
+// measures delta time and limits the frame rate of the main loop
+class FramePacer
+{
+public:
+	// frames longer than this are clamped so a breakpoint doesn't fast forward the scene
+	static constexpr float MaxDeltaTime = 0.25f;
+	static const int MaxFixedSteps = 8;
+
+	FramePacer(GLFWwindow* window);
+	~FramePacer();
+
+	void SetMode(PacingMode mode);
+	inline PacingMode GetMode() const { return m_Mode; }
+	inline void SetTargetFps(float fps) { m_TargetFps = fps; }
+
+	inline void SetFixedTimestep(bool enabled, float step = 1.0f / 60.0f) { m_FixedTimestep = enabled; m_FixedStep = step; }
+	inline bool IsFixedTimestep() const { return m_FixedTimestep; }
+	inline float GetFixedStep() const { return m_FixedStep; }
+
+	// returns the seconds since the previous frame started
+	float BeginFrame();
+	// after the swap, waits out the rest of the frame in target fps mode
+	void EndFrame();
+
+	// number of fixed updates due this frame, the remainder carries over
+	int ConsumeFixedSteps();
+
+	void OnImGuiRender();
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	void ApplySwapInterval();
+
+	GLFWwindow* m_Window;
+	PacingMode m_Mode;
+	float m_TargetFps;
+
+	Clock::time_point m_FrameStart;
+	float m_DeltaTime;
+
+	bool m_FixedTimestep;
+	float m_FixedStep;
+	float m_Accumulator;
+};
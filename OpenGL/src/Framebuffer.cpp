@@ -0,0 +1,146 @@
+#include "Framebuffer.h"
+#include "GpuMemoryTracker.h"
+
+#include <iostream>
+#include <utility>
+
+Framebuffer::Framebuffer()
+    : m_RendererID(0), m_ColorAttachment(0), m_DepthStencilAttachment(0)
+{
+}
+
+Framebuffer::Framebuffer(const FramebufferSpec& spec)
+    : m_RendererID(0), m_ColorAttachment(0), m_DepthStencilAttachment(0), m_Spec(spec)
+{
+    Create();
+}
+
+Framebuffer::~Framebuffer()
+{
+    Release();
+}
+
+Framebuffer::Framebuffer(Framebuffer&& other) noexcept
+    : m_RendererID(other.m_RendererID), m_ColorAttachment(other.m_ColorAttachment),
+    m_DepthStencilAttachment(other.m_DepthStencilAttachment), m_Spec(other.m_Spec)
+{
+    other.m_RendererID = other.m_ColorAttachment = other.m_DepthStencilAttachment = 0;
+}
+
+Framebuffer& Framebuffer::operator=(Framebuffer&& other) noexcept
+{
+    std::swap(m_RendererID, other.m_RendererID);
+    std::swap(m_ColorAttachment, other.m_ColorAttachment);
+    std::swap(m_DepthStencilAttachment, other.m_DepthStencilAttachment);
+    std::swap(m_Spec, other.m_Spec);
+    return *this;
+}
+
+unsigned int Framebuffer::CreateAttachment(AttachmentType type, GLenum format, GLenum attachment)
+{
+    unsigned int id = 0;
+    if (type == AttachmentType::Texture)
+    {
+        GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &id));
+        GLCall(glTextureStorage2D(id, 1, format, m_Spec.Width, m_Spec.Height));
+        GPU_TRACK(GpuResourceType::Texture, id, (size_t)m_Spec.Width * m_Spec.Height * GetGpuFormatSize(format), "Framebuffer attachment");
+        GLCall(glTextureParameteri(id, GL_TEXTURE_MIN_FILTER, m_Spec.Filter));
+        GLCall(glTextureParameteri(id, GL_TEXTURE_MAG_FILTER, m_Spec.Filter));
+        GLCall(glTextureParameteri(id, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+        GLCall(glTextureParameteri(id, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        if (attachment == GL_DEPTH_STENCIL_ATTACHMENT)
+        {
+            GLCall(glTextureParameteri(id, GL_DEPTH_STENCIL_TEXTURE_MODE, m_Spec.DepthStencilTextureMode));
+        }
+        GLCall(glNamedFramebufferTexture(m_RendererID, attachment, id, 0));
+    }
+    else if (type == AttachmentType::Renderbuffer)
+    {
+        GLCall(glCreateRenderbuffers(1, &id));
+        GLCall(glNamedRenderbufferStorage(id, format, m_Spec.Width, m_Spec.Height));
+        GPU_TRACK(GpuResourceType::Renderbuffer, id, (size_t)m_Spec.Width * m_Spec.Height * GetGpuFormatSize(format), "Framebuffer attachment");
+        GLCall(glNamedFramebufferRenderbuffer(m_RendererID, attachment, GL_RENDERBUFFER, id));
+    }
+    return id;
+}
+
+void Framebuffer::Create()
+{
+    if (m_Spec.Width <= 0 || m_Spec.Height <= 0)
+        return;
+
+    GLCall(glCreateFramebuffers(1, &m_RendererID));
+    GPU_TRACK(GpuResourceType::Framebuffer, m_RendererID, 0, std::to_string(m_Spec.Width) + "x" + std::to_string(m_Spec.Height));
+    m_ColorAttachment = CreateAttachment(m_Spec.Color, m_Spec.ColorFormat, GL_COLOR_ATTACHMENT0);
+    m_DepthStencilAttachment = CreateAttachment(m_Spec.DepthStencil, m_Spec.DepthStencilFormat, GL_DEPTH_STENCIL_ATTACHMENT);
+    if (m_Spec.Color == AttachmentType::None)
+    {
+        GLCall(glNamedFramebufferDrawBuffer(m_RendererID, GL_NONE));
+    }
+
+    GLenum status;
+    GLCall(status = glCheckNamedFramebufferStatus(m_RendererID, GL_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer " << m_Spec.Width << "x" << m_Spec.Height << " incomplete: 0x"
+            << std::hex << status << std::dec << std::endl;
+}
+
+void Framebuffer::Release()
+{
+    if (!m_RendererID)
+        return;
+
+    GPU_UNTRACK(GpuResourceType::Framebuffer, m_RendererID);
+    GLCall(glDeleteFramebuffers(1, &m_RendererID));
+    if (m_Spec.Color == AttachmentType::Texture)
+    {
+        GPU_UNTRACK(GpuResourceType::Texture, m_ColorAttachment);
+        GLCall(glDeleteTextures(1, &m_ColorAttachment));
+    }
+    else if (m_Spec.Color == AttachmentType::Renderbuffer)
+    {
+        GPU_UNTRACK(GpuResourceType::Renderbuffer, m_ColorAttachment);
+        GLCall(glDeleteRenderbuffers(1, &m_ColorAttachment));
+    }
+    if (m_Spec.DepthStencil == AttachmentType::Texture)
+    {
+        GPU_UNTRACK(GpuResourceType::Texture, m_DepthStencilAttachment);
+        GLCall(glDeleteTextures(1, &m_DepthStencilAttachment));
+    }
+    else if (m_Spec.DepthStencil == AttachmentType::Renderbuffer)
+    {
+        GPU_UNTRACK(GpuResourceType::Renderbuffer, m_DepthStencilAttachment);
+        GLCall(glDeleteRenderbuffers(1, &m_DepthStencilAttachment));
+    }
+    m_RendererID = m_ColorAttachment = m_DepthStencilAttachment = 0;
+}
+
+bool Framebuffer::Resize(int width, int height)
+{
+    if (m_RendererID && width == m_Spec.Width && height == m_Spec.Height)
+        return false;
+
+    // immutable storage, the attachments have to be recreated
+    Release();
+    m_Spec.Width = width;
+    m_Spec.Height = height;
+    Create();
+    return true;
+}
+
+void Framebuffer::Bind() const
+{
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID));
+    GLCall(glViewport(0, 0, m_Spec.Width, m_Spec.Height));
+}
+
+void Framebuffer::Unbind() const
+{
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+}
+
+void Framebuffer::BlitTo(unsigned int target, GLbitfield mask) const
+{
+    GLCall(glBlitNamedFramebuffer(m_RendererID, target, 0, 0, m_Spec.Width, m_Spec.Height,
+        0, 0, m_Spec.Width, m_Spec.Height, mask, GL_NEAREST));
+}
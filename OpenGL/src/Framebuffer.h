@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Renderer.h"
+
+// what backs an attachment, textures can be sampled afterwards, renderbuffers only
+// rendered to and blitted
+enum class AttachmentType
+{
+	None, Texture, Renderbuffer
+};
+
+struct FramebufferSpec
+{
+	int Width = 0, Height = 0;
+
+	AttachmentType Color = AttachmentType::Texture;
+	GLenum ColorFormat = GL_RGBA8;
+	// sampling filter of a color or depth texture
+	GLenum Filter = GL_LINEAR;
+
+	AttachmentType DepthStencil = AttachmentType::Renderbuffer;
+	GLenum DepthStencilFormat = GL_DEPTH24_STENCIL8;
+	// GL_STENCIL_INDEX samples the stencil of a depth/stencil texture instead
+	GLenum DepthStencilTextureMode = GL_DEPTH_COMPONENT;
+};
+
+// FBO with up to one color and one depth/stencil attachment, created with DSA so
+// nothing gets bound until Bind
+class Framebuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_ColorAttachment, m_DepthStencilAttachment;
+	FramebufferSpec m_Spec;
+public:
+	// empty, nothing is created until it's assigned or resized to a real size
+	Framebuffer();
+	Framebuffer(const FramebufferSpec& spec);
+	~Framebuffer();
+
+	Framebuffer(const Framebuffer&) = delete;
+	Framebuffer& operator=(const Framebuffer&) = delete;
+	Framebuffer(Framebuffer&& other) noexcept;
+	Framebuffer& operator=(Framebuffer&& other) noexcept;
+
+	// recreates the attachments when the size differs, returns true if it did since
+	// their contents are undefined afterwards
+	bool Resize(int width, int height);
+
+	// binds for drawing and reading and sets the viewport to cover it
+	void Bind() const;
+	void Unbind() const;
+	// copies into the framebuffer target (0 for the default one) at the same size
+	void BlitTo(unsigned int target, GLbitfield mask = GL_COLOR_BUFFER_BIT) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	// texture or renderbuffer name depending on the spec
+	inline unsigned int GetColorAttachment() const { return m_ColorAttachment; }
+	inline unsigned int GetDepthStencilAttachment() const { return m_DepthStencilAttachment; }
+	inline int GetWidth() const { return m_Spec.Width; }
+	inline int GetHeight() const { return m_Spec.Height; }
+	inline const FramebufferSpec& GetSpec() const { return m_Spec; }
+private:
+	void Create();
+	void Release();
+	unsigned int CreateAttachment(AttachmentType type, GLenum format, GLenum attachment);
+};
@@ -0,0 +1,205 @@
+#include "GpuMemoryTracker.h"
+
+#include "imgui/imgui.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+const char* GetGpuResourceTypeName(GpuResourceType type)
+{
+    switch (type)
+    {
+    case GpuResourceType::Buffer: return "Buffer";
+    case GpuResourceType::Texture: return "Texture";
+    case GpuResourceType::Renderbuffer: return "Renderbuffer";
+    case GpuResourceType::VertexArray: return "Vertex array";
+    case GpuResourceType::Framebuffer: return "Framebuffer";
+    case GpuResourceType::Program: return "Program";
+    }
+    return "Unknown";
+}
+
+size_t GetGpuFormatSize(unsigned int internalFormat)
+{
+    switch (internalFormat)
+    {
+    case GL_R8: return 1;
+    case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16: return 2;
+    case GL_RGB8: return 3;
+    case GL_RGBA8: case GL_SRGB8_ALPHA8: case GL_RG16F: case GL_R32F: case GL_R32UI: case GL_RGB10_A2:
+    case GL_R11F_G11F_B10F: case GL_DEPTH24_STENCIL8: case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32F:
+        return 4;
+    case GL_DEPTH32F_STENCIL8: case GL_RGBA16F: case GL_RG32F: return 8;
+    case GL_RGBA32F: return 16;
+    }
+    return 0;
+}
+
+// the file name without its directories
+static const char* FileName(const char* path)
+{
+    const char* name = path;
+    for (const char* c = path; *c; c++)
+    {
+        if (*c == '/' || *c == '\\')
+            name = c + 1;
+    }
+    return name;
+}
+
+GpuMemoryTracker& GpuMemoryTracker::Get()
+{
+    static GpuMemoryTracker tracker;
+    return tracker;
+}
+
+GpuMemoryTracker::GpuMemoryTracker()
+{
+}
+
+void GpuMemoryTracker::Track(GpuResourceType type, unsigned int id, size_t bytes, const std::string& name,
+    const char* file, int line)
+{
+    if (id == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Record& record = m_Records[MakeKey(type, id)];
+    // a recycled id whose delete wasn't tracked, don't count it twice
+    if (record.Serial != 0)
+    {
+        m_Totals[(int)type].Count--;
+        m_Totals[(int)type].Bytes -= record.Bytes;
+    }
+
+    record = { type, bytes, m_NextSerial++, name, FileName(file), line, m_SharedDepth > 0 };
+    m_Totals[(int)type].Count++;
+    m_Totals[(int)type].Bytes += bytes;
+    m_PeakBytes = std::max(m_PeakBytes, GetTotals().Bytes);
+}
+
+void GpuMemoryTracker::Resize(GpuResourceType type, unsigned int id, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Records.find(MakeKey(type, id));
+    if (it == m_Records.end())
+        return;
+
+    m_Totals[(int)type].Bytes += bytes - it->second.Bytes;
+    it->second.Bytes = bytes;
+    m_PeakBytes = std::max(m_PeakBytes, GetTotals().Bytes);
+}
+
+void GpuMemoryTracker::Untrack(GpuResourceType type, unsigned int id)
+{
+    if (id == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    auto it = m_Records.find(MakeKey(type, id));
+    if (it == m_Records.end())
+        return;
+
+    m_Totals[(int)type].Count--;
+    m_Totals[(int)type].Bytes -= it->second.Bytes;
+    m_Records.erase(it);
+}
+
+GpuMemoryTracker::Totals GpuMemoryTracker::GetTotals() const
+{
+    Totals totals;
+    for (const Totals& type : m_Totals)
+    {
+        totals.Count += type.Count;
+        totals.Bytes += type.Bytes;
+    }
+    return totals;
+}
+
+size_t GpuMemoryTracker::ReportLeaks(const std::string& context, uint64_t marker, bool includeShared) const
+{
+    std::vector<const Record*> leaks;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (const auto& entry : m_Records)
+        {
+            const Record& record = entry.second;
+            if (record.Serial >= marker && (includeShared || !record.Shared))
+                leaks.push_back(&record);
+        }
+
+        // in creation order
+        std::sort(leaks.begin(), leaks.end(), [](const Record* a, const Record* b) { return a->Serial < b->Serial; });
+        uint64_t bytes = 0;
+        for (const Record* record : leaks)
+        {
+            std::cout << "LEAK " << context << ": " << GetGpuResourceTypeName(record->Type) << " '" << record->Name
+                << "', " << record->Bytes << " bytes, created at " << record->File << ":" << record->Line << "\n";
+            bytes += record->Bytes;
+        }
+        if (!leaks.empty())
+            std::cout << context << ": " << leaks.size() << " GL objects (" << bytes << " bytes) still alive" << std::endl;
+    }
+    return leaks.size();
+}
+
+void GpuMemoryTracker::OnImGuiRender()
+{
+    ImGui::Begin("GPU Memory");
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    Totals total = GetTotals();
+    ImGui::Text("%u objects, %.2f MB, peak %.2f MB", total.Count, total.Bytes / (1024.0 * 1024.0),
+        m_PeakBytes / (1024.0 * 1024.0));
+
+    if (ImGui::BeginTable("Types", 3))
+    {
+        ImGui::TableSetupColumn("Type");
+        ImGui::TableSetupColumn("Live");
+        ImGui::TableSetupColumn("MB");
+        ImGui::TableHeadersRow();
+        for (int i = 0; i < GpuResourceTypeCount; i++)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s", GetGpuResourceTypeName((GpuResourceType)i));
+            ImGui::TableNextColumn(); ImGui::Text("%u", m_Totals[i].Count);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", m_Totals[i].Bytes / (1024.0 * 1024.0));
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::CollapsingHeader("Largest objects"))
+    {
+        std::vector<const Record*> records;
+        records.reserve(m_Records.size());
+        for (const auto& entry : m_Records)
+            records.push_back(&entry.second);
+        size_t shown = std::min<size_t>(records.size(), 50);
+        std::partial_sort(records.begin(), records.begin() + shown, records.end(),
+            [](const Record* a, const Record* b) { return a->Bytes > b->Bytes; });
+
+        if (ImGui::BeginTable("Objects", 4))
+        {
+            ImGui::TableSetupColumn("Type");
+            ImGui::TableSetupColumn("Name");
+            ImGui::TableSetupColumn("KB");
+            ImGui::TableSetupColumn("Created at");
+            ImGui::TableHeadersRow();
+            for (size_t i = 0; i < shown; i++)
+            {
+                const Record& record = *records[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::Text("%s", GetGpuResourceTypeName(record.Type));
+                ImGui::TableNextColumn(); ImGui::Text("%s%s", record.Name.c_str(), record.Shared ? " (shared)" : "");
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", record.Bytes / 1024.0);
+                ImGui::TableNextColumn(); ImGui::Text("%s:%d", record.File, record.Line);
+            }
+            ImGui::EndTable();
+        }
+    }
+
+    ImGui::End();
+}
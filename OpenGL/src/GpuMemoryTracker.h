@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+enum class GpuResourceType
+{
+	Buffer, Texture, Renderbuffer, VertexArray, Framebuffer, Program
+};
+static const int GpuResourceTypeCount = 6;
+
+const char* GetGpuResourceTypeName(GpuResourceType type);
+// bytes per pixel of a sized internal format, 0 if unknown
+size_t GetGpuFormatSize(unsigned int internalFormat);
+
+// records where every GL object was created, GPU_TRACK right after the glCreate* call
+// and GPU_UNTRACK before the glDelete*, e.g.
+//
+//     GLCall(glCreateBuffers(1, &m_RendererID));
+//     GPU_TRACK(GpuResourceType::Buffer, m_RendererID, size, "IndexBuffer");
+#define GPU_TRACK(type, id, bytes, name) GpuMemoryTracker::Get().Track(type, id, bytes, name, __FILE__, __LINE__)
+#define GPU_UNTRACK(type, id) GpuMemoryTracker::Get().Untrack(type, id)
+
+// live GL objects with their estimated size, creation site and a serial number, so
+// whatever a test created and didn't delete can be listed when it's closed
+class GpuMemoryTracker
+{
+public:
+	struct Totals
+	{
+		uint32_t Count = 0;
+		uint64_t Bytes = 0;
+	};
+
+	// objects created while one of these is alive belong to something that outlives
+	// tests, like the resource manager's caches, and don't count as leaks of a test
+	class SharedScope
+	{
+	public:
+		SharedScope() { GpuMemoryTracker::Get().m_SharedDepth++; }
+		~SharedScope() { GpuMemoryTracker::Get().m_SharedDepth--; }
+		SharedScope(const SharedScope&) = delete;
+		SharedScope& operator=(const SharedScope&) = delete;
+	};
+
+	static GpuMemoryTracker& Get();
+
+	// ids of 0 are ignored, the name is anything that tells the object apart, e.g. a path
+	void Track(GpuResourceType type, unsigned int id, size_t bytes, const std::string& name,
+		const char* file, int line);
+	// storage was respecified, e.g. a buffer reallocated with a new size
+	void Resize(GpuResourceType type, unsigned int id, size_t bytes);
+	void Untrack(GpuResourceType type, unsigned int id);
+
+	inline Totals GetTotals(GpuResourceType type) const { return m_Totals[(int)type]; }
+	Totals GetTotals() const;
+
+	// serial number of the next object, pass it to ReportLeaks later
+	inline uint64_t GetMarker() const { return m_NextSerial; }
+	// prints the objects created since marker that are still alive, shared ones only
+	// when includeShared is set, returns how many
+	size_t ReportLeaks(const std::string& context, uint64_t marker = 0, bool includeShared = false) const;
+
+	void OnImGuiRender();
+
+private:
+	struct Record
+	{
+		GpuResourceType Type = GpuResourceType::Buffer;
+		uint64_t Bytes = 0;
+		// 0 until tracked
+		uint64_t Serial = 0;
+		std::string Name;
+		const char* File = "";
+		int Line = 0;
+		bool Shared = false;
+	};
+
+	GpuMemoryTracker();
+
+	static inline uint64_t MakeKey(GpuResourceType type, unsigned int id) { return (uint64_t)type << 32 | id; }
+
+	// the GL thread does the tracking, the lock is for panels and reports elsewhere
+	mutable std::mutex m_Mutex;
+	std::unordered_map<uint64_t, Record> m_Records;
+	Totals m_Totals[GpuResourceTypeCount];
+	uint64_t m_NextSerial = 1;
+	int m_SharedDepth = 0;
+	// peak of the byte total since startup
+	uint64_t m_PeakBytes = 0;
+};
@@ -0,0 +1,130 @@
+#include "HeadlessContext.h"
+
+#include "Renderer.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+// no surfaceless EGL on windows, an invisible GLFW window gives us the context
+#include <GLFW/glfw3.h>
+#else
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+HeadlessContext::HeadlessContext(int width, int height)
+    : m_Display(nullptr), m_Context(nullptr),
+    m_Width(width), m_Height(height), m_Valid(false)
+{
+#ifdef _WIN32
+    if (!glfwInit())
+        return;
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(1, 1, "Headless", NULL, NULL);
+    if (!window)
+    {
+        std::cout << "Failed to create hidden window" << std::endl;
+        glfwTerminate();
+        return;
+    }
+    glfwMakeContextCurrent(window);
+    m_Context = window;
+    m_Valid = true;
+#else
+    // surfaceless platform works without X11/Wayland, e.g. Mesa llvmpipe in a container
+    EGLDisplay display = EGL_NO_DISPLAY;
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay)
+        display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display == EGL_NO_DISPLAY)
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+    {
+        std::cout << "Failed to initialize EGL display" << std::endl;
+        return;
+    }
+    m_Display = display;
+
+    // the surface type defaults to window, which the surfaceless platform has no configs for
+    const EGLint configAttributes[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0)
+    {
+        std::cout << "No EGL config with desktop OpenGL support" << std::endl;
+        return;
+    }
+
+    eglBindAPI(EGL_OPENGL_API);
+
+    // version 4.5 core
+    const EGLint contextAttributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+    if (context == EGL_NO_CONTEXT)
+    {
+        std::cout << "Failed to create EGL context" << std::endl;
+        return;
+    }
+    m_Context = context;
+
+    if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        std::cout << "Failed to make EGL context current" << std::endl;
+        return;
+    }
+    m_Valid = true;
+#endif
+}
+
+HeadlessContext::~HeadlessContext()
+{
+    // the GL objects have to go before the context does
+    m_Framebuffer = Framebuffer();
+
+#ifdef _WIN32
+    if (m_Context)
+        glfwDestroyWindow((GLFWwindow*)m_Context);
+    glfwTerminate();
+#else
+    if (m_Display)
+    {
+        eglMakeCurrent((EGLDisplay)m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+        if (m_Context)
+            eglDestroyContext((EGLDisplay)m_Display, (EGLContext)m_Context);
+        eglTerminate((EGLDisplay)m_Display);
+    }
+#endif
+}
+
+void HeadlessContext::CreateRenderTarget()
+{
+    FramebufferSpec spec;
+    spec.Width = m_Width;
+    spec.Height = m_Height;
+    m_Framebuffer = Framebuffer(spec);
+}
+
+void HeadlessContext::Bind() const
+{
+    m_Framebuffer.Bind();
+}
+
+void HeadlessContext::Unbind() const
+{
+    m_Framebuffer.Unbind();
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Framebuffer.h"
+
+// offscreen OpenGL 4.5 core context for machines without a display,
+// renders into an FBO instead of a window back buffer
+class HeadlessContext
+{
+private:
+	void* m_Display;
+	void* m_Context;
+	Framebuffer m_Framebuffer;
+	int m_Width, m_Height;
+	bool m_Valid;
+public:
+	HeadlessContext(int width, int height);
+	~HeadlessContext();
+
+	// creates the render target, call after glewInit
+	void CreateRenderTarget();
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline bool IsValid() const { return m_Valid; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline unsigned int GetFramebufferID() const { return m_Framebuffer.GetRendererID(); }
+	inline unsigned int GetColorAttachment() const { return m_Framebuffer.GetColorAttachment(); }
+};
@@ -1,19 +1,38 @@
 #include "IndexBuffer.h"
+#include "GpuMemoryTracker.h"
 #include "Renderer.h"
 
+#include <utility>
+
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	: m_Count(count)
 {
-	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
-	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	// DSA, binding GL_ELEMENT_ARRAY_BUFFER here would change whatever VAO happens to be bound
+	GLCall(glCreateBuffers(1, &m_RendererID));
+	GLCall(glNamedBufferData(m_RendererID, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+	GPU_TRACK(GpuResourceType::Buffer, m_RendererID, count * sizeof(unsigned int), "IndexBuffer");
 }
 
 IndexBuffer::~IndexBuffer()
 {
+	GPU_UNTRACK(GpuResourceType::Buffer, m_RendererID);
 	GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
+IndexBuffer::IndexBuffer(IndexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_Count(other.m_Count)
+{
+	other.m_RendererID = 0;
+	other.m_Count = 0;
+}
+
+IndexBuffer& IndexBuffer::operator=(IndexBuffer&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_Count, other.m_Count);
+	return *this;
+}
+
 void IndexBuffer::Bind() const
 {
 	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
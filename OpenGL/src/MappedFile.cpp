@@ -0,0 +1,135 @@
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : m_Data(nullptr), m_Size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_Data(other.m_Data), m_Size(other.m_Size)
+{
+    other.m_Data = nullptr;
+    other.m_Size = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    std::swap(m_Data, other.m_Data);
+    std::swap(m_Size, other.m_Size);
+    return *this;
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    // the file handles can go right away, the mapping keeps the file alive
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        std::cout << "Failed to open '" << path << "'" << std::endl;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        std::cout << "'" << path << "' is empty" << std::endl;
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping)
+    {
+        std::cout << "Failed to map '" << path << "'" << std::endl;
+        return false;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data)
+    {
+        std::cout << "Failed to map '" << path << "'" << std::endl;
+        return false;
+    }
+    m_Data = (const uint8_t*)data;
+    m_Size = (size_t)size.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        std::cout << "Failed to open '" << path << "'" << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        close(file);
+        std::cout << "'" << path << "' is empty" << std::endl;
+        return false;
+    }
+    void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+    {
+        std::cout << "Failed to map '" << path << "'" << std::endl;
+        return false;
+    }
+    m_Data = (const uint8_t*)data;
+    m_Size = (size_t)info.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (!m_Data)
+        return;
+
+#ifdef _WIN32
+    UnmapViewOfFile(m_Data);
+#else
+    munmap((void*)m_Data, m_Size);
+#endif
+    m_Data = nullptr;
+    m_Size = 0;
+}
+
+void MappedFile::Release(size_t offset, size_t size) const
+{
+    if (!m_Data || size == 0 || offset >= m_Size)
+        return;
+    size = std::min(size, m_Size - offset);
+
+#ifdef _WIN32
+    // unlocking pages that aren't locked takes them out of the working set
+    VirtualUnlock((void*)(m_Data + offset), size);
+#else
+    // madvise wants a page aligned start, the partial pages at the ends go too
+    static const uintptr_t pageSize = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t begin = ((uintptr_t)m_Data + offset) / pageSize * pageSize;
+    uintptr_t end = (uintptr_t)m_Data + offset + size;
+    madvise((void*)begin, end - begin, MADV_DONTNEED);
+#endif
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// read-only view of a whole file, the OS pages it in on first touch so opening costs
+// the same for any size and nothing is copied
+class MappedFile
+{
+private:
+	const uint8_t* m_Data;
+	size_t m_Size;
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	bool Open(const std::string& path);
+	void Close();
+
+	// lets the OS drop the pages of [offset, offset + size) from this process, they stay
+	// readable and come back from the file if touched again
+	void Release(size_t offset, size_t size) const;
+
+	inline bool IsOpen() const { return m_Data != nullptr; }
+	inline const uint8_t* GetData() const { return m_Data; }
+	inline size_t GetSize() const { return m_Size; }
+};
@@ -0,0 +1,144 @@
+#include "OverdrawView.h"
+
+#include "CommandCapture.h"
+#include "Renderer.h"
+#include "Profiler.h"
+#include "ResourceManager.h"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+
+OverdrawView::OverdrawView()
+{
+    m_Shader = ResourceManager::Get().GetShader("res/shaders/Overdraw.shader");
+
+    // the stencil is read as integers, which needs nearest filtering
+    FramebufferSpec spec;
+    spec.Filter = GL_NEAREST;
+    spec.DepthStencil = AttachmentType::Texture;
+    spec.DepthStencilTextureMode = GL_STENCIL_INDEX;
+    m_Framebuffer = Framebuffer(spec);
+}
+
+OverdrawView::~OverdrawView()
+{
+}
+
+void OverdrawView::Begin()
+{
+    if (!m_Enabled)
+        return;
+
+    GLint viewport[4];
+    GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+    if (viewport[2] <= 0 || viewport[3] <= 0)
+        return;
+    if (m_Framebuffer.Resize(viewport[2], viewport[3]))
+        m_Counts.resize((size_t)viewport[2] * viewport[3]);
+
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_PreviousFramebuffer));
+    m_Framebuffer.Bind();
+
+    GLCall(glStencilMask(0xff));
+    GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+    GLCall(glClearStencil(0));
+    Renderer::Clear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+    // fragments rejected by the depth test are never shaded, they don't count
+    GLCall(glEnable(GL_STENCIL_TEST));
+    GLCall(glStencilFunc(GL_ALWAYS, 0, 0xff));
+    GLCall(glStencilOp(GL_KEEP, GL_KEEP, GL_INCR));
+
+    m_Active = true;
+}
+
+void OverdrawView::End()
+{
+    if (!m_Active)
+        return;
+    m_Active = false;
+
+    PROFILE_SCOPE("Overdraw");
+
+    GLCall(glDisable(GL_STENCIL_TEST));
+
+    {
+        PROFILE_SCOPE("Readback");
+        GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, m_Framebuffer.GetRendererID()));
+        GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 1));
+        GLCall(glReadPixels(0, 0, m_Framebuffer.GetWidth(), m_Framebuffer.GetHeight(), GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, m_Counts.data()));
+        GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+    }
+
+    m_Histogram.fill(0);
+    uint64_t total = 0;
+    int maxCount = 0;
+    for (uint8_t count : m_Counts)
+    {
+        total += count;
+        maxCount = std::max(maxCount, (int)count);
+        m_Histogram[std::min((int)count, HistogramSize - 1)]++;
+    }
+    m_Average = m_Counts.empty() ? 0.0f : (float)((double)total / m_Counts.size());
+    m_MaxCount = maxCount;
+    Renderer::GetFrameStats().Overdraw = m_Average;
+
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_PreviousFramebuffer));
+
+    GLboolean blend, depthTest;
+    GLCall(blend = glIsEnabled(GL_BLEND));
+    GLCall(depthTest = glIsEnabled(GL_DEPTH_TEST));
+    GLCall(glDisable(GL_BLEND));
+    GLCall(glDisable(GL_DEPTH_TEST));
+
+    m_Shader->Bind();
+    GLCall(glBindTextureUnit(0, m_Framebuffer.GetColorAttachment()));
+    GLCall(glBindTextureUnit(1, m_Framebuffer.GetDepthStencilAttachment()));
+    m_Shader->SetUniform1i("u_Color", 0);
+    m_Shader->SetUniform1i("u_Counts", 1);
+    m_Shader->SetUniform1i("u_Mode", (int)m_Mode);
+    m_Shader->SetUniform1f("u_MaxCount", m_HeatScale);
+    m_Shader->SetUniform1f("u_Opacity", m_Opacity);
+    m_EmptyVAO.Bind();
+    CommandCapture::Get().RecordDraw(GL_TRIANGLES, 3, 0, 0);
+    GLCall(glDrawArrays(GL_TRIANGLES, 0, 3));
+
+    if (blend)
+    {
+        GLCall(glEnable(GL_BLEND));
+    }
+    if (depthTest)
+    {
+        GLCall(glEnable(GL_DEPTH_TEST));
+    }
+}
+
+void OverdrawView::OnImGuiRender()
+{
+    ImGui::Begin("Overdraw");
+
+    ImGui::Checkbox("Count fragments", &m_Enabled);
+    int mode = (int)m_Mode;
+    ImGui::RadioButton("Scene", &mode, (int)Mode::Scene);
+    ImGui::SameLine();
+    ImGui::RadioButton("Overlay", &mode, (int)Mode::Overlay);
+    ImGui::SameLine();
+    ImGui::RadioButton("Heatmap", &mode, (int)Mode::Heatmap);
+    m_Mode = (Mode)mode;
+    ImGui::SliderFloat("Red at", &m_HeatScale, 1.0f, 32.0f, "%.0f fragments");
+    ImGui::SliderFloat("Opacity", &m_Opacity, 0.0f, 1.0f);
+
+    if (m_Enabled && !m_Counts.empty())
+    {
+        ImGui::Text("%.2f fragments per pixel, max %d", m_Average, m_MaxCount);
+
+        // share of the pixels per count
+        float shares[HistogramSize];
+        for (int i = 0; i < HistogramSize; i++)
+            shares[i] = 100.0f * m_Histogram[i] / m_Counts.size();
+        ImGui::PlotHistogram("% of pixels", shares, HistogramSize, 0, nullptr, 0.0f, 100.0f, { 0.0f, 80.0f });
+        ImGui::Text("0 .. %d fragments, the last bar is %d or more", HistogramSize - 2, HistogramSize - 1);
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Framebuffer.h"
+#include "Shader.h"
+#include "VertexArray.h"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// debug mode counting how often every pixel is shaded, the test renders into an offscreen
+// target whose stencil is incremented by each fragment that passes the depth test, End
+// shows the image with an optional heatmap and reads the counts back for the statistics
+class OverdrawView
+{
+public:
+	enum class Mode
+	{
+		Scene, Overlay, Heatmap
+	};
+
+	// buckets 0 .. N - 2 are exact counts, the last one holds everything above
+	static const int HistogramSize = 12;
+
+	OverdrawView();
+	~OverdrawView();
+
+	OverdrawView(const OverdrawView&) = delete;
+	OverdrawView& operator=(const OverdrawView&) = delete;
+
+	inline void SetEnabled(bool enabled) { m_Enabled = enabled; }
+	inline bool IsEnabled() const { return m_Enabled; }
+	inline void SetMode(Mode mode) { m_Mode = mode; }
+
+	// redirects rendering into the counting target, sized to the current viewport
+	void Begin();
+	// draws into the framebuffer bound at Begin and updates the statistics, the
+	// readback waits for the GPU so this is for inspection, not for timing
+	void End();
+
+	// shaded fragments per pixel, counts saturate at 255
+	inline float GetAverage() const { return m_Average; }
+	inline int GetMaxCount() const { return m_MaxCount; }
+	inline const std::array<uint32_t, HistogramSize>& GetHistogram() const { return m_Histogram; }
+
+	void OnImGuiRender();
+
+private:
+	bool m_Enabled = false;
+	bool m_Active = false;
+	Mode m_Mode = Mode::Overlay;
+	// count shown in red
+	float m_HeatScale = 8.0f;
+	float m_Opacity = 0.6f;
+
+	// color and a depth/stencil texture sampled as the stencil index
+	Framebuffer m_Framebuffer;
+
+	// state restored by End
+	int m_PreviousFramebuffer = 0;
+
+	std::shared_ptr<Shader> m_Shader;
+	// bound for the fullscreen triangle, core profile draws need one
+	VertexArray m_EmptyVAO;
+
+	std::vector<uint8_t> m_Counts;
+	std::array<uint32_t, HistogramSize> m_Histogram{};
+	float m_Average = 0.0f;
+	int m_MaxCount = 0;
+};
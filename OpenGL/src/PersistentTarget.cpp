@@ -0,0 +1,39 @@
+#include "PersistentTarget.h"
+
+#include "Renderer.h"
+#include "Profiler.h"
+
+PersistentTarget::PersistentTarget()
+    : m_Valid(false), m_PreviousFramebuffer(0)
+{
+    FramebufferSpec spec;
+    spec.Color = AttachmentType::Renderbuffer;
+    m_Framebuffer = Framebuffer(spec);
+}
+
+PersistentTarget::~PersistentTarget()
+{
+}
+
+bool PersistentTarget::Begin()
+{
+    GLint viewport[4];
+    GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+    if (m_Framebuffer.Resize(viewport[2], viewport[3]))
+        m_Valid = false;
+
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &m_PreviousFramebuffer));
+    m_Framebuffer.Bind();
+
+    bool valid = m_Valid;
+    m_Valid = true;
+    return valid;
+}
+
+void PersistentTarget::End()
+{
+    PROFILE_SCOPE("PersistentTarget blit");
+
+    m_Framebuffer.BlitTo(m_PreviousFramebuffer);
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, m_PreviousFramebuffer));
+}
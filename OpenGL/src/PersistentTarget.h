@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Framebuffer.h"
+
+// offscreen color + depth buffer that keeps its contents between frames, unlike the back
+// buffer after a swap, so a frame only has to redraw what changed before it's blitted out
+class PersistentTarget
+{
+public:
+	PersistentTarget();
+	~PersistentTarget();
+
+	PersistentTarget(const PersistentTarget&) = delete;
+	PersistentTarget& operator=(const PersistentTarget&) = delete;
+
+	// binds the buffer sized to the current viewport, false when the old contents are
+	// gone (first use or resize) and everything has to be drawn again
+	bool Begin();
+	// copies the whole buffer into the framebuffer bound at Begin
+	void End();
+
+	// the next Begin reports the contents as lost
+	inline void Invalidate() { m_Valid = false; }
+
+private:
+	// renderbuffers, only ever drawn to and blitted
+	Framebuffer m_Framebuffer;
+	bool m_Valid;
+
+	int m_PreviousFramebuffer;
+};
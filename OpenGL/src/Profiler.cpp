@@ -0,0 +1,302 @@
+#include "Profiler.h"
+
+#include "FrameArena.h"
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <thread>
+
+static const auto s_Epoch = std::chrono::steady_clock::now();
+static thread_local uint32_t s_Depth = 0;
+
+// GPU events are put on their own track in the trace
+static const uint32_t GpuThread = 0;
+
+static uint32_t CurrentThread()
+{
+    uint32_t id = (uint32_t)std::hash<std::thread::id>{}(std::this_thread::get_id());
+    return id == GpuThread ? 1 : id;
+}
+
+static ImU32 ColorFromName(const char* name)
+{
+    uint32_t hash = 2166136261u;
+    for (const char* c = name; *c; c++)
+        hash = (hash ^ (uint8_t)*c) * 16777619u;
+    return IM_COL32(80 + (hash & 0x7f), 80 + ((hash >> 8) & 0x7f), 80 + ((hash >> 16) & 0x7f), 255);
+}
+
+Profiler& Profiler::Get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler()
+{
+    m_CurrentEvents.reserve(1024);
+    m_LastEvents.reserve(1024);
+}
+
+Profiler::~Profiler()
+{
+    // the GL context is gone by the time statics are destroyed, queries die with it
+}
+
+double Profiler::Now() const
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - s_Epoch).count();
+}
+
+void Profiler::BeginFrame()
+{
+    m_FrameStart = Now();
+    m_FrameAllocationStart = AllocationTracker::GetCounters();
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_CurrentEvents.clear();
+        m_CollectEvents = true;
+    }
+
+    // this slot was last used FrameLatency frames ago
+    GpuFrame& frame = m_GpuFrames[m_GpuFrameIndex];
+    if (frame.Pending)
+        ResolveGpuFrame(frame);
+
+    frame.QueriesUsed = 0;
+    frame.Scopes.clear();
+    frame.CpuStart = m_FrameStart;
+    GLCall(glGetInteger64v(GL_TIMESTAMP, &frame.GpuStart));
+
+    if (!frame.FrameQuery)
+    {
+        GLCall(glGenQueries(1, &frame.FrameQuery));
+    }
+    GLCall(glBeginQuery(GL_TIME_ELAPSED, frame.FrameQuery));
+
+    m_GpuDepth = 0;
+    m_FrameActive = true;
+}
+
+void Profiler::EndFrame()
+{
+    GpuFrame& frame = m_GpuFrames[m_GpuFrameIndex];
+    GLCall(glEndQuery(GL_TIME_ELAPSED));
+    frame.Pending = true;
+    m_FrameActive = false;
+
+    m_FrameTimes[m_HistoryIndex] = (float)((Now() - m_FrameStart) / 1000.0);
+    m_FrameAllocations = AllocationTracker::GetCounters() - m_FrameAllocationStart;
+
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_LastEvents.swap(m_CurrentEvents);
+        m_CollectEvents = false;
+    }
+
+    if (m_CaptureFramesLeft > 0)
+    {
+        m_CaptureEvents.insert(m_CaptureEvents.end(), m_LastEvents.begin(), m_LastEvents.end());
+        // keep going until the GPU results of the last captured frame came back
+        if (--m_CaptureFramesLeft == 0)
+            m_CaptureFlushFrames = FrameLatency + 1;
+    }
+    else if (m_CaptureFlushFrames > 0)
+    {
+        if (--m_CaptureFlushFrames == 0)
+            WriteCapture();
+    }
+
+    m_GpuFrameIndex = (m_GpuFrameIndex + 1) % (FrameLatency + 1);
+    m_HistoryIndex = (m_HistoryIndex + 1) % HistoryLength;
+}
+
+void Profiler::AddEvent(const Event& event)
+{
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    if (m_CollectEvents)
+        m_CurrentEvents.push_back(event);
+}
+
+int Profiler::BeginGpuScope(const char* name)
+{
+    if (!m_FrameActive)
+        return -1;
+
+    GpuFrame& frame = m_GpuFrames[m_GpuFrameIndex];
+    // two timestamps per scope, grow the pool in blocks
+    if (frame.QueriesUsed + 2 > frame.Queries.size())
+    {
+        size_t oldSize = frame.Queries.size();
+        frame.Queries.resize(oldSize + 32);
+        GLCall(glGenQueries(32, &frame.Queries[oldSize]));
+    }
+
+    int begin = (int)frame.QueriesUsed++;
+    GLCall(glQueryCounter(frame.Queries[begin], GL_TIMESTAMP));
+    frame.Scopes.push_back({ name, m_GpuDepth++, begin, -1 });
+    return (int)frame.Scopes.size() - 1;
+}
+
+void Profiler::EndGpuScope(int scope)
+{
+    if (scope < 0 || !m_FrameActive)
+        return;
+
+    GpuFrame& frame = m_GpuFrames[m_GpuFrameIndex];
+    int end = (int)frame.QueriesUsed++;
+    GLCall(glQueryCounter(frame.Queries[end], GL_TIMESTAMP));
+    frame.Scopes[scope].EndQuery = end;
+    m_GpuDepth--;
+}
+
+void Profiler::ResolveGpuFrame(GpuFrame& frame)
+{
+    frame.Pending = false;
+
+    // queries finish in order, so if the last one is done all of them are
+    GLint available = 0;
+    unsigned int last = frame.QueriesUsed > 0 ? frame.Queries[frame.QueriesUsed - 1] : frame.FrameQuery;
+    GLCall(glGetQueryObjectiv(last, GL_QUERY_RESULT_AVAILABLE, &available));
+    if (available)
+    {
+        GLCall(glGetQueryObjectiv(frame.FrameQuery, GL_QUERY_RESULT_AVAILABLE, &available));
+    }
+    if (!available)
+    {
+        m_DroppedGpuFrames++;
+        return;
+    }
+
+    GLuint64 elapsed = 0;
+    GLCall(glGetQueryObjectui64v(frame.FrameQuery, GL_QUERY_RESULT, &elapsed));
+    m_GpuFrameTimes[m_HistoryIndex] = (float)(elapsed / 1e6);
+
+    m_LastGpuEvents.clear();
+    for (const GpuScope& scope : frame.Scopes)
+    {
+        if (scope.EndQuery < 0)
+            continue;
+
+        GLuint64 begin = 0, end = 0;
+        GLCall(glGetQueryObjectui64v(frame.Queries[scope.BeginQuery], GL_QUERY_RESULT, &begin));
+        GLCall(glGetQueryObjectui64v(frame.Queries[scope.EndQuery], GL_QUERY_RESULT, &end));
+
+        // place on the CPU timeline relative to the timestamp taken at frame start
+        double start = frame.CpuStart + ((int64_t)begin - frame.GpuStart) / 1000.0;
+        m_LastGpuEvents.push_back({ scope.Name, start, (end - begin) / 1000.0, GpuThread, scope.Depth });
+    }
+
+    if (IsCapturing())
+        m_CaptureEvents.insert(m_CaptureEvents.end(), m_LastGpuEvents.begin(), m_LastGpuEvents.end());
+}
+
+void Profiler::StartCapture(const std::string& path, int frames)
+{
+    m_CapturePath = path;
+    m_CaptureFramesLeft = frames;
+    m_CaptureFlushFrames = 0;
+    m_CaptureEvents.clear();
+}
+
+void Profiler::WriteCapture()
+{
+    std::ofstream stream(m_CapturePath);
+    stream << "{\"traceEvents\":[\n";
+    stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << GpuThread << ",\"args\":{\"name\":\"GPU\"}}";
+    for (const Event& event : m_CaptureEvents)
+    {
+        stream << ",\n{\"name\":\"" << event.Name << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << event.Thread
+            << ",\"ts\":" << event.Start << ",\"dur\":" << event.Duration << "}";
+    }
+    stream << "\n]}\n";
+
+    std::cout << "Wrote " << m_CaptureEvents.size() << " events to " << m_CapturePath << std::endl;
+    m_CaptureEvents.clear();
+}
+
+static void DrawTimeline(const char* label, const std::vector<Profiler::Event>& events)
+{
+    if (events.empty())
+        return;
+
+    double start = DBL_MAX, end = 0.0;
+    uint32_t rows = 1;
+    for (const Profiler::Event& event : events)
+    {
+        start = std::min(start, event.Start);
+        end = std::max(end, event.Start + event.Duration);
+        rows = std::max(rows, event.Depth + 1);
+    }
+
+    ImGui::Text("%s (%.3f ms)", label, (end - start) / 1000.0);
+
+    const float rowHeight = 18.0f;
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    ImVec2 origin = ImGui::GetCursorScreenPos();
+    float width = ImGui::GetContentRegionAvail().x;
+    double scale = width / std::max(end - start, 1.0);
+
+    for (const Profiler::Event& event : events)
+    {
+        ImVec2 min = { origin.x + (float)((event.Start - start) * scale), origin.y + event.Depth * rowHeight };
+        ImVec2 max = { min.x + std::max((float)(event.Duration * scale), 1.0f), min.y + rowHeight - 1.0f };
+        drawList->AddRectFilled(min, max, ColorFromName(event.Name));
+        if (max.x - min.x > 40.0f)
+        {
+            drawList->PushClipRect(min, max, true);
+            drawList->AddText({ min.x + 2.0f, min.y + 1.0f }, IM_COL32_WHITE, event.Name);
+            drawList->PopClipRect();
+        }
+        if (ImGui::IsMouseHoveringRect(min, max))
+            ImGui::SetTooltip("%s\n%.3f ms", event.Name, event.Duration / 1000.0);
+    }
+
+    ImGui::Dummy({ width, rows * rowHeight });
+}
+
+void Profiler::OnImGuiRender()
+{
+    ImGui::Begin("Profiler");
+
+    int last = (m_HistoryIndex + HistoryLength - 1) % HistoryLength;
+    ImGui::Text("CPU %.3f ms, GPU %.3f ms, %u GPU frames dropped",
+        m_FrameTimes[last], m_GpuFrameTimes[last], m_DroppedGpuFrames);
+    if (AllocationTracker::IsEnabled())
+    {
+        const FrameArena& arena = FrameArena::Get();
+        ImGui::Text("Heap: %llu allocations, %.1f KB, frame arena %.1f / %.1f KB",
+            (unsigned long long)m_FrameAllocations.Allocations, m_FrameAllocations.Bytes / 1024.0,
+            arena.GetPeak() / 1024.0, arena.GetCapacity() / 1024.0);
+    }
+    ImGui::PlotHistogram("CPU ms", m_FrameTimes, HistoryLength, m_HistoryIndex, nullptr, 0.0f, FLT_MAX, { 0.0f, 60.0f });
+    ImGui::PlotHistogram("GPU ms", m_GpuFrameTimes, HistoryLength, m_HistoryIndex, nullptr, 0.0f, FLT_MAX, { 0.0f, 60.0f });
+
+    DrawTimeline("CPU", m_LastEvents);
+    DrawTimeline("GPU", m_LastGpuEvents);
+
+    if (IsCapturing())
+        ImGui::Text("Capturing...");
+    else if (ImGui::Button("Capture trace (60 frames)"))
+        StartCapture("profile.json", 60);
+
+    ImGui::End();
+}
+
+ProfileScope::ProfileScope(const char* name)
+    : m_Name(name), m_Start(Profiler::Get().Now()), m_Depth(s_Depth++)
+{
+}
+
+ProfileScope::~ProfileScope()
+{
+    s_Depth--;
+    Profiler& profiler = Profiler::Get();
+    profiler.AddEvent({ m_Name, m_Start, profiler.Now() - m_Start, CurrentThread(), m_Depth });
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "AllocationTracker.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// set to 0 to compile every scope out
+#ifndef PROFILING
+#define PROFILING 1
+#endif
+
+// per quad scopes, too fine grained to leave on while benchmarking
+#ifndef PROFILING_VERBOSE
+#define PROFILING_VERBOSE 0
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PROFILING
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_GPU_SCOPE(name) GpuProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_GPU_SCOPE(name)
+#endif
+
+#if PROFILING && PROFILING_VERBOSE
+#define PROFILE_SCOPE_VERBOSE(name) PROFILE_SCOPE(name)
+#else
+#define PROFILE_SCOPE_VERBOSE(name)
+#endif
+
+class Profiler
+{
+public:
+	// GPU queries are read this many frames after they were issued so they never stall
+	static const int FrameLatency = 3;
+	static const int HistoryLength = 240;
+
+	struct Event
+	{
+		const char* Name;
+		double Start;    // microseconds since the profiler was created
+		double Duration; // microseconds
+		uint32_t Thread;
+		uint32_t Depth;
+	};
+
+	static Profiler& Get();
+
+	void BeginFrame();
+	void EndFrame();
+
+	void AddEvent(const Event& event);
+	double Now() const;
+
+	// returns the scope index to pass to EndGpuScope, -1 outside of a frame
+	int BeginGpuScope(const char* name);
+	void EndGpuScope(int scope);
+
+	// writes the next frames to a chrome://tracing json file
+	void StartCapture(const std::string& path, int frames);
+	inline bool IsCapturing() const { return m_CaptureFramesLeft > 0 || m_CaptureFlushFrames > 0; }
+
+	void OnImGuiRender();
+
+private:
+	Profiler();
+	~Profiler();
+
+	struct GpuScope
+	{
+		const char* Name;
+		uint32_t Depth;
+		int BeginQuery, EndQuery;
+	};
+
+	// queries issued during one frame, resolved FrameLatency frames later
+	struct GpuFrame
+	{
+		std::vector<unsigned int> Queries;
+		std::vector<GpuScope> Scopes;
+		unsigned int FrameQuery = 0;
+		size_t QueriesUsed = 0;
+		double CpuStart = 0.0;
+		int64_t GpuStart = 0;
+		bool Pending = false;
+	};
+
+	void ResolveGpuFrame(GpuFrame& frame);
+	void WriteCapture();
+
+	std::mutex m_Mutex;
+	// events outside of BeginFrame and EndFrame are dropped, the benchmark never starts
+	// profiler frames and would otherwise grow m_CurrentEvents forever; guarded by m_Mutex
+	bool m_CollectEvents = false;
+	std::vector<Event> m_CurrentEvents;
+	std::vector<Event> m_LastEvents;
+	std::vector<Event> m_LastGpuEvents;
+
+	GpuFrame m_GpuFrames[FrameLatency + 1];
+	int m_GpuFrameIndex = 0;
+	uint32_t m_GpuDepth = 0;
+	bool m_FrameActive = false;
+
+	double m_FrameStart = 0.0;
+	float m_FrameTimes[HistoryLength] = {};
+	float m_GpuFrameTimes[HistoryLength] = {};
+	int m_HistoryIndex = 0;
+	// frames that could not be read back without waiting
+	uint32_t m_DroppedGpuFrames = 0;
+	// heap activity between BeginFrame and EndFrame
+	AllocationCounters m_FrameAllocationStart, m_FrameAllocations;
+
+	std::string m_CapturePath;
+	int m_CaptureFramesLeft = 0;
+	int m_CaptureFlushFrames = 0;
+	std::vector<Event> m_CaptureEvents;
+};
+
+class ProfileScope
+{
+public:
+	ProfileScope(const char* name);
+	~ProfileScope();
+private:
+	const char* m_Name;
+	double m_Start;
+	uint32_t m_Depth;
+};
+
+class GpuProfileScope
+{
+public:
+	GpuProfileScope(const char* name) : m_Scope(Profiler::Get().BeginGpuScope(name)) {}
+	~GpuProfileScope() { Profiler::Get().EndGpuScope(m_Scope); }
+private:
+	int m_Scope;
+};
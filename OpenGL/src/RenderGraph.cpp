@@ -0,0 +1,800 @@
+#include "RenderGraph.h"
+
+#include "CommandCapture.h"
+#include "GpuMemoryTracker.h"
+#include "Profiler.h"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+static const uint32_t NoPass = UINT32_MAX;
+
+// attachment point of a depth and/or stencil format, 0 for color formats
+static GLenum GetDepthAttachment(GLenum format)
+{
+    switch (format)
+    {
+    case GL_DEPTH_COMPONENT16: case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32: case GL_DEPTH_COMPONENT32F:
+        return GL_DEPTH_ATTACHMENT;
+    case GL_DEPTH24_STENCIL8: case GL_DEPTH32F_STENCIL8:
+        return GL_DEPTH_STENCIL_ATTACHMENT;
+    case GL_STENCIL_INDEX8:
+        return GL_STENCIL_ATTACHMENT;
+    }
+    return 0;
+}
+
+// what a pass touching an object needs to see the image or storage writes before it; GL
+// already orders framebuffer writes before later texture fetches, those need nothing
+static GLbitfield GetBarrierBits(bool buffer, RenderGraphAccess access)
+{
+    if (buffer)
+    {
+        if (access == RenderGraphAccess::Storage)
+            return GL_SHADER_STORAGE_BARRIER_BIT;
+        return GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT | GL_UNIFORM_BARRIER_BIT
+            | GL_COMMAND_BARRIER_BIT;
+    }
+
+    switch (access)
+    {
+    case RenderGraphAccess::Read:         return GL_TEXTURE_FETCH_BARRIER_BIT;
+    case RenderGraphAccess::RenderTarget: return GL_FRAMEBUFFER_BARRIER_BIT;
+    case RenderGraphAccess::Storage:      return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+    }
+    return 0;
+}
+
+RenderGraph::RenderGraph()
+    : m_Width(0), m_Height(0)
+{
+}
+
+RenderGraph::~RenderGraph()
+{
+    for (Physical& physical : m_Physical)
+        DestroyPhysical(physical);
+    for (CachedFramebuffer& framebuffer : m_Framebuffers)
+    {
+        GPU_UNTRACK(GpuResourceType::Framebuffer, framebuffer.ID);
+        GLCall(glDeleteFramebuffers(1, &framebuffer.ID));
+    }
+}
+
+void RenderGraph::Begin(int width, int height)
+{
+    // clear keeps the capacity, a graph of the same shape as last frame doesn't allocate
+    m_Width = std::max(width, 1);
+    m_Height = std::max(height, 1);
+    m_Passes.clear();
+    m_Resources.clear();
+    m_Accesses.clear();
+}
+
+RenderGraphResource RenderGraph::AddResource(const char* name, ResourceKind kind, bool imported)
+{
+    Resource resource;
+    resource.Name = name;
+    resource.Kind = kind;
+    resource.Imported = imported;
+    resource.Width = resource.Height = 0;
+    resource.Size = 0;
+    resource.ID = 0;
+    resource.Physical = -1;
+    resource.First = resource.Last = -1;
+    m_Resources.push_back(resource);
+    return { (uint32_t)m_Resources.size() - 1 };
+}
+
+RenderGraphResource RenderGraph::CreateTexture(const char* name, const RenderGraphTextureDesc& desc)
+{
+    RenderGraphResource handle = AddResource(name, ResourceKind::Texture, false);
+    Resource& resource = m_Resources[handle.Index];
+    resource.Desc = desc;
+    resource.Width = desc.Width > 0 ? desc.Width : std::max((int)(m_Width * desc.Scale), 1);
+    resource.Height = desc.Height > 0 ? desc.Height : std::max((int)(m_Height * desc.Scale), 1);
+    resource.Size = (size_t)resource.Width * resource.Height * GetGpuFormatSize(desc.Format);
+    return handle;
+}
+
+RenderGraphResource RenderGraph::CreateBuffer(const char* name, size_t size)
+{
+    RenderGraphResource handle = AddResource(name, ResourceKind::Buffer, false);
+    m_Resources[handle.Index].Size = std::max(size, (size_t)1);
+    return handle;
+}
+
+RenderGraphResource RenderGraph::ImportTexture(const char* name, unsigned int texture, int width, int height)
+{
+    RenderGraphResource handle = AddResource(name, ResourceKind::Texture, true);
+    Resource& resource = m_Resources[handle.Index];
+    resource.ID = texture;
+    resource.Width = width;
+    resource.Height = height;
+    return handle;
+}
+
+RenderGraphResource RenderGraph::ImportFramebuffer(const char* name, unsigned int framebuffer, int width, int height,
+    const glm::vec4& clearColor)
+{
+    RenderGraphResource handle = AddResource(name, ResourceKind::Framebuffer, true);
+    Resource& resource = m_Resources[handle.Index];
+    resource.ID = framebuffer;
+    resource.Width = width;
+    resource.Height = height;
+    resource.Desc.ClearColor = clearColor;
+    return handle;
+}
+
+RenderGraphResource RenderGraph::ImportBuffer(const char* name, unsigned int buffer, size_t size)
+{
+    RenderGraphResource handle = AddResource(name, ResourceKind::Buffer, true);
+    m_Resources[handle.Index].ID = buffer;
+    m_Resources[handle.Index].Size = size;
+    return handle;
+}
+
+uint32_t RenderGraph::CreatePass(const char* name, ExecuteFunc execute)
+{
+    Pass pass;
+    pass.Name = name;
+    pass.Execute = std::move(execute);
+    pass.FirstAccess = (uint32_t)m_Accesses.size();
+    pass.AccessCount = 0;
+    pass.SideEffect = false;
+    pass.Live = false;
+    pass.Barriers = 0;
+    m_Passes.push_back(std::move(pass));
+    return (uint32_t)m_Passes.size() - 1;
+}
+
+void RenderGraph::AddAccess(uint32_t pass, RenderGraphResource resource, RenderGraphAccess type, bool write, RenderGraphLoad load)
+{
+    // the accesses of a pass are one range, so only the pass being set up can add any
+    if (pass + 1 != m_Passes.size() || resource.Index >= m_Resources.size())
+    {
+        std::cout << "RenderGraph: invalid resource or pass in " << m_Passes[pass].Name << std::endl;
+        return;
+    }
+
+    const Resource& target = m_Resources[resource.Index];
+    bool valid = true;
+    if (target.Kind == ResourceKind::Buffer)
+        valid = type != RenderGraphAccess::RenderTarget;
+    else if (target.Kind == ResourceKind::Framebuffer)
+        valid = type == RenderGraphAccess::RenderTarget && write;
+    if (!valid)
+    {
+        std::cout << "RenderGraph: " << m_Passes[pass].Name << " can't use " << target.Name << " that way" << std::endl;
+        return;
+    }
+
+    m_Accesses.push_back({ resource.Index, type, write, load });
+    m_Passes[pass].AccessCount++;
+}
+
+RenderGraphResource RenderGraph::PassBuilder::Read(RenderGraphResource resource, RenderGraphAccess access)
+{
+    m_Graph.AddAccess(m_Pass, resource, access, false, RenderGraphLoad::Preserve);
+    return resource;
+}
+
+RenderGraphResource RenderGraph::PassBuilder::Write(RenderGraphResource resource, RenderGraphAccess access, RenderGraphLoad load)
+{
+    m_Graph.AddAccess(m_Pass, resource, access, true, load);
+    return resource;
+}
+
+RenderGraphResource RenderGraph::PassBuilder::CreateTexture(const char* name, const RenderGraphTextureDesc& desc, RenderGraphLoad load)
+{
+    return Write(m_Graph.CreateTexture(name, desc), RenderGraphAccess::RenderTarget, load);
+}
+
+RenderGraphResource RenderGraph::PassBuilder::CreateBuffer(const char* name, size_t size, RenderGraphLoad load)
+{
+    return Write(m_Graph.CreateBuffer(name, size), RenderGraphAccess::Storage, load);
+}
+
+void RenderGraph::PassBuilder::SetSideEffect()
+{
+    m_Graph.m_Passes[m_Pass].SideEffect = true;
+}
+
+bool RenderGraph::Sort()
+{
+    uint32_t passCount = (uint32_t)m_Passes.size();
+
+    // every access sees a resource as the passes added before it left it: a read or write
+    // depends on the last writer so far, and a write also on the passes that read the
+    // contents it replaces, so it can't run before them. A write that preserves still comes
+    // after the reads of the version before it, so readers never see a later version
+    m_Edges.clear();
+    m_LastWriter.assign(m_Resources.size(), -1);
+    for (uint32_t p = 0; p < passCount; p++)
+    {
+        const Pass& pass = m_Passes[p];
+        uint32_t end = pass.FirstAccess + pass.AccessCount;
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+        {
+            const Access& access = m_Accesses[a];
+            int writer = m_LastWriter[access.Resource];
+            if (writer >= 0)
+            {
+                m_Edges.push_back((uint32_t)writer);
+                m_Edges.push_back(p);
+            }
+            if (!access.Write)
+                continue;
+
+            // the passes since that writer using the resource only read it
+            for (uint32_t q = (uint32_t)(writer + 1); q < p; q++)
+            {
+                const Pass& reader = m_Passes[q];
+                for (uint32_t b = reader.FirstAccess; b < reader.FirstAccess + reader.AccessCount; b++)
+                {
+                    if (m_Accesses[b].Resource != access.Resource)
+                        continue;
+                    m_Edges.push_back(q);
+                    m_Edges.push_back(p);
+                    break;
+                }
+            }
+        }
+        // only after all of them, a pass reading what it writes depends on the writer before it
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+        {
+            if (m_Accesses[a].Write)
+                m_LastWriter[m_Accesses[a].Resource] = (int)p;
+        }
+    }
+
+    // Kahn's algorithm, taking the earliest added of the ready passes. The edges only point
+    // to passes added later, so that is the order they were added in and a cycle means the
+    // edges above are wrong; graphs are a few dozen passes, quadratic is fine
+    m_Dependencies.assign(passCount, 0);
+    for (size_t e = 0; e < m_Edges.size(); e += 2)
+        m_Dependencies[m_Edges[e + 1]]++;
+
+    m_Order.clear();
+    while (m_Order.size() < passCount)
+    {
+        uint32_t next = NoPass;
+        for (uint32_t p = 0; p < passCount && next == NoPass; p++)
+        {
+            if (m_Dependencies[p] == 0)
+                next = p;
+        }
+        if (next == NoPass)
+            return false;
+
+        m_Order.push_back(next);
+        // done, never ready again
+        m_Dependencies[next] = -1;
+        for (size_t e = 0; e < m_Edges.size(); e += 2)
+        {
+            if (m_Edges[e] == next)
+                m_Dependencies[m_Edges[e + 1]]--;
+        }
+    }
+    return true;
+}
+
+void RenderGraph::Cull()
+{
+    // backwards from the outputs: a pass is needed if it has side effects or writes
+    // something a later needed pass reads, or that is imported
+    m_Needed.assign(m_Resources.size(), 0);
+    for (size_t r = 0; r < m_Resources.size(); r++)
+        m_Needed[r] = m_Resources[r].Imported;
+
+    for (size_t i = m_Order.size(); i-- > 0;)
+    {
+        Pass& pass = m_Passes[m_Order[i]];
+        uint32_t end = pass.FirstAccess + pass.AccessCount;
+
+        pass.Live = pass.SideEffect;
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+            pass.Live |= m_Accesses[a].Write && m_Needed[m_Accesses[a].Resource];
+        if (!pass.Live)
+        {
+            m_Stats.CulledPasses++;
+            continue;
+        }
+
+        // a write that doesn't keep the old contents makes the writers before it useless
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+        {
+            if (m_Accesses[a].Write && m_Accesses[a].Load != RenderGraphLoad::Preserve)
+                m_Needed[m_Accesses[a].Resource] = 0;
+        }
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+        {
+            if (!m_Accesses[a].Write || m_Accesses[a].Load == RenderGraphLoad::Preserve)
+                m_Needed[m_Accesses[a].Resource] = 1;
+        }
+    }
+}
+
+int RenderGraph::AcquirePhysical(const Resource& resource)
+{
+    // textures have to match exactly, buffers take the smallest free one big enough
+    int best = -1;
+    for (int i = 0; i < (int)m_Physical.size(); i++)
+    {
+        const Physical& physical = m_Physical[i];
+        if (physical.Busy || physical.Kind != resource.Kind)
+            continue;
+        if (resource.Kind == ResourceKind::Texture)
+        {
+            if (physical.Width == resource.Width && physical.Height == resource.Height && physical.Format == resource.Desc.Format)
+            {
+                best = i;
+                break;
+            }
+        }
+        else if (physical.Size >= resource.Size && (best < 0 || physical.Size < m_Physical[best].Size))
+            best = i;
+    }
+
+    if (best < 0)
+    {
+        Physical physical;
+        physical.Kind = resource.Kind;
+        physical.Width = resource.Width;
+        physical.Height = resource.Height;
+        physical.Format = resource.Desc.Format;
+        physical.Size = resource.Size;
+        std::string name = std::string("RenderGraph ") + resource.Name;
+        if (resource.Kind == ResourceKind::Texture)
+        {
+            GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &physical.ID));
+            GLCall(glTextureStorage2D(physical.ID, 1, physical.Format, physical.Width, physical.Height));
+            GPU_TRACK(GpuResourceType::Texture, physical.ID, physical.Size, name);
+            GLCall(glTextureParameteri(physical.ID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+            GLCall(glTextureParameteri(physical.ID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+        }
+        else
+        {
+            GLCall(glCreateBuffers(1, &physical.ID));
+            GLCall(glNamedBufferStorage(physical.ID, physical.Size, nullptr, GL_DYNAMIC_STORAGE_BIT));
+            GPU_TRACK(GpuResourceType::Buffer, physical.ID, physical.Size, name);
+        }
+        m_Physical.push_back(physical);
+        best = (int)m_Physical.size() - 1;
+    }
+
+    Physical& physical = m_Physical[best];
+    physical.Busy = true;
+    physical.Used = true;
+    // sampler state isn't part of the match, the next user may filter differently
+    if (physical.Kind == ResourceKind::Texture)
+    {
+        GLCall(glTextureParameteri(physical.ID, GL_TEXTURE_MIN_FILTER, resource.Desc.Filter));
+        GLCall(glTextureParameteri(physical.ID, GL_TEXTURE_MAG_FILTER, resource.Desc.Filter));
+    }
+    return best;
+}
+
+void RenderGraph::DestroyPhysical(Physical& physical)
+{
+    if (physical.Kind == ResourceKind::Texture)
+    {
+        // framebuffers referencing it would be incomplete from now on
+        for (size_t i = 0; i < m_Framebuffers.size();)
+        {
+            CachedFramebuffer& framebuffer = m_Framebuffers[i];
+            if (std::find(std::begin(framebuffer.Attachments), std::end(framebuffer.Attachments), physical.ID)
+                == std::end(framebuffer.Attachments))
+            {
+                i++;
+                continue;
+            }
+            GPU_UNTRACK(GpuResourceType::Framebuffer, framebuffer.ID);
+            GLCall(glDeleteFramebuffers(1, &framebuffer.ID));
+            m_Framebuffers[i] = m_Framebuffers.back();
+            m_Framebuffers.pop_back();
+        }
+        GPU_UNTRACK(GpuResourceType::Texture, physical.ID);
+        GLCall(glDeleteTextures(1, &physical.ID));
+    }
+    else
+    {
+        GPU_UNTRACK(GpuResourceType::Buffer, physical.ID);
+        GLCall(glDeleteBuffers(1, &physical.ID));
+    }
+    physical.ID = 0;
+}
+
+void RenderGraph::Allocate()
+{
+    for (Resource& resource : m_Resources)
+    {
+        resource.First = resource.Last = -1;
+        resource.Physical = -1;
+        if (!resource.Imported)
+            resource.ID = 0;
+    }
+    for (int position = 0; position < (int)m_Order.size(); position++)
+    {
+        const Pass& pass = m_Passes[m_Order[position]];
+        if (!pass.Live)
+            continue;
+        for (uint32_t a = pass.FirstAccess; a < pass.FirstAccess + pass.AccessCount; a++)
+        {
+            Resource& resource = m_Resources[m_Accesses[a].Resource];
+            if (resource.First < 0)
+                resource.First = position;
+            resource.Last = position;
+        }
+    }
+
+    for (Physical& physical : m_Physical)
+        physical.Busy = physical.Used = false;
+
+    // a transient takes a free object when its first pass runs and gives it back after its
+    // last one, so everything that never lives at the same time shares
+    for (int position = 0; position < (int)m_Order.size(); position++)
+    {
+        const Pass& pass = m_Passes[m_Order[position]];
+        if (!pass.Live)
+            continue;
+        uint32_t end = pass.FirstAccess + pass.AccessCount;
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+        {
+            Resource& resource = m_Resources[m_Accesses[a].Resource];
+            if (resource.Imported || resource.Physical >= 0)
+                continue;
+            resource.Physical = AcquirePhysical(resource);
+            resource.ID = m_Physical[resource.Physical].ID;
+            m_Stats.Transients++;
+            m_Stats.TransientBytes += resource.Size;
+        }
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+        {
+            const Resource& resource = m_Resources[m_Accesses[a].Resource];
+            if (!resource.Imported && resource.Last == position)
+                m_Physical[resource.Physical].Busy = false;
+        }
+    }
+
+    // whatever this frame didn't need goes, e.g. after a resize
+    for (size_t i = 0; i < m_Physical.size();)
+    {
+        if (m_Physical[i].Used)
+        {
+            m_Stats.PhysicalResources++;
+            m_Stats.PhysicalBytes += m_Physical[i].Size;
+            i++;
+            continue;
+        }
+        DestroyPhysical(m_Physical[i]);
+        m_Physical.erase(m_Physical.begin() + i);
+    }
+}
+
+void RenderGraph::ComputeBarriers()
+{
+    // per resource whether an image or storage write is still unsynchronized, and which
+    // barrier bits went out since
+    m_Dirty.assign(m_Resources.size(), 0);
+    m_Issued.assign(m_Resources.size(), 0);
+    for (uint32_t index : m_Order)
+    {
+        Pass& pass = m_Passes[index];
+        pass.Barriers = 0;
+        if (!pass.Live)
+            continue;
+
+        uint32_t end = pass.FirstAccess + pass.AccessCount;
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+        {
+            const Access& access = m_Accesses[a];
+            if (!m_Dirty[access.Resource])
+                continue;
+            GLbitfield bits = GetBarrierBits(m_Resources[access.Resource].Kind == ResourceKind::Buffer, access.Type);
+            if (bits & ~m_Issued[access.Resource])
+            {
+                pass.Barriers |= bits;
+                m_Issued[access.Resource] |= bits;
+            }
+        }
+        for (uint32_t a = pass.FirstAccess; a < end; a++)
+        {
+            const Access& access = m_Accesses[a];
+            if (access.Write && access.Type == RenderGraphAccess::Storage)
+            {
+                m_Dirty[access.Resource] = 1;
+                m_Issued[access.Resource] = 0;
+            }
+        }
+        if (pass.Barriers)
+            m_Stats.Barriers++;
+    }
+}
+
+unsigned int RenderGraph::GetFramebuffer(const unsigned int (&attachments)[9], GLenum depthAttachment)
+{
+    for (const CachedFramebuffer& framebuffer : m_Framebuffers)
+    {
+        if (memcmp(framebuffer.Attachments, attachments, sizeof(attachments)) == 0)
+            return framebuffer.ID;
+    }
+
+    CachedFramebuffer framebuffer;
+    memcpy(framebuffer.Attachments, attachments, sizeof(attachments));
+    GLCall(glCreateFramebuffers(1, &framebuffer.ID));
+    GPU_TRACK(GpuResourceType::Framebuffer, framebuffer.ID, 0, "RenderGraph");
+
+    GLenum drawBuffers[MaxColorAttachments];
+    int colorCount = 0;
+    for (int i = 0; i < MaxColorAttachments && attachments[i]; i++)
+    {
+        GLCall(glNamedFramebufferTexture(framebuffer.ID, GL_COLOR_ATTACHMENT0 + i, attachments[i], 0));
+        drawBuffers[colorCount++] = GL_COLOR_ATTACHMENT0 + i;
+    }
+    if (attachments[MaxColorAttachments])
+    {
+        GLCall(glNamedFramebufferTexture(framebuffer.ID, depthAttachment, attachments[MaxColorAttachments], 0));
+    }
+    if (colorCount)
+    {
+        GLCall(glNamedFramebufferDrawBuffers(framebuffer.ID, colorCount, drawBuffers));
+    }
+    else
+    {
+        GLCall(glNamedFramebufferDrawBuffer(framebuffer.ID, GL_NONE));
+    }
+
+    GLenum status;
+    GLCall(status = glCheckNamedFramebufferStatus(framebuffer.ID, GL_FRAMEBUFFER));
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "RenderGraph framebuffer incomplete: 0x" << std::hex << status << std::dec << std::endl;
+
+    m_Framebuffers.push_back(framebuffer);
+    return framebuffer.ID;
+}
+
+void RenderGraph::ExecutePass(const Pass& pass)
+{
+    PROFILE_SCOPE(pass.Name);
+    PROFILE_GPU_SCOPE(pass.Name);
+
+    if (pass.Barriers)
+    {
+        GLCall(glMemoryBarrier(pass.Barriers));
+    }
+
+    uint32_t end = pass.FirstAccess + pass.AccessCount;
+
+    // attachments in the order the pass declared them, the imported framebuffer replaces them
+    unsigned int attachments[MaxColorAttachments + 1] = {};
+    GLenum depthAttachment = 0;
+    int colorCount = 0;
+    const Resource* target = nullptr;
+    const Resource* imported = nullptr;
+    for (uint32_t a = pass.FirstAccess; a < end; a++)
+    {
+        const Access& access = m_Accesses[a];
+        const Resource& resource = m_Resources[access.Resource];
+        if (access.Type != RenderGraphAccess::RenderTarget)
+            continue;
+        target = &resource;
+        if (resource.Kind == ResourceKind::Framebuffer)
+            imported = &resource;
+        else if (GLenum depth = resource.Imported ? 0 : GetDepthAttachment(resource.Desc.Format))
+        {
+            attachments[MaxColorAttachments] = resource.ID;
+            depthAttachment = depth;
+        }
+        else if (colorCount < MaxColorAttachments)
+            attachments[colorCount++] = resource.ID;
+    }
+
+    unsigned int framebuffer = 0;
+    if (target)
+    {
+        framebuffer = imported ? imported->ID : GetFramebuffer(attachments, depthAttachment);
+        target = imported ? imported : target;
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, framebuffer));
+        GLCall(glViewport(0, 0, target->Width, target->Height));
+    }
+
+    // loads, a transient's first pass has nothing to keep: the object held another
+    // resource's contents a moment ago, so Preserve clears it like Clear
+    GLenum invalidate[MaxColorAttachments + 1];
+    int invalidateCount = 0;
+    int colorIndex = 0;
+    for (uint32_t a = pass.FirstAccess; a < end; a++)
+    {
+        const Access& access = m_Accesses[a];
+        const Resource& resource = m_Resources[access.Resource];
+        bool color = access.Type == RenderGraphAccess::RenderTarget && resource.Kind == ResourceKind::Texture
+            && (resource.Imported || !GetDepthAttachment(resource.Desc.Format));
+        int drawBuffer = color ? colorIndex++ : 0;
+        if (!access.Write)
+            continue;
+
+        RenderGraphLoad load = access.Load;
+        bool first = !resource.Imported && m_Passes.data() + m_Order[resource.First] == &pass;
+        if (first && load == RenderGraphLoad::Preserve)
+            load = RenderGraphLoad::Clear;
+        if (load == RenderGraphLoad::Preserve)
+            continue;
+
+        const glm::vec4& clearColor = resource.Desc.ClearColor;
+        if (access.Type == RenderGraphAccess::RenderTarget && (!imported || &resource == imported))
+        {
+            GLenum depth = resource.Kind == ResourceKind::Texture && !resource.Imported ? GetDepthAttachment(resource.Desc.Format) : 0;
+            if (load == RenderGraphLoad::Clear)
+            {
+                CommandCapture& capture = CommandCapture::Get();
+                if (resource.Kind == ResourceKind::Framebuffer)
+                {
+                    static const float farDepth = 1.0f;
+                    capture.RecordClearBuffer(framebuffer, GL_COLOR, 0, &clearColor.r);
+                    GLCall(glClearNamedFramebufferfv(framebuffer, GL_COLOR, 0, &clearColor.r));
+                    capture.RecordClearBuffer(framebuffer, GL_DEPTH_STENCIL, 0, &farDepth);
+                    GLCall(glClearNamedFramebufferfi(framebuffer, GL_DEPTH_STENCIL, 0, farDepth, 0));
+                }
+                else if (depth == GL_DEPTH_ATTACHMENT)
+                {
+                    capture.RecordClearBuffer(framebuffer, GL_DEPTH, 0, &clearColor.r);
+                    GLCall(glClearNamedFramebufferfv(framebuffer, GL_DEPTH, 0, &clearColor.r));
+                }
+                else if (depth)
+                {
+                    capture.RecordClearBuffer(framebuffer, GL_DEPTH_STENCIL, 0, &clearColor.r);
+                    GLCall(glClearNamedFramebufferfi(framebuffer, GL_DEPTH_STENCIL, 0, clearColor.r, 0));
+                }
+                else
+                {
+                    capture.RecordClearBuffer(framebuffer, GL_COLOR, drawBuffer, &clearColor.r);
+                    GLCall(glClearNamedFramebufferfv(framebuffer, GL_COLOR, drawBuffer, &clearColor.r));
+                }
+                m_Stats.Clears++;
+            }
+            else if (!resource.Imported)
+                invalidate[invalidateCount++] = depth ? depth : GL_COLOR_ATTACHMENT0 + drawBuffer;
+        }
+        else if (access.Type == RenderGraphAccess::Storage && !resource.Imported)
+        {
+            if (load == RenderGraphLoad::Clear && resource.Kind == ResourceKind::Buffer)
+            {
+                GLCall(glClearNamedBufferData(resource.ID, GL_R8, GL_RED, GL_UNSIGNED_BYTE, nullptr));
+                m_Stats.Clears++;
+            }
+            else if (load == RenderGraphLoad::Clear)
+            {
+                GLenum format = GetDepthAttachment(resource.Desc.Format) ? GL_DEPTH_COMPONENT : GL_RGBA;
+                GLCall(glClearTexImage(resource.ID, 0, format, GL_FLOAT, &clearColor.r));
+                m_Stats.Clears++;
+            }
+            else if (resource.Kind == ResourceKind::Buffer)
+            {
+                GLCall(glInvalidateBufferData(resource.ID));
+            }
+            else
+            {
+                GLCall(glInvalidateTexImage(resource.ID, 0));
+            }
+        }
+    }
+    if (invalidateCount)
+    {
+        GLCall(glInvalidateNamedFramebufferData(framebuffer, invalidateCount, invalidate));
+    }
+
+    if (pass.Execute)
+        pass.Execute(*this);
+}
+
+void RenderGraph::Execute()
+{
+    m_Stats = Stats();
+    m_Stats.Passes = (int)m_Passes.size();
+    if (m_Passes.empty())
+        return;
+
+    if (!Sort())
+    {
+        std::cout << "RenderGraph: dependency cycle, running the passes in the order they were added" << std::endl;
+        m_Order.clear();
+        for (uint32_t p = 0; p < (uint32_t)m_Passes.size(); p++)
+            m_Order.push_back(p);
+    }
+    Cull();
+    Allocate();
+    ComputeBarriers();
+
+    GLint previousFramebuffer, previousViewport[4];
+    GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previousFramebuffer));
+    GLCall(glGetIntegerv(GL_VIEWPORT, previousViewport));
+
+    for (uint32_t index : m_Order)
+    {
+        if (m_Passes[index].Live)
+            ExecutePass(m_Passes[index]);
+    }
+
+    GLCall(glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer));
+    GLCall(glViewport(previousViewport[0], previousViewport[1], previousViewport[2], previousViewport[3]));
+}
+
+unsigned int RenderGraph::GetTexture(RenderGraphResource resource) const
+{
+    return resource.Index < m_Resources.size() ? m_Resources[resource.Index].ID : 0;
+}
+
+unsigned int RenderGraph::GetBuffer(RenderGraphResource resource) const
+{
+    return resource.Index < m_Resources.size() ? m_Resources[resource.Index].ID : 0;
+}
+
+int RenderGraph::GetWidth(RenderGraphResource resource) const
+{
+    return resource.Index < m_Resources.size() ? m_Resources[resource.Index].Width : 0;
+}
+
+int RenderGraph::GetHeight(RenderGraphResource resource) const
+{
+    return resource.Index < m_Resources.size() ? m_Resources[resource.Index].Height : 0;
+}
+
+void RenderGraph::OnImGuiRender()
+{
+    ImGui::Text("%d passes, %d culled, %d barriers, %d clears", m_Stats.Passes, m_Stats.CulledPasses,
+        m_Stats.Barriers, m_Stats.Clears);
+    ImGui::Text("%d transients in %d objects, %.2f MB instead of %.2f MB", m_Stats.Transients,
+        m_Stats.PhysicalResources, m_Stats.PhysicalBytes / (1024.0 * 1024.0), m_Stats.TransientBytes / (1024.0 * 1024.0));
+
+    if (ImGui::BeginTable("Passes", 3))
+    {
+        ImGui::TableSetupColumn("Pass");
+        ImGui::TableSetupColumn("State");
+        ImGui::TableSetupColumn("Barrier");
+        ImGui::TableHeadersRow();
+        for (uint32_t index : m_Order)
+        {
+            const Pass& pass = m_Passes[index];
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s", pass.Name);
+            ImGui::TableNextColumn(); ImGui::Text("%s", pass.Live ? "run" : "culled");
+            ImGui::TableNextColumn();
+            if (pass.Barriers)
+                ImGui::Text("0x%x", pass.Barriers);
+        }
+        ImGui::EndTable();
+    }
+
+    if (ImGui::BeginTable("Resources", 4))
+    {
+        ImGui::TableSetupColumn("Resource");
+        ImGui::TableSetupColumn("Size");
+        ImGui::TableSetupColumn("GL object");
+        ImGui::TableSetupColumn("Passes");
+        ImGui::TableHeadersRow();
+        for (const Resource& resource : m_Resources)
+        {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s%s", resource.Name, resource.Imported ? " (imported)" : "");
+            ImGui::TableNextColumn();
+            if (resource.Kind == ResourceKind::Buffer)
+                ImGui::Text("%zu bytes", resource.Size);
+            else
+                ImGui::Text("%dx%d", resource.Width, resource.Height);
+            ImGui::TableNextColumn();
+            if (resource.ID || resource.Imported)
+                ImGui::Text("%u", resource.ID);
+            else
+                ImGui::Text("-");
+            ImGui::TableNextColumn();
+            if (resource.First >= 0)
+                ImGui::Text("%d - %d", resource.First, resource.Last);
+        }
+        ImGui::EndTable();
+    }
+}
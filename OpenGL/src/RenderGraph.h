@@ -0,0 +1,241 @@
+#pragma once
+
+#include "Renderer.h"
+
+#include "glm/glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+// a texture, buffer or framebuffer declared in a RenderGraph, only valid until the next Begin
+struct RenderGraphResource
+{
+	uint32_t Index = UINT32_MAX;
+
+	inline bool IsValid() const { return Index != UINT32_MAX; }
+};
+
+struct RenderGraphTextureDesc
+{
+	// 0 takes the size given to Begin times Scale, e.g. 0.5 for a half resolution blur
+	int Width = 0, Height = 0;
+	float Scale = 1.0f;
+	GLenum Format = GL_RGBA8;
+	GLenum Filter = GL_LINEAR;
+	// depth formats clear to ClearColor.r
+	glm::vec4 ClearColor = { 0.0f, 0.0f, 0.0f, 0.0f };
+};
+
+enum class RenderGraphAccess
+{
+	// sampled texture, or a buffer read as vertices, indices, uniforms or indirect commands
+	Read,
+	// color or depth attachment
+	RenderTarget,
+	// image or shader storage load/store, the next pass touching it gets a glMemoryBarrier
+	Storage
+};
+
+// what a write does with the previous contents
+enum class RenderGraphLoad
+{
+	Preserve, Clear, DontCare
+};
+
+// the frame as a list of passes declaring what they read and write; Execute culls the passes
+// nothing depends on, orders the rest by their dependencies, puts glMemoryBarrier after image
+// and storage writes only, and lets transient textures and buffers whose lifetimes don't
+// overlap share one GL object. Rebuilt every frame:
+//
+//     graph.Begin(width, height);
+//     RenderGraphResource scene;
+//     graph.AddPass("Scene", [&](RenderGraph::PassBuilder& pass) {
+//         scene = pass.CreateTexture("Scene", desc);
+//     }, [=](const RenderGraph& graph) { ...draw... });
+//     graph.AddPass("Composite", [&](RenderGraph::PassBuilder& pass) {
+//         pass.Read(scene);
+//         pass.Write(backbuffer);
+//     }, [=](const RenderGraph& graph) { ...sample graph.GetTexture(scene)... });
+//     graph.Execute();
+//
+// names aren't copied, they have to outlive the frame, e.g. string literals
+class RenderGraph
+{
+public:
+	using ExecuteFunc = std::function<void(const RenderGraph& graph)>;
+
+	struct Stats
+	{
+		int Passes = 0, CulledPasses = 0;
+		int Barriers = 0, Clears = 0;
+		// transient resources this frame and the GL objects they ended up in
+		int Transients = 0, PhysicalResources = 0;
+		// what the transients would take each in their own object, and what they take aliased
+		size_t TransientBytes = 0, PhysicalBytes = 0;
+	};
+
+	// handed to the setup function of AddPass to declare the pass's reads and writes
+	class PassBuilder
+	{
+	public:
+		// a pass sees a resource as the passes added before it left it, later writes wait
+		// until it's done
+		RenderGraphResource Read(RenderGraphResource resource, RenderGraphAccess access = RenderGraphAccess::Read);
+		RenderGraphResource Write(RenderGraphResource resource, RenderGraphAccess access = RenderGraphAccess::RenderTarget,
+			RenderGraphLoad load = RenderGraphLoad::Preserve);
+
+		// a transient texture written by this pass, cleared unless load says otherwise
+		RenderGraphResource CreateTexture(const char* name, const RenderGraphTextureDesc& desc,
+			RenderGraphLoad load = RenderGraphLoad::Clear);
+		// a transient buffer written by this pass from shaders
+		RenderGraphResource CreateBuffer(const char* name, size_t size, RenderGraphLoad load = RenderGraphLoad::DontCare);
+
+		// never culled, e.g. a readback or a query only the pass itself knows about
+		void SetSideEffect();
+
+	private:
+		friend class RenderGraph;
+		PassBuilder(RenderGraph& graph, uint32_t pass) : m_Graph(graph), m_Pass(pass) {}
+
+		RenderGraph& m_Graph;
+		uint32_t m_Pass;
+	};
+
+	RenderGraph();
+	~RenderGraph();
+
+	RenderGraph(const RenderGraph&) = delete;
+	RenderGraph& operator=(const RenderGraph&) = delete;
+
+	// drops the last frame's passes and resources, the GL objects stay for reuse
+	void Begin(int width, int height);
+
+	// transient resources, written by some pass before anyone reads them
+	RenderGraphResource CreateTexture(const char* name, const RenderGraphTextureDesc& desc);
+	RenderGraphResource CreateBuffer(const char* name, size_t size);
+
+	// resources owned by someone else, a pass writing one of them is never culled;
+	// framebuffer 0 is the default one
+	RenderGraphResource ImportTexture(const char* name, unsigned int texture, int width, int height);
+	RenderGraphResource ImportFramebuffer(const char* name, unsigned int framebuffer, int width, int height,
+		const glm::vec4& clearColor = { 0.0f, 0.0f, 0.0f, 1.0f });
+	RenderGraphResource ImportBuffer(const char* name, unsigned int buffer, size_t size);
+
+	// setup runs right away with a PassBuilder, execute later from Execute if the pass survives
+	template<typename Setup>
+	void AddPass(const char* name, Setup&& setup, ExecuteFunc execute)
+	{
+		PassBuilder builder(*this, CreatePass(name, std::move(execute)));
+		setup(builder);
+	}
+
+	// compiles and runs the passes, the framebuffer and viewport are restored afterwards
+	void Execute();
+
+	// GL names for the execute functions, transients only have one while Execute runs
+	unsigned int GetTexture(RenderGraphResource resource) const;
+	unsigned int GetBuffer(RenderGraphResource resource) const;
+	int GetWidth(RenderGraphResource resource) const;
+	int GetHeight(RenderGraphResource resource) const;
+
+	inline const Stats& GetStats() const { return m_Stats; }
+
+	// passes in execution order and which GL object every transient was given
+	void OnImGuiRender();
+
+private:
+	enum class ResourceKind
+	{
+		Texture, Buffer, Framebuffer
+	};
+
+	struct Resource
+	{
+		const char* Name;
+		ResourceKind Kind;
+		bool Imported;
+		RenderGraphTextureDesc Desc;
+		int Width, Height;
+		size_t Size;
+		// the imported object, or the physical one once allocated
+		unsigned int ID;
+		int Physical;
+		// first and last position in the execution order of a pass using it, -1 if none
+		int First, Last;
+	};
+
+	struct Access
+	{
+		uint32_t Resource;
+		RenderGraphAccess Type;
+		bool Write;
+		RenderGraphLoad Load;
+	};
+
+	struct Pass
+	{
+		const char* Name;
+		ExecuteFunc Execute;
+		// range in m_Accesses
+		uint32_t FirstAccess, AccessCount;
+		bool SideEffect;
+		bool Live;
+		GLbitfield Barriers;
+	};
+
+	// a texture or buffer kept across frames, handed to one transient at a time
+	struct Physical
+	{
+		ResourceKind Kind;
+		unsigned int ID;
+		int Width, Height;
+		GLenum Format;
+		size_t Size;
+		bool Busy;
+		bool Used;
+	};
+
+	struct CachedFramebuffer
+	{
+		// color attachments, then depth, 0 for unused
+		unsigned int Attachments[9];
+		unsigned int ID;
+	};
+
+	static const int MaxColorAttachments = 8;
+
+	uint32_t CreatePass(const char* name, ExecuteFunc execute);
+	RenderGraphResource AddResource(const char* name, ResourceKind kind, bool imported);
+	void AddAccess(uint32_t pass, RenderGraphResource resource, RenderGraphAccess type, bool write, RenderGraphLoad load);
+
+	// fills m_Order, false on a cycle
+	bool Sort();
+	void Cull();
+	void Allocate();
+	void ComputeBarriers();
+	void ExecutePass(const Pass& pass);
+
+	int AcquirePhysical(const Resource& resource);
+	void DestroyPhysical(Physical& physical);
+	unsigned int GetFramebuffer(const unsigned int (&attachments)[9], GLenum depthAttachment);
+
+	int m_Width, m_Height;
+	std::vector<Pass> m_Passes;
+	std::vector<Resource> m_Resources;
+	std::vector<Access> m_Accesses;
+	// pass indices in execution order, culled ones included
+	std::vector<uint32_t> m_Order;
+
+	std::vector<Physical> m_Physical;
+	std::vector<CachedFramebuffer> m_Framebuffers;
+
+	// scratch kept between frames
+	std::vector<uint32_t> m_Edges;
+	std::vector<int> m_Dependencies, m_LastWriter;
+	std::vector<uint8_t> m_Needed, m_Dirty;
+	std::vector<GLbitfield> m_Issued;
+
+	Stats m_Stats;
+};
@@ -1,5 +1,7 @@
 #include "Renderer.h"
 
+#include "CommandCapture.h"
+
 #include <iostream>
 
 void GLClearError()
@@ -20,14 +22,53 @@ bool GLLogCall(const char* function, const char* file, int line)
 
 void Renderer::Clear() const
 {
-    GLCall(glClear(GL_COLOR_BUFFER_BIT));
+    Clear(GL_COLOR_BUFFER_BIT);
+}
+
+void Renderer::Clear(GLbitfield mask)
+{
+    CommandCapture::Get().RecordClear(mask);
+    GLCall(glClear(mask));
 }
 
 void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const
+{
+    Draw(va, ib, ib.GetCount(), shader);
+}
+
+void Renderer::Draw(const VertexArray& va, const IndexBuffer& ib, unsigned int count, const Shader& shader) const
 {
     shader.Bind();
     va.Bind();
     ib.Bind();
 
-    GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+    CommandCapture::Get().RecordDraw(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0);
+    GLCall(glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr));
+
+    GetFrameStats().DrawCalls++;
+    GetFrameStats().Quads += count / 6;
+}
+
+int Renderer::GetMaxTextureUnits()
+{
+    static int units = 0;
+    if (units == 0)
+    {
+        GLCall(glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &units));
+        // the minimum GL 4.5 guarantees
+        if (units < 16)
+            units = 16;
+    }
+    return units;
+}
+
+FrameStats& Renderer::GetFrameStats()
+{
+    static FrameStats stats;
+    return stats;
+}
+
+void Renderer::ResetFrameStats()
+{
+    GetFrameStats() = FrameStats();
 }
@@ -2,11 +2,17 @@
 
 #include<GL/glew.h>
 
+#include <cstdint>
+
 #include "VertexArray.h"
 #include "IndexBuffer.h"
 #include "Shader.h"
 
+#ifdef _MSC_VER
 #define ASSERT(x) if (!(x)) __debugbreak();
+#else
+#define ASSERT(x) if (!(x)) __builtin_trap();
+#endif
 #define GLCall(x) GLClearError();\
     x;\
     ASSERT(GLLogCall(#x, __FILE__, __LINE__))
@@ -14,9 +20,29 @@
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
 
+// counters for the current frame, shared by every renderer and read by the benchmark
+struct FrameStats
+{
+    uint32_t DrawCalls = 0;
+    uint32_t Quads = 0;
+    uint64_t BytesUploaded = 0;
+    // shaded fragments per pixel, only measured while the overdraw view is on
+    float Overdraw = 0.0f;
+};
+
 class Renderer
 {
 public:
     void Clear() const;
+    // glClear that a CommandCapture sees, every clear of the bound framebuffer goes through here
+    static void Clear(GLbitfield mask);
     void Draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
+    // only the first count indices of ib
+    void Draw(const VertexArray& va, const IndexBuffer& ib, unsigned int count, const Shader& shader) const;
+
+    // GL_MAX_TEXTURE_IMAGE_UNITS, queried the first time with a context current
+    static int GetMaxTextureUnits();
+
+    static FrameStats& GetFrameStats();
+    static void ResetFrameStats();
 };
\ No newline at end of file
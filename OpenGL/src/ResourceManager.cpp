@@ -0,0 +1,336 @@
+#include "ResourceManager.h"
+
+#include "BatchRenderer.h"
+#include "Font.h"
+#include "GpuMemoryTracker.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "imgui/imgui.h"
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <iostream>
+
+ResourceManager& ResourceManager::Get()
+{
+    static ResourceManager manager;
+    return manager;
+}
+
+ResourceManager::ResourceManager()
+    : m_CancelLoad(false), m_PendingLoads(0)
+{
+}
+
+ResourceManager::~ResourceManager()
+{
+    // GL objects have to be gone by now (Clear), only the loader and CPU side data are left
+    StopLoader();
+    for (DecodedImage& image : m_DecodedImages)
+        stbi_image_free(image.Pixels);
+}
+
+std::shared_ptr<Shader> ResourceManager::GetShader(const std::string& path, const std::vector<std::string>& defines)
+{
+    // e.g. "res/shaders/BatchRender.shader|MAX_TEXTURES=32|UNTEXTURED"
+    std::string key = path;
+    std::vector<std::string> sorted = defines;
+    std::sort(sorted.begin(), sorted.end());
+    for (const std::string& define : sorted)
+        key += "|" + define;
+
+    auto it = m_Shaders.find(key);
+    if (it != m_Shaders.end())
+        return it->second;
+
+    GpuMemoryTracker::SharedScope shared;
+    std::shared_ptr<Shader> shader;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (size_t i = 0; i < m_ParsedShaders.size(); i++)
+        {
+            if (m_ParsedShaders[i].Path != path)
+                continue;
+            shader = std::make_shared<Shader>(path, m_ParsedShaders[i].Source, sorted);
+            m_ParsedShaders.erase(m_ParsedShaders.begin() + i);
+            break;
+        }
+    }
+    if (!shader)
+        shader = std::make_shared<Shader>(path, sorted);
+
+    m_Shaders[key] = shader;
+    return shader;
+}
+
+std::shared_ptr<Texture> ResourceManager::GetTexture(const std::string& path)
+{
+    auto it = m_Textures.find(path);
+    if (it != m_Textures.end())
+        return it->second;
+
+    GpuMemoryTracker::SharedScope shared;
+    DecodedImage image;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        for (size_t i = 0; i < m_DecodedImages.size(); i++)
+        {
+            if (m_DecodedImages[i].Path != path)
+                continue;
+            image = m_DecodedImages[i];
+            m_DecodedImages.erase(m_DecodedImages.begin() + i);
+            break;
+        }
+    }
+
+    std::shared_ptr<Texture> texture;
+    if (image.Pixels)
+    {
+        texture = std::make_shared<Texture>(path, image.Width, image.Height, image.Pixels);
+        stbi_image_free(image.Pixels);
+    }
+    else
+        texture = std::make_shared<Texture>(path);
+
+    m_Textures[path] = texture;
+    return texture;
+}
+
+std::shared_ptr<Font> ResourceManager::GetFont(const std::string& path, float pixelHeight)
+{
+    // the atlas is baked for one size
+    std::string key = path + "@" + std::to_string((int)pixelHeight);
+    auto it = m_Fonts.find(key);
+    if (it != m_Fonts.end())
+        return it->second;
+
+    GpuMemoryTracker::SharedScope shared;
+    std::shared_ptr<Font> font = std::make_shared<Font>(path, pixelHeight);
+    m_Fonts[key] = font;
+    return font;
+}
+
+std::shared_ptr<Mesh> ResourceManager::GetMesh(const std::string& name, const std::function<void(Mesh&)>& build)
+{
+    auto it = m_Meshes.find(name);
+    if (it != m_Meshes.end())
+        return it->second;
+
+    GpuMemoryTracker::SharedScope shared;
+    std::shared_ptr<Mesh> mesh = std::make_shared<Mesh>();
+    build(*mesh);
+    m_Meshes[name] = mesh;
+    return mesh;
+}
+
+VertexArray& ResourceManager::GetVertexArray(uint64_t hash, const VertexAttribute* attributes, size_t count)
+{
+    auto it = m_VertexArrays.find(hash);
+    if (it != m_VertexArrays.end())
+        return it->second;
+
+    GpuMemoryTracker::SharedScope shared;
+    VertexArray& vertexArray = m_VertexArrays[hash];
+    vertexArray.SetLayout(attributes, count);
+    return vertexArray;
+}
+
+std::shared_ptr<BatchRenderer> ResourceManager::GetBatchRenderer()
+{
+    if (!m_BatchRenderer)
+    {
+        GpuMemoryTracker::SharedScope shared;
+        m_BatchRenderer = std::make_shared<BatchRenderer>();
+    }
+    return m_BatchRenderer;
+}
+
+void ResourceManager::Preload(const std::vector<std::string>& shaders, const std::vector<std::string>& textures)
+{
+    StopLoader();
+
+    std::vector<std::string> shaderPaths, texturePaths;
+    for (const std::string& path : shaders)
+    {
+        if (m_Shaders.find(path) == m_Shaders.end())
+            shaderPaths.push_back(path);
+    }
+    for (const std::string& path : textures)
+    {
+        if (m_Textures.find(path) == m_Textures.end())
+            texturePaths.push_back(path);
+    }
+    if (shaderPaths.empty() && texturePaths.empty())
+        return;
+
+    m_CancelLoad = false;
+    m_PendingLoads = (int)(shaderPaths.size() + texturePaths.size());
+    m_Loader = std::thread(&ResourceManager::LoaderLoop, this, std::move(shaderPaths), std::move(texturePaths));
+}
+
+void ResourceManager::LoaderLoop(std::vector<std::string> shaders, std::vector<std::string> textures)
+{
+    for (const std::string& path : shaders)
+    {
+        if (m_CancelLoad)
+            return;
+
+        ParsedShader parsed = { path, Shader::ParseShader(path) };
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_ParsedShaders.push_back(std::move(parsed));
+        m_PendingLoads--;
+    }
+
+    for (const std::string& path : textures)
+    {
+        if (m_CancelLoad)
+            return;
+
+        // same flip as Texture, the flag is global in stb_image
+        stbi_set_flip_vertically_on_load(1);
+        DecodedImage image;
+        image.Path = path;
+        int bpp = 0;
+        image.Pixels = stbi_load(path.c_str(), &image.Width, &image.Height, &bpp, 4);
+        if (!image.Pixels)
+            std::cout << "Failed to preload '" << path << "'" << std::endl;
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (image.Pixels)
+            m_DecodedImages.push_back(image);
+        m_PendingLoads--;
+    }
+}
+
+void ResourceManager::StopLoader()
+{
+    if (!m_Loader.joinable())
+        return;
+
+    m_CancelLoad = true;
+    m_Loader.join();
+    m_PendingLoads = 0;
+}
+
+void ResourceManager::Update()
+{
+    std::vector<ParsedShader> shaders;
+    std::vector<DecodedImage> images;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        int uploads = 0;
+        while (!m_ParsedShaders.empty() && uploads < MaxUploadsPerFrame)
+        {
+            shaders.push_back(std::move(m_ParsedShaders.back()));
+            m_ParsedShaders.pop_back();
+            uploads++;
+        }
+        while (!m_DecodedImages.empty() && uploads < MaxUploadsPerFrame)
+        {
+            images.push_back(m_DecodedImages.back());
+            m_DecodedImages.pop_back();
+            uploads++;
+        }
+    }
+
+    GpuMemoryTracker::SharedScope shared;
+    for (const ParsedShader& parsed : shaders)
+    {
+        if (m_Shaders.find(parsed.Path) == m_Shaders.end())
+            m_Shaders[parsed.Path] = std::make_shared<Shader>(parsed.Path, parsed.Source);
+    }
+    for (const DecodedImage& image : images)
+    {
+        if (m_Textures.find(image.Path) == m_Textures.end())
+            m_Textures[image.Path] = std::make_shared<Texture>(image.Path, image.Width, image.Height, image.Pixels);
+        stbi_image_free(image.Pixels);
+    }
+}
+
+template<typename T>
+static size_t ReleaseUnusedIn(std::unordered_map<std::string, std::shared_ptr<T>>& cache)
+{
+    size_t released = 0;
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        if (it->second.use_count() == 1)
+        {
+            it = cache.erase(it);
+            released++;
+        }
+        else
+            ++it;
+    }
+    return released;
+}
+
+size_t ResourceManager::ReleaseUnused()
+{
+    size_t released = 0;
+    if (m_BatchRenderer && m_BatchRenderer.use_count() == 1)
+    {
+        m_BatchRenderer.reset();
+        released++;
+    }
+    // meshes and the batcher go first, they may hold on to shaders
+    released += ReleaseUnusedIn(m_Meshes);
+    released += ReleaseUnusedIn(m_Fonts);
+    released += ReleaseUnusedIn(m_Textures);
+    released += ReleaseUnusedIn(m_Shaders);
+    return released;
+}
+
+void ResourceManager::Clear()
+{
+    StopLoader();
+
+    m_BatchRenderer.reset();
+    m_Meshes.clear();
+    m_VertexArrays.clear();
+    m_Fonts.clear();
+    m_Textures.clear();
+    m_Shaders.clear();
+
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_ParsedShaders.clear();
+    for (DecodedImage& image : m_DecodedImages)
+        stbi_image_free(image.Pixels);
+    m_DecodedImages.clear();
+}
+
+template<typename T>
+static void ListResources(const char* label, const std::unordered_map<std::string, std::shared_ptr<T>>& cache)
+{
+    if (!ImGui::TreeNode(label, "%s (%u)", label, (unsigned int)cache.size()))
+        return;
+
+    // the manager holds one reference itself
+    for (auto& entry : cache)
+        ImGui::Text("%s: %ld refs", entry.first.c_str(), entry.second.use_count() - 1);
+    ImGui::TreePop();
+}
+
+void ResourceManager::OnImGuiRender()
+{
+    ImGui::Begin("Resources");
+
+    int pending = m_PendingLoads;
+    size_t ready;
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        ready = m_ParsedShaders.size() + m_DecodedImages.size();
+    }
+    ImGui::Text("%d loading, %u waiting for upload", pending, (unsigned int)ready);
+
+    ListResources("Shaders", m_Shaders);
+    ListResources("Textures", m_Textures);
+    ListResources("Fonts", m_Fonts);
+    ListResources("Meshes", m_Meshes);
+    ImGui::Text("Vertex formats: %u", (unsigned int)m_VertexArrays.size());
+    ImGui::Text("Batch renderer: %s", m_BatchRenderer ? "created" : "not created");
+
+    if (ImGui::Button("Release unused"))
+        std::cout << "Released " << ReleaseUnused() << " resources" << std::endl;
+
+    ImGui::End();
+}
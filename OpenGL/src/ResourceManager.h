@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Shader.h"
+#include "VertexArray.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class Texture;
+class Font;
+class BatchRenderer;
+
+// geometry shared between tests, e.g. the textured quad
+struct Mesh
+{
+	std::unique_ptr<VertexArray> VAO;
+	std::unique_ptr<VertexBuffer> VB;
+	std::unique_ptr<IndexBuffer> IB;
+};
+
+// owns shaders, textures, fonts and shared geometry across test switches, tests hold
+// reference counted handles and a resource is only created the first time it's asked for
+class ResourceManager
+{
+public:
+	// preloaded files turned into GL objects per Update so the menu stays responsive
+	static const int MaxUploadsPerFrame = 2;
+
+	static ResourceManager& Get();
+
+	// one program per set of defines ("NAME" or "NAME=VALUE"), in any order
+	std::shared_ptr<Shader> GetShader(const std::string& path, const std::vector<std::string>& defines = {});
+	std::shared_ptr<Texture> GetTexture(const std::string& path);
+	std::shared_ptr<Font> GetFont(const std::string& path, float pixelHeight);
+	// build fills the mesh the first time the name is requested
+	std::shared_ptr<Mesh> GetMesh(const std::string& name, const std::function<void(Mesh&)>& build);
+	// one VAO per vertex format, attach buffers with SetVertexBuffer/SetIndexBuffer before drawing
+	template<size_t N>
+	inline VertexArray& GetVertexArray(const VertexLayout<N>& layout) { return GetVertexArray(layout.Hash(), layout.Attributes.data(), N); }
+	VertexArray& GetVertexArray(uint64_t hash, const VertexAttribute* attributes, size_t count);
+	// the quad/line batcher and its buffers, one test runs at a time so they share it
+	std::shared_ptr<BatchRenderer> GetBatchRenderer();
+
+	// reads shader sources and decodes images on a loader thread
+	void Preload(const std::vector<std::string>& shaders, const std::vector<std::string>& textures);
+	// creates the GL objects for preloaded files, call once per frame on the GL thread
+	void Update();
+
+	// frees everything only the manager still references, returns how many
+	size_t ReleaseUnused();
+	// frees everything, call before the GL context is destroyed
+	void Clear();
+
+	void OnImGuiRender();
+
+private:
+	ResourceManager();
+	~ResourceManager();
+
+	struct DecodedImage
+	{
+		std::string Path;
+		int Width = 0, Height = 0;
+		unsigned char* Pixels = nullptr;
+	};
+
+	struct ParsedShader
+	{
+		std::string Path;
+		ShaderProgramSource Source;
+	};
+
+	void LoaderLoop(std::vector<std::string> shaders, std::vector<std::string> textures);
+	void StopLoader();
+
+	template<typename T>
+	using Cache = std::unordered_map<std::string, std::shared_ptr<T>>;
+
+	Cache<Shader> m_Shaders;
+	Cache<Texture> m_Textures;
+	Cache<Font> m_Fonts;
+	Cache<Mesh> m_Meshes;
+	std::unordered_map<uint64_t, VertexArray> m_VertexArrays;
+	std::shared_ptr<BatchRenderer> m_BatchRenderer;
+
+	// filled by the loader thread, drained by Update and the getters
+	std::mutex m_Mutex;
+	std::vector<ParsedShader> m_ParsedShaders;
+	std::vector<DecodedImage> m_DecodedImages;
+
+	std::thread m_Loader;
+	std::atomic<bool> m_CancelLoad;
+	std::atomic<int> m_PendingLoads;
+};
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// index into a ResourcePool, the generation tells a live slot from one that was reused
+template<typename T>
+struct Handle
+{
+	uint32_t Index = 0;
+	// slots start at generation 1, a default constructed handle is never valid
+	uint32_t Generation = 0;
+
+	inline bool operator==(const Handle& other) const { return Index == other.Index && Generation == other.Generation; }
+	inline bool operator!=(const Handle& other) const { return !(*this == other); }
+};
+
+// slot map keeping move-only GL wrappers by value in one contiguous array,
+// destroyed slots go on a free list and are reused with a bumped generation
+template<typename T>
+class ResourcePool
+{
+public:
+	template<typename... Args>
+	Handle<T> Create(Args&&... args)
+	{
+		uint32_t index;
+		if (!m_FreeList.empty())
+		{
+			index = m_FreeList.back();
+			m_FreeList.pop_back();
+		}
+		else
+		{
+			index = (uint32_t)m_Slots.size();
+			m_Slots.emplace_back();
+		}
+
+		Slot& slot = m_Slots[index];
+		slot.Value.emplace(std::forward<Args>(args)...);
+		m_Count++;
+		return { index, slot.Generation };
+	}
+
+	// stale handles are ignored
+	void Destroy(Handle<T> handle)
+	{
+		if (!IsValid(handle))
+			return;
+
+		Release(handle.Index);
+	}
+
+	inline bool IsValid(Handle<T> handle) const
+	{
+		return handle.Index < m_Slots.size() && m_Slots[handle.Index].Generation == handle.Generation
+			&& m_Slots[handle.Index].Value.has_value();
+	}
+
+	// nullptr for stale handles, the pointer is only good until the next Create
+	inline T* Get(Handle<T> handle) { return IsValid(handle) ? &*m_Slots[handle.Index].Value : nullptr; }
+	inline const T* Get(Handle<T> handle) const { return IsValid(handle) ? &*m_Slots[handle.Index].Value : nullptr; }
+
+	template<typename Func>
+	void ForEach(Func&& func)
+	{
+		for (Slot& slot : m_Slots)
+		{
+			if (slot.Value)
+				func(*slot.Value);
+		}
+	}
+
+	// destroys everything, handles given out before stay invalid
+	void Clear()
+	{
+		for (uint32_t i = 0; i < (uint32_t)m_Slots.size(); i++)
+		{
+			if (m_Slots[i].Value)
+				Release(i);
+		}
+	}
+
+	inline void Reserve(size_t count) { m_Slots.reserve(count); }
+	inline size_t GetCount() const { return m_Count; }
+	inline size_t GetCapacity() const { return m_Slots.size(); }
+
+private:
+	struct Slot
+	{
+		std::optional<T> Value;
+		uint32_t Generation = 1;
+	};
+
+	void Release(uint32_t index)
+	{
+		Slot& slot = m_Slots[index];
+		slot.Value.reset();
+		if (++slot.Generation == 0)
+			slot.Generation = 1;
+		m_FreeList.push_back(index);
+		m_Count--;
+	}
+
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeList;
+	size_t m_Count = 0;
+};
@@ -0,0 +1,483 @@
+#include "SceneFile.h"
+
+#include "BatchRenderer.h"
+#include "Profiler.h"
+#include "ResourceManager.h"
+#include "Texture.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+static size_t AlignScene(size_t offset)
+{
+    return (offset + SceneAlignment - 1) / SceneAlignment * SceneAlignment;
+}
+
+// a chunk grid this size is already ~128 MB of chunk table
+static const uint64_t MaxSceneChunks = 16 * 1024 * 1024;
+
+SceneFile::SceneFile()
+    : m_Header(nullptr), m_Textures(nullptr), m_Chunks(nullptr),
+    m_PositionX(nullptr), m_PositionY(nullptr), m_SizeX(nullptr), m_SizeY(nullptr),
+    m_Colors(nullptr), m_TextureIndices(nullptr)
+{
+}
+
+SceneFile::~SceneFile()
+{
+}
+
+bool SceneFile::Open(const std::string& path)
+{
+    PROFILE_SCOPE("SceneFile::Open");
+
+    Close();
+    if (!m_File.Open(path))
+        return false;
+
+    const uint8_t* data = m_File.GetData();
+    size_t size = m_File.GetSize();
+    const SceneHeader* header = (const SceneHeader*)data;
+    if (size < sizeof(SceneHeader) || header->Magic != SceneMagic)
+    {
+        std::cout << "'" << path << "' is not a scene file" << std::endl;
+        m_File.Close();
+        return false;
+    }
+    if (header->Version != SceneVersion)
+    {
+        std::cout << "'" << path << "' is scene version " << header->Version << ", expected " << SceneVersion << std::endl;
+        m_File.Close();
+        return false;
+    }
+
+    // every array has to lie inside the file, the contents are trusted from here on
+    uint64_t chunkCount = (uint64_t)header->ChunkColumns * header->ChunkRows;
+    const auto fits = [size](uint64_t offset, uint64_t count, uint64_t elementSize) {
+        return offset % SceneAlignment == 0 && offset <= size && count * elementSize <= size - offset;
+    };
+    bool valid = header->ChunkSize > 0.0f && chunkCount > 0 && chunkCount <= MaxSceneChunks
+        && fits(header->TexturesOffset, header->TextureCount, sizeof(SceneTexture))
+        && fits(header->ChunksOffset, chunkCount, sizeof(SceneChunk))
+        && fits(header->PositionXOffset, header->SpriteCount, sizeof(float))
+        && fits(header->PositionYOffset, header->SpriteCount, sizeof(float))
+        && fits(header->SizeXOffset, header->SpriteCount, sizeof(float))
+        && fits(header->SizeYOffset, header->SpriteCount, sizeof(float))
+        && fits(header->ColorOffset, header->SpriteCount, sizeof(uint32_t))
+        && fits(header->TextureOffset, header->SpriteCount, sizeof(uint16_t));
+
+    // the chunk table is small next to the sprites, checked so a bad file can't index past them
+    const SceneChunk* chunks = (const SceneChunk*)(data + header->ChunksOffset);
+    for (uint64_t i = 0; i < chunkCount && valid; i++)
+        valid = (uint64_t)chunks[i].First + chunks[i].Count <= header->SpriteCount;
+
+    if (!valid)
+    {
+        std::cout << "'" << path << "' is truncated or corrupt" << std::endl;
+        m_File.Close();
+        return false;
+    }
+
+    m_Header = header;
+    m_Textures = (const SceneTexture*)(data + header->TexturesOffset);
+    m_Chunks = chunks;
+    m_PositionX = (const float*)(data + header->PositionXOffset);
+    m_PositionY = (const float*)(data + header->PositionYOffset);
+    m_SizeX = (const float*)(data + header->SizeXOffset);
+    m_SizeY = (const float*)(data + header->SizeYOffset);
+    m_Colors = (const uint32_t*)(data + header->ColorOffset);
+    m_TextureIndices = (const uint16_t*)(data + header->TextureOffset);
+    return true;
+}
+
+void SceneFile::Close()
+{
+    m_File.Close();
+    m_Header = nullptr;
+    m_Textures = nullptr;
+    m_Chunks = nullptr;
+    m_PositionX = m_PositionY = m_SizeX = m_SizeY = nullptr;
+    m_Colors = nullptr;
+    m_TextureIndices = nullptr;
+    m_LoadedTextures.clear();
+    m_TextureIDs.clear();
+}
+
+void SceneFile::LoadTextures()
+{
+    if (!IsOpen())
+        return;
+
+    m_LoadedTextures.resize(m_Header->TextureCount);
+    m_TextureIDs.resize(m_Header->TextureCount);
+    for (uint32_t i = 0; i < m_Header->TextureCount; i++)
+    {
+        // not necessarily terminated in a corrupt file
+        std::string path(m_Textures[i].Path, strnlen(m_Textures[i].Path, sizeof(m_Textures[i].Path)));
+        m_LoadedTextures[i] = ResourceManager::Get().GetTexture(path);
+        m_TextureIDs[i] = m_LoadedTextures[i]->GetRendererID();
+    }
+}
+
+bool SceneFile::GetChunkRange(const glm::vec2& min, const glm::vec2& max, glm::ivec2& first, glm::ivec2& last) const
+{
+    if (!IsOpen())
+        return false;
+
+    // sprites reach up to MaxSpriteSize past their own chunk
+    glm::vec2 origin = { m_Header->ChunkMinX, m_Header->ChunkMinY };
+    glm::vec2 from = glm::floor((min - m_Header->MaxSpriteSize - origin) / m_Header->ChunkSize);
+    glm::vec2 to = glm::floor((max - origin) / m_Header->ChunkSize);
+    glm::vec2 limit = { (float)m_Header->ChunkColumns - 1.0f, (float)m_Header->ChunkRows - 1.0f };
+    if (to.x < 0.0f || to.y < 0.0f || from.x > limit.x || from.y > limit.y)
+        return false;
+
+    first = glm::ivec2(glm::max(from, glm::vec2(0.0f)));
+    last = glm::ivec2(glm::min(to, limit));
+    return true;
+}
+
+void SceneFile::DrawChunk(BatchRenderer& renderer, const SceneChunk& chunk) const
+{
+    uint32_t textureCount = (uint32_t)m_TextureIDs.size();
+    uint32_t end = chunk.First + chunk.Count;
+    for (uint32_t i = chunk.First; i < end; i++)
+    {
+        glm::vec2 position = { m_PositionX[i], m_PositionY[i] };
+        glm::vec2 size = { m_SizeX[i], m_SizeY[i] };
+        uint32_t packed = m_Colors[i];
+        glm::vec4 color = glm::vec4(packed & 0xff, packed >> 8 & 0xff, packed >> 16 & 0xff, packed >> 24) / 255.0f;
+
+        uint16_t texture = m_TextureIndices[i];
+        if (texture < textureCount)
+        {
+            const SceneTexture& entry = m_Textures[texture];
+            renderer.DrawQuad(position, size, m_TextureIDs[texture], { entry.UVMin[0], entry.UVMin[1] },
+                { entry.UVMax[0], entry.UVMax[1] }, color);
+        }
+        else
+            renderer.DrawQuad(position, size, color);
+    }
+}
+
+size_t SceneFile::DrawRegion(BatchRenderer& renderer, const glm::vec2& min, const glm::vec2& max) const
+{
+    PROFILE_SCOPE("SceneFile::DrawRegion");
+
+    glm::ivec2 first, last;
+    if (!GetChunkRange(min, max, first, last))
+        return 0;
+
+    size_t sprites = 0;
+    for (int y = first.y; y <= last.y; y++)
+    {
+        for (int x = first.x; x <= last.x; x++)
+        {
+            const SceneChunk& chunk = GetChunk(x, y);
+            DrawChunk(renderer, chunk);
+            sprites += chunk.Count;
+        }
+    }
+    return sprites;
+}
+
+void SceneFile::ReleaseChunk(const SceneChunk& chunk) const
+{
+    const SceneHeader& header = *m_Header;
+    m_File.Release(header.PositionXOffset + chunk.First * sizeof(float), chunk.Count * sizeof(float));
+    m_File.Release(header.PositionYOffset + chunk.First * sizeof(float), chunk.Count * sizeof(float));
+    m_File.Release(header.SizeXOffset + chunk.First * sizeof(float), chunk.Count * sizeof(float));
+    m_File.Release(header.SizeYOffset + chunk.First * sizeof(float), chunk.Count * sizeof(float));
+    m_File.Release(header.ColorOffset + chunk.First * sizeof(uint32_t), chunk.Count * sizeof(uint32_t));
+    m_File.Release(header.TextureOffset + chunk.First * sizeof(uint16_t), chunk.Count * sizeof(uint16_t));
+}
+
+SceneWriter::SceneWriter(float chunkSize)
+    : m_ChunkSize(chunkSize)
+{
+}
+
+uint16_t SceneWriter::AddTexture(const std::string& path, const glm::vec2& uvMin, const glm::vec2& uvMax)
+{
+    SceneTexture texture = {};
+    if (path.size() >= sizeof(texture.Path))
+        std::cout << "Scene texture path '" << path << "' is cut to " << sizeof(texture.Path) - 1 << " characters" << std::endl;
+    strncpy(texture.Path, path.c_str(), sizeof(texture.Path) - 1);
+    texture.UVMin[0] = uvMin.x;
+    texture.UVMin[1] = uvMin.y;
+    texture.UVMax[0] = uvMax.x;
+    texture.UVMax[1] = uvMax.y;
+    m_Textures.push_back(texture);
+    return (uint16_t)(m_Textures.size() - 1);
+}
+
+void SceneWriter::AddSprite(const glm::vec2& position, const glm::vec2& size, uint32_t color, uint16_t texture)
+{
+    m_PositionX.push_back(position.x);
+    m_PositionY.push_back(position.y);
+    m_SizeX.push_back(size.x);
+    m_SizeY.push_back(size.y);
+    m_Colors.push_back(color);
+    m_TextureIndices.push_back(texture);
+}
+
+void SceneWriter::Reserve(size_t spriteCount)
+{
+    m_PositionX.reserve(spriteCount);
+    m_PositionY.reserve(spriteCount);
+    m_SizeX.reserve(spriteCount);
+    m_SizeY.reserve(spriteCount);
+    m_Colors.reserve(spriteCount);
+    m_TextureIndices.reserve(spriteCount);
+}
+
+// one array in chunk order, staged through a small buffer
+template<typename T>
+static void WriteSorted(std::ofstream& stream, const std::vector<T>& values, const std::vector<uint32_t>& order)
+{
+    static const size_t BlockSize = 64 * 1024;
+    std::vector<T> block(std::min(BlockSize, order.size()));
+    for (size_t begin = 0; begin < order.size(); begin += BlockSize)
+    {
+        size_t count = std::min(BlockSize, order.size() - begin);
+        for (size_t i = 0; i < count; i++)
+            block[i] = values[order[begin + i]];
+        stream.write((const char*)block.data(), count * sizeof(T));
+    }
+}
+
+static void WritePadding(std::ofstream& stream, size_t offset)
+{
+    static const char zeros[SceneAlignment] = {};
+    stream.write(zeros, AlignScene(offset) - offset);
+}
+
+bool SceneWriter::Write(const std::string& path) const
+{
+    PROFILE_SCOPE("SceneWriter::Write");
+
+    size_t count = m_PositionX.size();
+    if (count > UINT32_MAX || m_ChunkSize <= 0.0f)
+    {
+        std::cout << "Can't write " << count << " sprites with chunk size " << m_ChunkSize << std::endl;
+        return false;
+    }
+
+    SceneHeader header = {};
+    header.Magic = SceneMagic;
+    header.Version = SceneVersion;
+    header.SpriteCount = (uint32_t)count;
+    header.TextureCount = (uint32_t)m_Textures.size();
+    header.ChunkSize = m_ChunkSize;
+
+    glm::vec2 min = { 0.0f, 0.0f }, max = { 0.0f, 0.0f };
+    if (count > 0)
+    {
+        min = max = { m_PositionX[0], m_PositionY[0] };
+        for (size_t i = 0; i < count; i++)
+        {
+            min = glm::min(min, glm::vec2(m_PositionX[i], m_PositionY[i]));
+            max = glm::max(max, glm::vec2(m_PositionX[i], m_PositionY[i]));
+            header.MaxSpriteSize = std::max(header.MaxSpriteSize, std::max(m_SizeX[i], m_SizeY[i]));
+        }
+    }
+    header.ChunkMinX = min.x;
+    header.ChunkMinY = min.y;
+    header.ChunkColumns = (uint32_t)std::floor((max.x - min.x) / m_ChunkSize) + 1;
+    header.ChunkRows = (uint32_t)std::floor((max.y - min.y) / m_ChunkSize) + 1;
+    uint64_t chunkCount = (uint64_t)header.ChunkColumns * header.ChunkRows;
+    if (chunkCount > MaxSceneChunks)
+    {
+        std::cout << "Scene needs " << chunkCount << " chunks, use a larger chunk size" << std::endl;
+        return false;
+    }
+
+    // counting sort by chunk, stable so sprites keep their order within a chunk
+    std::vector<uint32_t> chunkIndex(count);
+    std::vector<SceneChunk> chunks((size_t)chunkCount, SceneChunk{ 0, 0 });
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t x = std::min((uint32_t)((m_PositionX[i] - min.x) / m_ChunkSize), header.ChunkColumns - 1);
+        uint32_t y = std::min((uint32_t)((m_PositionY[i] - min.y) / m_ChunkSize), header.ChunkRows - 1);
+        chunkIndex[i] = y * header.ChunkColumns + x;
+        chunks[chunkIndex[i]].Count++;
+    }
+    uint32_t first = 0;
+    for (SceneChunk& chunk : chunks)
+    {
+        chunk.First = first;
+        first += chunk.Count;
+    }
+    std::vector<uint32_t> order(count);
+    {
+        std::vector<uint32_t> next(chunks.size());
+        for (size_t i = 0; i < chunks.size(); i++)
+            next[i] = chunks[i].First;
+        for (size_t i = 0; i < count; i++)
+            order[next[chunkIndex[i]]++] = (uint32_t)i;
+    }
+
+    size_t offset = AlignScene(sizeof(SceneHeader));
+    header.TexturesOffset = offset;
+    offset = AlignScene(offset + m_Textures.size() * sizeof(SceneTexture));
+    header.ChunksOffset = offset;
+    offset = AlignScene(offset + chunks.size() * sizeof(SceneChunk));
+    header.PositionXOffset = offset;
+    offset = AlignScene(offset + count * sizeof(float));
+    header.PositionYOffset = offset;
+    offset = AlignScene(offset + count * sizeof(float));
+    header.SizeXOffset = offset;
+    offset = AlignScene(offset + count * sizeof(float));
+    header.SizeYOffset = offset;
+    offset = AlignScene(offset + count * sizeof(float));
+    header.ColorOffset = offset;
+    offset = AlignScene(offset + count * sizeof(uint32_t));
+    header.TextureOffset = offset;
+
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream)
+    {
+        std::cout << "Failed to open '" << path << "' for writing" << std::endl;
+        return false;
+    }
+
+    stream.write((const char*)&header, sizeof(header));
+    WritePadding(stream, sizeof(header));
+    stream.write((const char*)m_Textures.data(), m_Textures.size() * sizeof(SceneTexture));
+    WritePadding(stream, header.TexturesOffset + m_Textures.size() * sizeof(SceneTexture));
+    stream.write((const char*)chunks.data(), chunks.size() * sizeof(SceneChunk));
+    WritePadding(stream, header.ChunksOffset + chunks.size() * sizeof(SceneChunk));
+    WriteSorted(stream, m_PositionX, order);
+    WritePadding(stream, header.PositionXOffset + count * sizeof(float));
+    WriteSorted(stream, m_PositionY, order);
+    WritePadding(stream, header.PositionYOffset + count * sizeof(float));
+    WriteSorted(stream, m_SizeX, order);
+    WritePadding(stream, header.SizeXOffset + count * sizeof(float));
+    WriteSorted(stream, m_SizeY, order);
+    WritePadding(stream, header.SizeYOffset + count * sizeof(float));
+    WriteSorted(stream, m_Colors, order);
+    WritePadding(stream, header.ColorOffset + count * sizeof(uint32_t));
+    WriteSorted(stream, m_TextureIndices, order);
+
+    if (!stream)
+    {
+        std::cout << "Failed to write '" << path << "'" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool ConvertTextScene(const std::string& textPath, const std::string& scenePath)
+{
+    std::ifstream stream(textPath);
+    if (!stream)
+    {
+        std::cout << "Failed to open '" << textPath << "'" << std::endl;
+        return false;
+    }
+
+    SceneWriter writer;
+    size_t textureCount = 0;
+    std::string line;
+    for (int number = 1; std::getline(stream, line); number++)
+    {
+        size_t comment = line.find('#');
+        if (comment != std::string::npos)
+            line.erase(comment);
+
+        std::istringstream words(line);
+        std::string statement;
+        if (!(words >> statement))
+            continue;
+
+        bool valid = false;
+        if (statement == "chunk")
+        {
+            float size = 0.0f;
+            valid = (bool)(words >> size) && size > 0.0f;
+            if (valid)
+                writer.SetChunkSize(size);
+        }
+        else if (statement == "texture")
+        {
+            std::string path;
+            glm::vec2 uvMin = { 0.0f, 0.0f }, uvMax = { 1.0f, 1.0f };
+            valid = (bool)(words >> path);
+            if (valid && words >> uvMin.x)
+                valid = (bool)(words >> uvMin.y >> uvMax.x >> uvMax.y);
+            if (valid)
+            {
+                writer.AddTexture(path, uvMin, uvMax);
+                textureCount++;
+            }
+        }
+        else if (statement == "sprite")
+        {
+            glm::vec2 position, size;
+            glm::vec4 color;
+            valid = (bool)(words >> position.x >> position.y >> size.x >> size.y >> color.r >> color.g >> color.b >> color.a);
+            unsigned int texture = SceneNoTexture;
+            if (valid && words >> texture)
+                valid = texture < textureCount;
+            if (valid)
+                writer.AddSprite(position, size, PackSceneColor(color), (uint16_t)texture);
+        }
+
+        if (!valid)
+        {
+            std::cout << textPath << ":" << number << ": can't read '" << line << "'" << std::endl;
+            return false;
+        }
+    }
+
+    if (!writer.Write(scenePath))
+        return false;
+
+    std::cout << "Wrote " << writer.GetSpriteCount() << " sprites to '" << scenePath << "'" << std::endl;
+    return true;
+}
+
+void GenerateScene(SceneWriter& writer, uint32_t spriteCount, uint32_t seed)
+{
+    PROFILE_SCOPE("GenerateScene");
+
+    uint16_t penguin = writer.AddTexture("res/textures/Penguin.png");
+    uint16_t icon = writer.AddTexture("res/textures/icon.png");
+    // the penguin's quarters as if it were a 2x2 atlas
+    uint16_t quarters = writer.AddTexture("res/textures/Penguin.png", { 0.0f, 0.0f }, { 0.5f, 0.5f });
+    writer.AddTexture("res/textures/Penguin.png", { 0.5f, 0.0f }, { 1.0f, 0.5f });
+    writer.AddTexture("res/textures/Penguin.png", { 0.0f, 0.5f }, { 0.5f, 1.0f });
+    writer.AddTexture("res/textures/Penguin.png", { 0.5f, 0.5f }, { 1.0f, 1.0f });
+
+    float side = std::sqrt((float)spriteCount) * 16.0f;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> position(0.0f, side);
+    std::uniform_real_distribution<float> size(4.0f, 24.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> kind(0, 15);
+
+    writer.Reserve(writer.GetSpriteCount() + spriteCount);
+    for (uint32_t i = 0; i < spriteCount; i++)
+    {
+        glm::vec2 at = { position(rng), position(rng) };
+        float extent = size(rng);
+        int type = kind(rng);
+        if (type == 0)
+            writer.AddSprite(at, { extent, extent }, 0xffffffff, penguin);
+        else if (type == 1)
+            writer.AddSprite(at, { extent, extent }, 0xffffffff, icon);
+        else if (type <= 3)
+            writer.AddSprite(at, { extent, extent }, 0xffffffff, (uint16_t)(quarters + (i & 3)));
+        else
+        {
+            // a tint that drifts across the world so chunks are easy to tell apart
+            glm::vec4 color = { at.x / side, 0.3f + 0.4f * unit(rng), at.y / side, 1.0f };
+            writer.AddSprite(at, { extent, extent * (0.5f + unit(rng)) }, PackSceneColor(color));
+        }
+    }
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include "glm/glm.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class BatchRenderer;
+class Texture;
+
+// binary sprite scene, everything is stored the way it's used so a mapped file can be
+// read in place:
+//
+//     SceneHeader
+//     SceneTexture[TextureCount]
+//     SceneChunk[ChunkColumns * ChunkRows]     row major, empty chunks included
+//     float PositionX[SpriteCount], PositionY, SizeX, SizeY
+//     uint32_t Color[SpriteCount]              RGBA8, red in the low byte
+//     uint16_t Texture[SpriteCount]            index into the textures or SceneNoTexture
+//
+// sprites are sorted by chunk, so a chunk is one range of every array, and every array
+// starts on a SceneAlignment boundary; all values are little endian
+static const uint32_t SceneMagic = 0x314e4353; // "SCN1"
+static const uint32_t SceneVersion = 1;
+static const size_t SceneAlignment = 64;
+static const uint16_t SceneNoTexture = 0xffff;
+
+struct SceneHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t SpriteCount;
+	uint32_t TextureCount;
+	// chunk (x, y) covers [ChunkMin + (x, y) * ChunkSize, + ChunkSize), sprites belong to
+	// the chunk holding their position and reach at most MaxSpriteSize past it
+	float ChunkSize;
+	float MaxSpriteSize;
+	float ChunkMinX, ChunkMinY;
+	uint32_t ChunkColumns, ChunkRows;
+	// byte offsets from the start of the file
+	uint64_t TexturesOffset;
+	uint64_t ChunksOffset;
+	uint64_t PositionXOffset, PositionYOffset;
+	uint64_t SizeXOffset, SizeYOffset;
+	uint64_t ColorOffset;
+	uint64_t TextureOffset;
+};
+
+// a texture or a region of an atlas, several entries may name the same file
+struct SceneTexture
+{
+	char Path[112];
+	float UVMin[2];
+	float UVMax[2];
+};
+
+struct SceneChunk
+{
+	uint32_t First;
+	uint32_t Count;
+};
+
+static_assert(sizeof(SceneHeader) == 104, "scene header layout changed, bump SceneVersion");
+static_assert(sizeof(SceneTexture) == 128, "scene texture layout changed, bump SceneVersion");
+static_assert(sizeof(SceneChunk) == 8, "scene chunk layout changed, bump SceneVersion");
+
+// a mapped scene file, opening only checks the header and that every array lies inside
+// the file, the sprite data is paged in by whatever touches it first
+class SceneFile
+{
+public:
+	SceneFile();
+	~SceneFile();
+
+	bool Open(const std::string& path);
+	void Close();
+	// resolves the texture table through the resource manager, needs a GL context
+	void LoadTextures();
+
+	inline bool IsOpen() const { return m_File.IsOpen(); }
+	inline const SceneHeader& GetHeader() const { return *m_Header; }
+	inline uint32_t GetSpriteCount() const { return m_Header->SpriteCount; }
+	inline size_t GetFileSize() const { return m_File.GetSize(); }
+
+	inline const SceneTexture& GetTexture(uint32_t index) const { return m_Textures[index]; }
+	inline const SceneChunk& GetChunk(uint32_t x, uint32_t y) const { return m_Chunks[y * m_Header->ChunkColumns + x]; }
+	// chunk coordinates whose sprites may overlap the world rectangle, false if none
+	bool GetChunkRange(const glm::vec2& min, const glm::vec2& max, glm::ivec2& first, glm::ivec2& last) const;
+
+	inline const float* GetPositionX() const { return m_PositionX; }
+	inline const float* GetPositionY() const { return m_PositionY; }
+	inline const float* GetSizeX() const { return m_SizeX; }
+	inline const float* GetSizeY() const { return m_SizeY; }
+	inline const uint32_t* GetColors() const { return m_Colors; }
+	inline const uint16_t* GetTextureIndices() const { return m_TextureIndices; }
+
+	// submits the sprites straight from the mapping, LoadTextures first for textured ones
+	void DrawChunk(BatchRenderer& renderer, const SceneChunk& chunk) const;
+	// every chunk overlapping the rectangle, returns how many sprites went out
+	size_t DrawRegion(BatchRenderer& renderer, const glm::vec2& min, const glm::vec2& max) const;
+	// drops the chunk's sprite pages from memory once they've been copied elsewhere
+	void ReleaseChunk(const SceneChunk& chunk) const;
+
+private:
+	MappedFile m_File;
+	const SceneHeader* m_Header;
+	const SceneTexture* m_Textures;
+	const SceneChunk* m_Chunks;
+	const float* m_PositionX;
+	const float* m_PositionY;
+	const float* m_SizeX;
+	const float* m_SizeY;
+	const uint32_t* m_Colors;
+	const uint16_t* m_TextureIndices;
+
+	// GL texture per table entry, 0 until loaded
+	std::vector<std::shared_ptr<Texture>> m_LoadedTextures;
+	std::vector<uint32_t> m_TextureIDs;
+};
+
+// collects sprites in any order and writes them sorted by chunk
+class SceneWriter
+{
+public:
+	SceneWriter(float chunkSize = 256.0f);
+
+	// world units per chunk side, a few screens worth of sprites per chunk is about right
+	inline void SetChunkSize(float size) { m_ChunkSize = size; }
+
+	// uv rectangle of a region when the file is an atlas
+	uint16_t AddTexture(const std::string& path, const glm::vec2& uvMin = { 0.0f, 0.0f },
+		const glm::vec2& uvMax = { 1.0f, 1.0f });
+	void AddSprite(const glm::vec2& position, const glm::vec2& size, uint32_t color,
+		uint16_t texture = SceneNoTexture);
+	void Reserve(size_t spriteCount);
+
+	bool Write(const std::string& path) const;
+
+	inline size_t GetSpriteCount() const { return m_PositionX.size(); }
+
+private:
+	float m_ChunkSize;
+	std::vector<SceneTexture> m_Textures;
+	std::vector<float> m_PositionX, m_PositionY, m_SizeX, m_SizeY;
+	std::vector<uint32_t> m_Colors;
+	std::vector<uint16_t> m_TextureIndices;
+};
+
+// RGBA8 as stored in the file
+inline uint32_t PackSceneColor(const glm::vec4& color)
+{
+	glm::uvec4 bytes = glm::uvec4(glm::clamp(color, 0.0f, 1.0f) * 255.0f + 0.5f);
+	return bytes.r | bytes.g << 8 | bytes.b << 16 | bytes.a << 24;
+}
+
+// text scene, one statement per line, # starts a comment:
+//
+//     chunk <size>
+//     texture <path> [u0 v0 u1 v1]
+//     sprite <x> <y> <width> <height> <r> <g> <b> <a> [texture index]
+//
+// colors are 0 to 1, textures are numbered in the order they appear
+bool ConvertTextScene(const std::string& textPath, const std::string& scenePath);
+
+// random sprites scattered over a square world about 16 units per sprite wide, some
+// untinted textures and atlas regions among them
+void GenerateScene(SceneWriter& writer, uint32_t spriteCount, uint32_t seed = 1);
@@ -1,52 +1,170 @@
 #include "Shader.h"
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <utility>
 
+#include "CommandCapture.h"
+#include "GpuMemoryTracker.h"
 #include "Renderer.h"
 
-Shader::Shader(const std::string& filepath)
-	: m_FilePath(filepath), m_RendererID(0)
+Shader::Shader(const std::string& filepath, const std::vector<std::string>& defines)
+	: m_FilePath(filepath), m_Defines(defines), m_RendererID(0)
 {
     ShaderProgramSource source = ParseShader(filepath);
 	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
 }
 
+Shader::Shader(const std::string& filepath, const ShaderProgramSource& source, const std::vector<std::string>& defines)
+	: m_FilePath(filepath), m_Defines(defines), m_RendererID(0)
+{
+	m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+}
+
 Shader::~Shader()
 {
+    CommandCapture::Get().UnregisterProgram(m_RendererID);
+    GPU_UNTRACK(GpuResourceType::Program, m_RendererID);
     GLCall(glDeleteProgram(m_RendererID));
 }
 
-ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+Shader::Shader(Shader&& other) noexcept
+	: m_FilePath(std::move(other.m_FilePath)), m_Defines(std::move(other.m_Defines)), m_RendererID(other.m_RendererID),
+	m_UniformLocationCache(std::move(other.m_UniformLocationCache))
+{
+	other.m_RendererID = 0;
+}
+
+Shader& Shader::operator=(Shader&& other) noexcept
 {
+	std::swap(m_FilePath, other.m_FilePath);
+	std::swap(m_Defines, other.m_Defines);
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_UniformLocationCache, other.m_UniformLocationCache);
+	return *this;
+}
+
+namespace {
+
     enum class ShaderType
     {
         NONE = -1, VERTEX = 0, FRAGMENT = 1
     };
 
+    struct ParseState
+    {
+        ShaderType Type = ShaderType::NONE;
+        std::stringstream Stages[2];
+        // lines of the top level file per stage, to restore the numbering after an include
+        int Lines[2] = {};
+        // every file goes into a stage once, like #pragma once
+        std::vector<std::string> Included[2];
+    };
+
+}
+
+// includes nested deeper than this are taken for a cycle
+static const int MaxIncludeDepth = 16;
+
+static void ParseFile(const std::string& filepath, ParseState& state, int depth)
+{
     std::ifstream stream(filepath);
-    std::stringstream ss[2];
-    ShaderType type = ShaderType::NONE;
+    if (!stream)
+    {
+        std::cout << "Failed to open shader '" << filepath << "'" << std::endl;
+        return;
+    }
+
+    size_t slash = filepath.find_last_of("/\\");
+    std::string directory = slash == std::string::npos ? std::string() : filepath.substr(0, slash + 1);
 
     std::string line;
     while (getline(stream, line))
     {
-        if (line.find("#shader") != std::string::npos)
+        if (depth == 0 && line.find("#shader") != std::string::npos)
         {
             if (line.find("vertex") != std::string::npos)
-                type = ShaderType::VERTEX;
+                state.Type = ShaderType::VERTEX;
             else if (line.find("fragment") != std::string::npos)
-                type = ShaderType::FRAGMENT;
+                state.Type = ShaderType::FRAGMENT;
+            continue;
         }
-        else if (type != ShaderType::NONE)
+        if (state.Type == ShaderType::NONE)
+            continue;
+
+        int stage = (int)state.Type;
+        if (depth == 0)
+            state.Lines[stage]++;
+
+        size_t include = line.find("#include");
+        if (include == std::string::npos)
         {
-            ss[(int)type] << line << '\n';
+            state.Stages[stage] << line << '\n';
+            continue;
         }
+        // an include that pastes nothing still takes up its line
+        bool pasted = false;
+
+        size_t open = line.find('"', include);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos)
+            std::cout << filepath << ": malformed " << line << std::endl;
+        else
+        {
+            std::string path = directory + line.substr(open + 1, close - open - 1);
+            std::vector<std::string>& included = state.Included[stage];
+            bool seen = std::find(included.begin(), included.end(), path) != included.end();
+            if (!seen && depth + 1 >= MaxIncludeDepth)
+                std::cout << filepath << ": includes nested too deep at '" << path << "'" << std::endl;
+            else if (!seen)
+            {
+                included.push_back(path);
+                ParseFile(path, state, depth + 1);
+                pasted = true;
+            }
+        }
+
+        // compile errors after the include point at the right line again
+        if (!pasted)
+            state.Stages[stage] << '\n';
+        else if (depth == 0)
+            state.Stages[stage] << "#line " << state.Lines[stage] + 1 << '\n';
+    }
+}
+
+ShaderProgramSource Shader::ParseShader(const std::string& filepath)
+{
+    ParseState state;
+    ParseFile(filepath, state, 0);
+    return { state.Stages[0].str(), state.Stages[1].str() };
+}
+
+std::string Shader::InjectDefines(const std::string& source, const std::vector<std::string>& defines)
+{
+    if (defines.empty())
+        return source;
+
+    // #version has to stay the first statement
+    size_t version = source.find("#version");
+    size_t insert = version == std::string::npos ? 0 : source.find('\n', version);
+    insert = insert == std::string::npos ? source.size() : insert + 1;
+    int line = (int)std::count(source.begin(), source.begin() + insert, '\n');
+
+    std::string block;
+    for (const std::string& define : defines)
+    {
+        size_t equals = define.find('=');
+        if (equals == std::string::npos)
+            block += "#define " + define + "\n";
+        else
+            block += "#define " + define.substr(0, equals) + " " + define.substr(equals + 1) + "\n";
     }
+    block += "#line " + std::to_string(line + 1) + "\n";
 
-    return { ss[0].str(), ss[1].str() };
+    return source.substr(0, insert) + block + source.substr(insert);
 }
 
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
@@ -65,9 +183,13 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
         glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
         char* message = (char*)malloc(length * sizeof(char));
         glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile" <<
+        // the defines tell the variants of one file apart
+        std::cout << "Failed to compile " <<
             (type == GL_VERTEX_SHADER ? "vertex" : "fragment")
-            << "shader" << std::endl;
+            << " shader of " << m_FilePath;
+        for (const std::string& define : m_Defines)
+            std::cout << " " << define;
+        std::cout << std::endl;
         std::cout << message << std::endl;
         glDeleteShader(id);
         return 0;
@@ -79,8 +201,10 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 unsigned int Shader::CreateShader(const std::string& vertexShader, const std::string& fragmentShader)
 {
     unsigned int program = glCreateProgram();
-    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    std::string vertexSource = InjectDefines(vertexShader, m_Defines);
+    std::string fragmentSource = InjectDefines(fragmentShader, m_Defines);
+    unsigned int vs = CompileShader(GL_VERTEX_SHADER, vertexSource);
+    unsigned int fs = CompileShader(GL_FRAGMENT_SHADER, fragmentSource);
 
     glAttachShader(program, vs);
     glAttachShader(program, fs);
@@ -90,6 +214,12 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
     glDeleteShader(vs);
     glDeleteShader(fs);
 
+    std::string name = m_FilePath;
+    for (const std::string& define : m_Defines)
+        name += " " + define;
+    GPU_TRACK(GpuResourceType::Program, program, 0, name);
+    // a capture keeps the sources of the programs it draws with
+    CommandCapture::Get().RegisterProgram(program, vertexSource, fragmentSource, name);
     return program;
 }
 
@@ -103,39 +233,48 @@ void Shader::Unbind() const
     GLCall(glUseProgram(0));
 }
 
-void Shader::SetUniform1i(const std::string& name, int value)
+void Shader::SetUniform1i(const char* name, int value)
 {
     GLCall(glUniform1i(GetUniformLocation(name), value));
 }
 
-void Shader::SetUniform1f(const std::string& name, float value)
+void Shader::SetUniform1f(const char* name, float value)
 {
     GLCall(glUniform1f(GetUniformLocation(name), value));
 }
 
-void Shader::SetUniform1iv(const std::string& name, int count, const int* value)
+void Shader::SetUniform1iv(const char* name, int count, const int* value)
 {
     GLCall(glUniform1iv(GetUniformLocation(name), count, value));
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::SetUniform2f(const char* name, float v0, float v1)
+{
+    GLCall(glUniform2f(GetUniformLocation(name), v0, v1));
+}
+
+void Shader::SetUniform4f(const char* name, float v0, float v1, float v2, float v3)
 {
     GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
 }
 
-void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
+void Shader::SetUniformMat4f(const char* name, const glm::mat4& matrix)
 {
     GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+int Shader::GetUniformLocation(const char* name)
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-        return m_UniformLocationCache[name];
-    GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
+    for (const UniformLocation& uniform : m_UniformLocationCache)
+    {
+        if (uniform.Name == name)
+            return uniform.Location;
+    }
+
+    GLCall(int location = glGetUniformLocation(m_RendererID, name));
     if (location == -1)
         std::cout << "Warning: uniform '" << name << "' doesn't exist" << std::endl;
-    
-    m_UniformLocationCache[name] = location;
+
+    m_UniformLocationCache.push_back({ name, location });
     return location;
 }
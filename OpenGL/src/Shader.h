@@ -1,6 +1,6 @@
 #pragma once
 #include <string>
-#include <unordered_map>
+#include <vector>
 
 #include "glm/glm.hpp"
 
@@ -14,25 +14,50 @@ class Shader
 {
 private:
 	std::string m_FilePath;
+	// "NAME" or "NAME=VALUE", injected after #version
+	std::vector<std::string> m_Defines;
 	unsigned int m_RendererID;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	// a handful per shader, a linear scan compares the names without building strings
+	struct UniformLocation
+	{
+		std::string Name;
+		int Location;
+	};
+	std::vector<UniformLocation> m_UniformLocationCache;
 public:
-	Shader(const std::string& filepath);
+	Shader(const std::string& filepath, const std::vector<std::string>& defines = {});
+	// source already read from filepath, e.g. on a loader thread
+	Shader(const std::string& filepath, const ShaderProgramSource& source, const std::vector<std::string>& defines = {});
 	~Shader();
 
+	Shader(const Shader&) = delete;
+	Shader& operator=(const Shader&) = delete;
+	Shader(Shader&& other) noexcept;
+	Shader& operator=(Shader&& other) noexcept;
+
+	// reads the #shader vertex / #shader fragment sections and pastes in every
+	// #include "file", relative to the including file, touches no GL state
+	static ShaderProgramSource ParseShader(const std::string& filepath);
+	// source with a #define per entry right after its #version line
+	static std::string InjectDefines(const std::string& source, const std::vector<std::string>& defines);
+
 	void Bind() const;
 	void Unbind() const;
 
-	// set uniforms
-	void SetUniform1i(const std::string& name, int value);
-	void SetUniform1f(const std::string& name, float value);
-	void SetUniform1iv(const std::string& name, int length, const int* data);
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+	// set uniforms, looking a name up never builds a std::string
+	void SetUniform1i(const char* name, int value);
+	void SetUniform1f(const char* name, float value);
+	void SetUniform1iv(const char* name, int length, const int* data);
+	void SetUniform2f(const char* name, float v0, float v1);
+	void SetUniform4f(const char* name, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(const char* name, const glm::mat4& matrix);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline const std::string& GetFilePath() const { return m_FilePath; }
+	inline const std::vector<std::string>& GetDefines() const { return m_Defines; }
 private:
-	ShaderProgramSource ParseShader(const std::string& filepath);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
 
-	int GetUniformLocation(const std::string& name);
+	int GetUniformLocation(const char* name);
 };
\ No newline at end of file
@@ -0,0 +1,273 @@
+#include "SpriteStore.h"
+
+#include "Profiler.h"
+#include "SceneFile.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <cmath>
+
+SpriteStore::SpriteStore()
+{
+}
+
+uint16_t SpriteStore::AddImage(uint32_t textureID, const glm::vec2& uvMin, const glm::vec2& uvMax)
+{
+    m_Images.push_back({ textureID, uvMin, uvMax });
+    return (uint16_t)(m_Images.size() - 1);
+}
+
+SpriteHandle SpriteStore::Create(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color,
+    uint16_t image)
+{
+    uint32_t slot;
+    if (!m_FreeSlots.empty())
+    {
+        slot = m_FreeSlots.back();
+        m_FreeSlots.pop_back();
+    }
+    else
+    {
+        slot = (uint32_t)m_Slots.size();
+        m_Slots.emplace_back();
+    }
+
+    m_Slots[slot].Dense = (uint32_t)m_PositionX.size();
+    m_SlotOfSprite.push_back(slot);
+
+    m_PositionX.push_back(position.x);
+    m_PositionY.push_back(position.y);
+    m_SizeX.push_back(size.x);
+    m_SizeY.push_back(size.y);
+    m_Rotation.push_back(0.0f);
+    m_Colors.push_back(PackSceneColor(color));
+    m_VelocityX.push_back(0.0f);
+    m_VelocityY.push_back(0.0f);
+    m_Spin.push_back(0.0f);
+    m_Image.push_back(image);
+    m_FrameCount.push_back(1);
+    m_Frame.push_back(0.0f);
+    m_FrameRate.push_back(0.0f);
+
+    return { slot, m_Slots[slot].Generation };
+}
+
+void SpriteStore::Destroy(SpriteHandle handle)
+{
+    uint32_t index = Find(handle);
+    if (index == InvalidIndex)
+        return;
+
+    // swap with the last sprite so the arrays stay packed
+    uint32_t last = (uint32_t)m_PositionX.size() - 1;
+    if (index != last)
+    {
+        m_PositionX[index] = m_PositionX[last];
+        m_PositionY[index] = m_PositionY[last];
+        m_SizeX[index] = m_SizeX[last];
+        m_SizeY[index] = m_SizeY[last];
+        m_Rotation[index] = m_Rotation[last];
+        m_Colors[index] = m_Colors[last];
+        m_VelocityX[index] = m_VelocityX[last];
+        m_VelocityY[index] = m_VelocityY[last];
+        m_Spin[index] = m_Spin[last];
+        m_Image[index] = m_Image[last];
+        m_FrameCount[index] = m_FrameCount[last];
+        m_Frame[index] = m_Frame[last];
+        m_FrameRate[index] = m_FrameRate[last];
+
+        uint32_t moved = m_SlotOfSprite[last];
+        m_SlotOfSprite[index] = moved;
+        m_Slots[moved].Dense = index;
+    }
+
+    m_PositionX.pop_back();
+    m_PositionY.pop_back();
+    m_SizeX.pop_back();
+    m_SizeY.pop_back();
+    m_Rotation.pop_back();
+    m_Colors.pop_back();
+    m_VelocityX.pop_back();
+    m_VelocityY.pop_back();
+    m_Spin.pop_back();
+    m_Image.pop_back();
+    m_FrameCount.pop_back();
+    m_Frame.pop_back();
+    m_FrameRate.pop_back();
+    m_SlotOfSprite.pop_back();
+
+    Slot& slot = m_Slots[handle.Index];
+    slot.Dense = InvalidIndex;
+    if (++slot.Generation == 0)
+        slot.Generation = 1;
+    m_FreeSlots.push_back(handle.Index);
+}
+
+void SpriteStore::Clear()
+{
+    // bumps every live slot so handles given out before stay invalid
+    for (uint32_t slot : m_SlotOfSprite)
+    {
+        m_Slots[slot].Dense = InvalidIndex;
+        if (++m_Slots[slot].Generation == 0)
+            m_Slots[slot].Generation = 1;
+        m_FreeSlots.push_back(slot);
+    }
+
+    m_SlotOfSprite.clear();
+    m_PositionX.clear();
+    m_PositionY.clear();
+    m_SizeX.clear();
+    m_SizeY.clear();
+    m_Rotation.clear();
+    m_Colors.clear();
+    m_VelocityX.clear();
+    m_VelocityY.clear();
+    m_Spin.clear();
+    m_Image.clear();
+    m_FrameCount.clear();
+    m_Frame.clear();
+    m_FrameRate.clear();
+}
+
+void SpriteStore::Reserve(size_t count)
+{
+    m_Slots.reserve(count);
+    m_SlotOfSprite.reserve(count);
+    m_PositionX.reserve(count);
+    m_PositionY.reserve(count);
+    m_SizeX.reserve(count);
+    m_SizeY.reserve(count);
+    m_Rotation.reserve(count);
+    m_Colors.reserve(count);
+    m_VelocityX.reserve(count);
+    m_VelocityY.reserve(count);
+    m_Spin.reserve(count);
+    m_Image.reserve(count);
+    m_FrameCount.reserve(count);
+    m_Frame.reserve(count);
+    m_FrameRate.reserve(count);
+}
+
+void SpriteStore::SetPosition(SpriteHandle handle, const glm::vec2& position)
+{
+    uint32_t index = Find(handle);
+    if (index == InvalidIndex)
+        return;
+    m_PositionX[index] = position.x;
+    m_PositionY[index] = position.y;
+}
+
+void SpriteStore::SetSize(SpriteHandle handle, const glm::vec2& size)
+{
+    uint32_t index = Find(handle);
+    if (index == InvalidIndex)
+        return;
+    m_SizeX[index] = size.x;
+    m_SizeY[index] = size.y;
+}
+
+void SpriteStore::SetColor(SpriteHandle handle, const glm::vec4& color)
+{
+    uint32_t index = Find(handle);
+    if (index != InvalidIndex)
+        m_Colors[index] = PackSceneColor(color);
+}
+
+void SpriteStore::SetVelocity(SpriteHandle handle, const glm::vec2& velocity)
+{
+    uint32_t index = Find(handle);
+    if (index == InvalidIndex)
+        return;
+    m_VelocityX[index] = velocity.x;
+    m_VelocityY[index] = velocity.y;
+}
+
+void SpriteStore::SetRotation(SpriteHandle handle, float rotation, float spin)
+{
+    uint32_t index = Find(handle);
+    if (index == InvalidIndex)
+        return;
+    m_Rotation[index] = rotation;
+    m_Spin[index] = spin;
+}
+
+void SpriteStore::SetAnimation(SpriteHandle handle, uint16_t firstImage, uint16_t frameCount, float framesPerSecond)
+{
+    uint32_t index = Find(handle);
+    if (index == InvalidIndex)
+        return;
+    m_Image[index] = firstImage;
+    m_FrameCount[index] = std::max<uint16_t>(frameCount, 1);
+    m_Frame[index] = 0.0f;
+    m_FrameRate[index] = framesPerSecond;
+}
+
+glm::vec2 SpriteStore::GetPosition(SpriteHandle handle) const
+{
+    uint32_t index = Find(handle);
+    if (index == InvalidIndex)
+        return { 0.0f, 0.0f };
+    return { m_PositionX[index], m_PositionY[index] };
+}
+
+void SpriteStore::Update(float deltaTime, uint32_t threads)
+{
+    PROFILE_SCOPE("SpriteStore::Update");
+
+    WorkerPool::Get().ParallelFor(GetCount(), MinUpdateRange, [this, deltaTime](size_t begin, size_t end) {
+        UpdateRange(begin, end, deltaTime);
+    }, threads);
+}
+
+// one component at a time so every loop streams through a few arrays and vectorizes
+void SpriteStore::UpdateRange(size_t begin, size_t end, float deltaTime)
+{
+    PROFILE_SCOPE("SpriteStore::UpdateRange");
+
+    float* x = m_PositionX.data();
+    float* y = m_PositionY.data();
+    float* vx = m_VelocityX.data();
+    float* vy = m_VelocityY.data();
+    for (size_t i = begin; i < end; i++)
+    {
+        x[i] += vx[i] * deltaTime;
+        y[i] += vy[i] * deltaTime;
+    }
+
+    if (m_BoundsMax.x >= m_BoundsMin.x && m_BoundsMax.y >= m_BoundsMin.y)
+    {
+        const float* sx = m_SizeX.data();
+        const float* sy = m_SizeY.data();
+        for (size_t i = begin; i < end; i++)
+        {
+            // only flips velocities pointing outwards, so a sprite left outside walks back in
+            if ((x[i] < m_BoundsMin.x && vx[i] < 0.0f) || (x[i] + sx[i] > m_BoundsMax.x && vx[i] > 0.0f))
+                vx[i] = -vx[i];
+            if ((y[i] < m_BoundsMin.y && vy[i] < 0.0f) || (y[i] + sy[i] > m_BoundsMax.y && vy[i] > 0.0f))
+                vy[i] = -vy[i];
+        }
+    }
+
+    float* rotation = m_Rotation.data();
+    const float* spin = m_Spin.data();
+    const float twoPi = 6.2831853f;
+    for (size_t i = begin; i < end; i++)
+    {
+        // kept in [0, 2pi) so it never loses precision
+        float r = rotation[i] + spin[i] * deltaTime;
+        rotation[i] = r - twoPi * std::floor(r * (1.0f / twoPi));
+    }
+
+    float* frame = m_Frame.data();
+    const float* rate = m_FrameRate.data();
+    const uint16_t* frameCount = m_FrameCount.data();
+    for (size_t i = begin; i < end; i++)
+    {
+        float count = (float)frameCount[i];
+        float f = frame[i] + rate[i] * deltaTime;
+        f -= count * std::floor(f / count);
+        // rounding can land exactly on count
+        frame[i] = f < count ? f : 0.0f;
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "ResourcePool.h"
+
+#include "glm/glm.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class SpriteStore;
+using SpriteHandle = Handle<SpriteStore>;
+
+// sprites kept as one array per component, live sprites are packed at the front so a
+// pass over a component touches nothing else; handles stay valid while the arrays are
+// reordered by Destroy
+class SpriteStore
+{
+public:
+	static const uint16_t NoImage = 0xffff;
+	// below this many sprites per thread Update doesn't split
+	static const size_t MinUpdateRange = 16384;
+
+	// a texture or one region of an atlas
+	struct Image
+	{
+		uint32_t TextureID;
+		glm::vec2 UVMin, UVMax;
+	};
+
+	SpriteStore();
+
+	// images are never removed, the index is what sprites refer to
+	uint16_t AddImage(uint32_t textureID, const glm::vec2& uvMin = { 0.0f, 0.0f },
+		const glm::vec2& uvMax = { 1.0f, 1.0f });
+	inline const Image* GetImages() const { return m_Images.data(); }
+	inline uint32_t GetImageCount() const { return (uint32_t)m_Images.size(); }
+
+	// position is the lower left corner like BatchRenderer::DrawQuad, rotation turns
+	// the quad around its center
+	SpriteHandle Create(const glm::vec2& position, const glm::vec2& size, const glm::vec4& color,
+		uint16_t image = NoImage);
+	// the last sprite moves into the hole, stale handles are ignored
+	void Destroy(SpriteHandle handle);
+	inline bool IsValid(SpriteHandle handle) const
+	{
+		return handle.Index < m_Slots.size() && m_Slots[handle.Index].Generation == handle.Generation
+			&& m_Slots[handle.Index].Dense != InvalidIndex;
+	}
+	void Clear();
+	void Reserve(size_t count);
+
+	// stale handles are ignored
+	void SetPosition(SpriteHandle handle, const glm::vec2& position);
+	void SetSize(SpriteHandle handle, const glm::vec2& size);
+	void SetColor(SpriteHandle handle, const glm::vec4& color);
+	// units per second
+	void SetVelocity(SpriteHandle handle, const glm::vec2& velocity);
+	// radians and radians per second
+	void SetRotation(SpriteHandle handle, float rotation, float spin = 0.0f);
+	// shows frameCount consecutive images starting at firstImage, framesPerSecond apart
+	void SetAnimation(SpriteHandle handle, uint16_t firstImage, uint16_t frameCount, float framesPerSecond);
+
+	glm::vec2 GetPosition(SpriteHandle handle) const;
+
+	// sprites moving out of the rectangle are turned back in, max < min turns it off
+	inline void SetBounds(const glm::vec2& min, const glm::vec2& max) { m_BoundsMin = min; m_BoundsMax = max; }
+
+	// moves, spins and animates every sprite by deltaTime, spread over up to threads
+	// threads of the WorkerPool (0 for all)
+	void Update(float deltaTime, uint32_t threads = 0);
+
+	// the component arrays, index i is the i-th live sprite
+	inline size_t GetCount() const { return m_PositionX.size(); }
+	inline const float* GetPositionX() const { return m_PositionX.data(); }
+	inline const float* GetPositionY() const { return m_PositionY.data(); }
+	inline const float* GetSizeX() const { return m_SizeX.data(); }
+	inline const float* GetSizeY() const { return m_SizeY.data(); }
+	inline const float* GetRotation() const { return m_Rotation.data(); }
+	// RGBA8, red in the low byte
+	inline const uint32_t* GetColors() const { return m_Colors.data(); }
+	// image shown right now, NoImage for plain colored sprites
+	uint16_t GetCurrentImage(size_t index) const
+	{
+		return m_Image[index] == NoImage ? NoImage : (uint16_t)(m_Image[index] + (uint32_t)m_Frame[index]);
+	}
+
+private:
+	static const uint32_t InvalidIndex = 0xffffffff;
+
+	struct Slot
+	{
+		uint32_t Dense = InvalidIndex;
+		uint32_t Generation = 1;
+	};
+
+	// dense index of a live handle, InvalidIndex otherwise
+	inline uint32_t Find(SpriteHandle handle) const { return IsValid(handle) ? m_Slots[handle.Index].Dense : InvalidIndex; }
+
+	void UpdateRange(size_t begin, size_t end, float deltaTime);
+
+	std::vector<Image> m_Images;
+
+	// handle index -> dense index and back
+	std::vector<Slot> m_Slots;
+	std::vector<uint32_t> m_FreeSlots;
+	std::vector<uint32_t> m_SlotOfSprite;
+
+	std::vector<float> m_PositionX, m_PositionY;
+	std::vector<float> m_SizeX, m_SizeY;
+	std::vector<float> m_Rotation;
+	std::vector<uint32_t> m_Colors;
+	std::vector<float> m_VelocityX, m_VelocityY;
+	std::vector<float> m_Spin;
+	// first image of the animation, the current frame and how fast it advances
+	std::vector<uint16_t> m_Image;
+	std::vector<uint16_t> m_FrameCount;
+	std::vector<float> m_Frame;
+	std::vector<float> m_FrameRate;
+
+	glm::vec2 m_BoundsMin = { 0.0f, 0.0f }, m_BoundsMax = { -1.0f, -1.0f };
+};
@@ -0,0 +1,181 @@
+#include "StreamingBuffer.h"
+
+#include "GpuMemoryTracker.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// keeps every upload start suitable as a vertex binding offset
+static const size_t UploadAlignment = 64;
+
+static size_t AlignUpload(size_t offset)
+{
+    return (offset + UploadAlignment - 1) / UploadAlignment * UploadAlignment;
+}
+
+const char* GetStreamingStrategyName(StreamingStrategy strategy)
+{
+    switch (strategy)
+    {
+    case StreamingStrategy::SubData:           return "BufferSubData";
+    case StreamingStrategy::Orphan:            return "Orphaning";
+    case StreamingStrategy::MapUnsynchronized: return "Unsynchronized map";
+    case StreamingStrategy::PersistentRing:    return "Persistent ring";
+    }
+    return "Unknown";
+}
+
+StreamingBuffer::StreamingBuffer(size_t size, StreamingStrategy strategy, int ringLength)
+    : m_RendererID(0), m_Strategy(strategy), m_Size(size), m_Capacity(size),
+    m_Offset(0), m_FenceBegin(0), m_Mapped(nullptr)
+{
+    GLCall(glCreateBuffers(1, &m_RendererID));
+
+    switch (m_Strategy)
+    {
+    case StreamingStrategy::SubData:
+        GLCall(glNamedBufferData(m_RendererID, m_Capacity, nullptr, GL_DYNAMIC_DRAW));
+        break;
+    case StreamingStrategy::Orphan:
+        GLCall(glNamedBufferData(m_RendererID, m_Capacity, nullptr, GL_STREAM_DRAW));
+        break;
+    case StreamingStrategy::MapUnsynchronized:
+        m_Capacity = size * std::max(ringLength, 1);
+        GLCall(glNamedBufferData(m_RendererID, m_Capacity, nullptr, GL_STREAM_DRAW));
+        break;
+    case StreamingStrategy::PersistentRing:
+    {
+        m_Capacity = size * std::max(ringLength, 1);
+        // coherent, so writes are visible to draws queued after them without a flush
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glNamedBufferStorage(m_RendererID, m_Capacity, nullptr, flags));
+        GLCall(m_Mapped = (uint8_t*)glMapNamedBufferRange(m_RendererID, 0, m_Capacity, flags));
+        break;
+    }
+    }
+    GPU_TRACK(GpuResourceType::Buffer, m_RendererID, m_Capacity,
+        std::string("StreamingBuffer ") + GetStreamingStrategyName(m_Strategy));
+}
+
+StreamingBuffer::~StreamingBuffer()
+{
+    for (PendingRange& range : m_Pending)
+    {
+        GLCall(glDeleteSync((GLsync)range.Fence));
+    }
+
+    if (m_Mapped)
+    {
+        GLCall(glUnmapNamedBuffer(m_RendererID));
+    }
+    GPU_UNTRACK(GpuResourceType::Buffer, m_RendererID);
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+size_t StreamingBuffer::Upload(const void* data, size_t size)
+{
+    if (size > m_Size)
+    {
+        std::cout << "Streaming upload of " << size << " bytes doesn't fit in " << m_Size << std::endl;
+        size = m_Size;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t offset = 0;
+    switch (m_Strategy)
+    {
+    case StreamingStrategy::SubData:
+        GLCall(glNamedBufferSubData(m_RendererID, 0, size, data));
+        break;
+    case StreamingStrategy::Orphan:
+        GLCall(glNamedBufferData(m_RendererID, m_Capacity, nullptr, GL_STREAM_DRAW));
+        GLCall(glNamedBufferSubData(m_RendererID, 0, size, data));
+        break;
+    case StreamingStrategy::MapUnsynchronized:
+    {
+        // ranges past the write head are never read by queued draws, once it wraps the
+        // whole buffer is invalidated which orphans it like glBufferData(nullptr) would
+        GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        if (m_Offset + size > m_Capacity)
+        {
+            m_Offset = 0;
+            access = GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_BUFFER_BIT;
+        }
+        void* target;
+        GLCall(target = glMapNamedBufferRange(m_RendererID, m_Offset, size, access));
+        if (target)
+            memcpy(target, data, size);
+        GLCall(glUnmapNamedBuffer(m_RendererID));
+        offset = m_Offset;
+        m_Offset = AlignUpload(offset + size);
+        break;
+    }
+    case StreamingStrategy::PersistentRing:
+        if (m_Offset + size > m_Capacity)
+        {
+            // the tail written since the last fence still has to be protected
+            Fence();
+            m_Offset = 0;
+            m_FenceBegin = 0;
+        }
+        WaitForRange(m_Offset, m_Offset + size);
+        memcpy(m_Mapped + m_Offset, data, size);
+        offset = m_Offset;
+        m_Offset = AlignUpload(offset + size);
+        break;
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    m_Stats.UploadMs += std::chrono::duration<double, std::milli>(end - start).count();
+    m_Stats.Bytes += size;
+    m_Stats.Uploads++;
+    return offset;
+}
+
+void StreamingBuffer::Fence()
+{
+    if (m_Strategy != StreamingStrategy::PersistentRing || m_Offset <= m_FenceBegin)
+        return;
+
+    PendingRange range = { nullptr, m_FenceBegin, m_Offset };
+    GLCall(range.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    m_Pending.push_back(range);
+    m_FenceBegin = m_Offset;
+}
+
+void StreamingBuffer::WaitForRange(size_t begin, size_t end)
+{
+    // the newest overlapping range is enough, everything before it signals first
+    int last = -1;
+    for (int i = 0; i < (int)m_Pending.size(); i++)
+    {
+        if (m_Pending[i].Begin < end && begin < m_Pending[i].End)
+            last = i;
+    }
+    if (last < 0)
+        return;
+
+    GLsync fence = (GLsync)m_Pending[last].Fence;
+    GLenum result;
+    GLCall(result = glClientWaitSync(fence, 0, 0));
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+        auto stop = std::chrono::high_resolution_clock::now();
+        m_Stats.WaitMs += std::chrono::duration<double, std::milli>(stop - start).count();
+        m_Stats.Waits++;
+        if (result == GL_TIMEOUT_EXPIRED)
+            std::cout << "Streaming buffer timed out waiting for the GPU" << std::endl;
+    }
+
+    for (int i = 0; i <= last; i++)
+    {
+        GLCall(glDeleteSync((GLsync)m_Pending.front().Fence));
+        m_Pending.pop_front();
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+enum class StreamingStrategy
+{
+	// glBufferSubData into the same storage, the driver syncs with draws still reading it
+	SubData,
+	// glBufferData(nullptr) first so the driver can hand out fresh storage
+	Orphan,
+	// append with GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_INVALIDATE_RANGE_BIT, orphan on wrap
+	MapUnsynchronized,
+	// glBufferStorage mapped once persistent + coherent, written ranges guarded by fences
+	PersistentRing
+};
+
+static const int StreamingStrategyCount = 4;
+
+const char* GetStreamingStrategyName(StreamingStrategy strategy);
+
+// vertex data rewritten every frame, Upload returns where in the buffer the data landed
+class StreamingBuffer
+{
+public:
+	struct Stats
+	{
+		uint64_t Bytes = 0;
+		uint32_t Uploads = 0;
+		// CPU time inside Upload, includes any implicit sync the driver does
+		double UploadMs = 0.0;
+		// part of it spent blocked on fences, ring only
+		double WaitMs = 0.0;
+		uint32_t Waits = 0;
+
+		inline double GetMBPerSecond() const { return UploadMs > 0.0 ? Bytes / (UploadMs * 1000.0) : 0.0; }
+	};
+
+	// size is the largest single upload, the ring strategies keep ringLength times that
+	// so the GPU can still read older data while the CPU appends
+	StreamingBuffer(size_t size, StreamingStrategy strategy, int ringLength = 3);
+	~StreamingBuffer();
+
+	StreamingBuffer(const StreamingBuffer&) = delete;
+	StreamingBuffer& operator=(const StreamingBuffer&) = delete;
+
+	// returns the byte offset to bind the buffer at
+	size_t Upload(const void* data, size_t size);
+	// call once the draws reading everything uploaded so far are queued
+	void Fence();
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline StreamingStrategy GetStrategy() const { return m_Strategy; }
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+
+private:
+	struct PendingRange
+	{
+		void* Fence;
+		size_t Begin, End;
+	};
+
+	// blocks until no queued draw reads [begin, end) anymore
+	void WaitForRange(size_t begin, size_t end);
+
+	unsigned int m_RendererID;
+	StreamingStrategy m_Strategy;
+	size_t m_Size;
+	size_t m_Capacity;
+
+	// write head and the start of what was written since the last fence
+	size_t m_Offset;
+	size_t m_FenceBegin;
+	// whole ring, mapped for the lifetime of the buffer
+	uint8_t* m_Mapped;
+	// oldest first, fences signal in the order they were queued
+	std::deque<PendingRange> m_Pending;
+
+	Stats m_Stats;
+};
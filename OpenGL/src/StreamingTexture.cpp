@@ -0,0 +1,192 @@
+#include "StreamingTexture.h"
+
+#include "GpuMemoryTracker.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// keeps every upload start a multiple of the pixel size and cache line aligned
+static const size_t UploadAlignment = 64;
+
+static size_t AlignUpload(size_t offset)
+{
+    return (offset + UploadAlignment - 1) / UploadAlignment * UploadAlignment;
+}
+
+static double MillisecondsSince(std::chrono::high_resolution_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+StreamingTexture::StreamingTexture(int width, int height, int ringLength)
+    : m_RendererID(0), m_BufferID(0), m_Width(std::max(width, 1)), m_Height(std::max(height, 1)),
+    m_Mapped(nullptr), m_Offset(0), m_RegionX(0), m_RegionY(0), m_RegionWidth(0), m_RegionHeight(0),
+    m_RegionOffset(0)
+{
+    GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID));
+    GLCall(glTextureStorage2D(m_RendererID, 1, GL_RGBA8, m_Width, m_Height));
+    GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+    GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+    GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+    GLCall(glTextureParameteri(m_RendererID, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+    GPU_TRACK(GpuResourceType::Texture, m_RendererID, (size_t)m_Width * m_Height * 4, "StreamingTexture");
+
+    m_Capacity = AlignUpload((size_t)m_Width * m_Height * 4) * std::max(ringLength, 1);
+    // coherent, so the pixels are visible to the upload queued after them without a flush
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    GLCall(glCreateBuffers(1, &m_BufferID));
+    GLCall(glNamedBufferStorage(m_BufferID, m_Capacity, nullptr, flags));
+    GLCall(m_Mapped = (uint8_t*)glMapNamedBufferRange(m_BufferID, 0, m_Capacity, flags));
+    GPU_TRACK(GpuResourceType::Buffer, m_BufferID, m_Capacity, "StreamingTexture ring");
+}
+
+StreamingTexture::~StreamingTexture()
+{
+    for (PendingRange& range : m_Pending)
+    {
+        GLCall(glDeleteSync((GLsync)range.Fence));
+    }
+
+    if (m_Mapped)
+    {
+        GLCall(glUnmapNamedBuffer(m_BufferID));
+    }
+    GPU_UNTRACK(GpuResourceType::Buffer, m_BufferID);
+    GLCall(glDeleteBuffers(1, &m_BufferID));
+    GPU_UNTRACK(GpuResourceType::Texture, m_RendererID);
+    GLCall(glDeleteTextures(1, &m_RendererID));
+}
+
+void StreamingTexture::Update(const void* pixels)
+{
+    Update(0, 0, m_Width, m_Height, pixels);
+}
+
+void StreamingTexture::Update(int x, int y, int width, int height, const void* pixels, size_t stride)
+{
+    // clipped to the texture, the source still has the caller's layout
+    int x0 = std::max(x, 0), y0 = std::max(y, 0);
+    int x1 = std::min(x + width, m_Width), y1 = std::min(y + height, m_Height);
+    if (x1 <= x0 || y1 <= y0)
+        return;
+    uint8_t* target = BeginUpdate(x0, y0, x1 - x0, y1 - y0);
+    if (!target)
+        return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t row = (size_t)m_RegionWidth * 4;
+    stride = stride ? stride : (size_t)width * 4;
+    const uint8_t* source = (const uint8_t*)pixels + (size_t)(y0 - y) * stride + (size_t)(x0 - x) * 4;
+    if (stride == row)
+        memcpy(target, source, row * m_RegionHeight);
+    else
+    {
+        for (int i = 0; i < m_RegionHeight; i++)
+            memcpy(target + i * row, source + i * stride, row);
+    }
+    m_Stats.UploadMs += MillisecondsSince(start);
+
+    EndUpdate();
+}
+
+uint8_t* StreamingTexture::BeginUpdate(int x, int y, int width, int height)
+{
+    if (m_RegionWidth > 0)
+    {
+        std::cout << "StreamingTexture::BeginUpdate without EndUpdate" << std::endl;
+        EndUpdate();
+    }
+
+    if (width <= 0 || height <= 0 || !m_Mapped)
+        return nullptr;
+    // the caller fills width * height pixels, a region sticking out would write past its slot
+    if (x < 0 || y < 0 || width > m_Width - x || height > m_Height - y)
+    {
+        std::cout << "StreamingTexture::BeginUpdate region " << x << ", " << y << ", " << width << " x " << height
+            << " is outside of the " << m_Width << " x " << m_Height << " texture" << std::endl;
+        return nullptr;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t size = (size_t)width * height * 4;
+    if (m_Offset + size > m_Capacity)
+        m_Offset = 0;
+    WaitForRange(m_Offset, m_Offset + size);
+
+    m_RegionX = x;
+    m_RegionY = y;
+    m_RegionWidth = width;
+    m_RegionHeight = height;
+    m_RegionOffset = m_Offset;
+    m_Offset = AlignUpload(m_Offset + size);
+
+    m_Stats.UploadMs += MillisecondsSince(start);
+    return m_Mapped + m_RegionOffset;
+}
+
+void StreamingTexture::EndUpdate()
+{
+    if (m_RegionWidth == 0)
+        return;
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    size_t size = (size_t)m_RegionWidth * m_RegionHeight * 4;
+    // the offset into the bound unpack buffer takes the place of the pixel pointer, it has
+    // to be unbound again or every later glTexImage2D would read from it
+    GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_BufferID));
+    GLCall(glTextureSubImage2D(m_RendererID, 0, m_RegionX, m_RegionY, m_RegionWidth, m_RegionHeight,
+        GL_RGBA, GL_UNSIGNED_BYTE, (const void*)m_RegionOffset));
+    GLCall(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+
+    PendingRange range = { nullptr, m_RegionOffset, m_RegionOffset + size };
+    GLCall(range.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    m_Pending.push_back(range);
+    m_RegionWidth = 0;
+
+    m_Stats.UploadMs += MillisecondsSince(start);
+    m_Stats.Bytes += size;
+    m_Stats.Uploads++;
+    Renderer::GetFrameStats().BytesUploaded += size;
+}
+
+void StreamingTexture::Bind(unsigned int slot) const
+{
+    GLCall(glBindTextureUnit(slot, m_RendererID));
+}
+
+void StreamingTexture::WaitForRange(size_t begin, size_t end)
+{
+    // the newest overlapping range is enough, everything before it signals first
+    int last = -1;
+    for (int i = 0; i < (int)m_Pending.size(); i++)
+    {
+        if (m_Pending[i].Begin < end && begin < m_Pending[i].End)
+            last = i;
+    }
+    if (last < 0)
+        return;
+
+    GLsync fence = (GLsync)m_Pending[last].Fence;
+    GLenum result;
+    GLCall(result = glClientWaitSync(fence, 0, 0));
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000));
+        m_Stats.WaitMs += MillisecondsSince(start);
+        m_Stats.Waits++;
+        if (result == GL_TIMEOUT_EXPIRED)
+            std::cout << "Streaming texture timed out waiting for the GPU" << std::endl;
+    }
+
+    for (int i = 0; i <= last; i++)
+    {
+        GLCall(glDeleteSync((GLsync)m_Pending.front().Fence));
+        m_Pending.pop_front();
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "StreamingBuffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+
+// an RGBA8 texture rewritten often, e.g. video or CPU generated images; the storage is
+// immutable and pixels go through a ring of persistently mapped unpack buffers, fenced
+// per upload, so neither the CPU nor the GPU waits on the other for an update
+class StreamingTexture
+{
+public:
+	// same meaning as for vertex streaming, WaitMs is time blocked on the ring
+	using Stats = StreamingBuffer::Stats;
+
+	// the ring holds ringLength full images, a partial update takes only what it covers
+	StreamingTexture(int width, int height, int ringLength = 3);
+	~StreamingTexture();
+
+	StreamingTexture(const StreamingTexture&) = delete;
+	StreamingTexture& operator=(const StreamingTexture&) = delete;
+
+	// copies the whole image, rows bottom up like glTexImage2D
+	void Update(const void* pixels);
+	// copies a region, (x, y) is its lower left corner, stride is the bytes between rows
+	// of pixels, 0 for tightly packed. Whatever lies outside of the texture is skipped
+	void Update(int x, int y, int width, int height, const void* pixels, size_t stride = 0);
+
+	// writes into the ring instead of copying: returns width * height tightly packed
+	// pixels to fill, or nullptr for an empty region or one not fully inside the texture,
+	// EndUpdate queues the upload
+	uint8_t* BeginUpdate(int x, int y, int width, int height);
+	void EndUpdate();
+
+	void Bind(unsigned int slot = 0) const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+	inline const Stats& GetStats() const { return m_Stats; }
+	inline void ResetStats() { m_Stats = Stats(); }
+
+private:
+	struct PendingRange
+	{
+		void* Fence;
+		size_t Begin, End;
+	};
+
+	// blocks until no queued upload reads [begin, end) anymore
+	void WaitForRange(size_t begin, size_t end);
+
+	unsigned int m_RendererID;
+	unsigned int m_BufferID;
+	int m_Width, m_Height;
+
+	size_t m_Capacity;
+	uint8_t* m_Mapped;
+	size_t m_Offset;
+	// oldest first, fences signal in the order they were queued
+	std::deque<PendingRange> m_Pending;
+
+	// region between BeginUpdate and EndUpdate, m_RegionWidth is 0 outside of one
+	int m_RegionX, m_RegionY, m_RegionWidth, m_RegionHeight;
+	size_t m_RegionOffset;
+
+	Stats m_Stats;
+};
@@ -1,33 +1,49 @@
 #include "Texture.h"
 
+#include "GpuMemoryTracker.h"
 #include "stb_image/stb_image.h"
 
+#include <utility>
+
 Texture::Texture(const std::string& path)
 	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr),
-	m_Width(0), m_Height(0), m_BPP(0)
+	m_Width(0), m_Height(0), m_BPP(0), m_Opaque(false)
 {
 	stbi_set_flip_vertically_on_load(1);
 	m_LocalBuffer = stbi_load(path.c_str(), &m_Width, &m_Height, &m_BPP, 4);
 
-	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
-
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
-
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	Create(m_LocalBuffer);
 
 	if (m_LocalBuffer)
 		stbi_image_free(m_LocalBuffer);
+	m_LocalBuffer = nullptr;
+}
+
+Texture::Texture(const std::string& path, int width, int height, const unsigned char* pixels)
+	: m_RendererID(0), m_FilePath(path), m_LocalBuffer(nullptr),
+	m_Width(width), m_Height(height), m_BPP(4), m_Opaque(false)
+{
+	Create(pixels);
 }
 
 Texture::Texture(uint32_t color)
 	: m_RendererID(0), m_LocalBuffer(nullptr),
-	m_Width(1), m_Height(1), m_BPP(0)
+	m_Width(1), m_Height(1), m_BPP(0), m_Opaque(false)
+{
+	Create(&color);
+}
+
+void Texture::Create(const void* pixels)
 {
+	if (pixels)
+	{
+		const unsigned char* alpha = (const unsigned char*)pixels + 3;
+		size_t count = (size_t)m_Width * m_Height;
+		m_Opaque = true;
+		for (size_t i = 0; i < count && m_Opaque; i++)
+			m_Opaque = alpha[i * 4] == 255;
+	}
+
 	GLCall(glCreateTextures(GL_TEXTURE_2D, 1, &m_RendererID));
 	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
 
@@ -36,15 +52,36 @@ Texture::Texture(uint32_t color)
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
 
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &color));
+	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
 	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GPU_TRACK(GpuResourceType::Texture, m_RendererID, (size_t)m_Width * m_Height * 4,
+		m_FilePath.empty() ? "Texture" : m_FilePath);
 }
 
 Texture::~Texture()
 {
+	GPU_UNTRACK(GpuResourceType::Texture, m_RendererID);
 	GLCall(glDeleteTextures(1, &m_RendererID));
 }
 
+Texture::Texture(Texture&& other) noexcept
+	: m_RendererID(other.m_RendererID), m_FilePath(std::move(other.m_FilePath)), m_LocalBuffer(nullptr),
+	m_Width(other.m_Width), m_Height(other.m_Height), m_BPP(other.m_BPP), m_Opaque(other.m_Opaque)
+{
+	other.m_RendererID = 0;
+}
+
+Texture& Texture::operator=(Texture&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	std::swap(m_FilePath, other.m_FilePath);
+	std::swap(m_Width, other.m_Width);
+	std::swap(m_Height, other.m_Height);
+	std::swap(m_BPP, other.m_BPP);
+	std::swap(m_Opaque, other.m_Opaque);
+	return *this;
+}
+
 void Texture::Bind(unsigned int slot) const
 {
 	/*GLCall(glActiveTexture(GL_TEXTURE0 + slot));
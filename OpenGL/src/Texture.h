@@ -9,14 +9,28 @@ private:
 	std::string m_FilePath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	// every pixel has alpha 255, lets the batcher skip blending
+	bool m_Opaque;
 public:
 	Texture(const std::string& path);
 	Texture(uint32_t color);
+	// RGBA8 pixels decoded elsewhere, e.g. on a loader thread
+	Texture(const std::string& path, int width, int height, const unsigned char* pixels);
 	~Texture();
 
+	Texture(const Texture&) = delete;
+	Texture& operator=(const Texture&) = delete;
+	Texture(Texture&& other) noexcept;
+	Texture& operator=(Texture&& other) noexcept;
+
 	void Bind(unsigned int slot = 0) const;
 	void Unbind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
+	inline bool IsOpaque() const { return m_Opaque; }
+	inline const std::string& GetPath() const { return m_FilePath; }
+private:
+	void Create(const void* pixels);
 };
\ No newline at end of file
@@ -1,18 +1,35 @@
 #include "VertexArray.h"
+#include "GpuMemoryTracker.h"
 #include "VertexBufferLayout.h"
 #include "Renderer.h"
 
+#include <utility>
+
 VertexArray::VertexArray()
 {
 	/* Allocate and assign a Vertex Array Object to our handle */
-	GLCall(glGenVertexArrays(1, &m_RendererID));
+	GLCall(glCreateVertexArrays(1, &m_RendererID));
+	GPU_TRACK(GpuResourceType::VertexArray, m_RendererID, 0, "VertexArray");
 }
 
 VertexArray::~VertexArray()
 {
+	GPU_UNTRACK(GpuResourceType::VertexArray, m_RendererID);
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
+VertexArray::VertexArray(VertexArray&& other) noexcept
+	: m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+VertexArray& VertexArray::operator=(VertexArray&& other) noexcept
+{
+	std::swap(m_RendererID, other.m_RendererID);
+	return *this;
+}
+
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
 {
 	Bind();
@@ -34,6 +51,32 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 	}
 }
 
+void VertexArray::SetLayout(const VertexAttribute* attributes, size_t count)
+{
+	for (unsigned int i = 0; i < count; i++)
+	{
+		const VertexAttribute& attribute = attributes[i];
+		GLCall(glEnableVertexArrayAttrib(m_RendererID, i));
+		GLCall(glVertexArrayAttribFormat(m_RendererID, i, attribute.Count, attribute.Type, attribute.Normalized, attribute.Offset));
+		GLCall(glVertexArrayAttribBinding(m_RendererID, i, 0));
+	}
+}
+
+void VertexArray::SetVertexBuffer(const VertexBuffer& vb, unsigned int stride)
+{
+	GLCall(glVertexArrayVertexBuffer(m_RendererID, 0, vb.GetRendererID(), 0, stride));
+}
+
+void VertexArray::SetVertexBuffer(unsigned int buffer, unsigned int stride, size_t offset)
+{
+	GLCall(glVertexArrayVertexBuffer(m_RendererID, 0, buffer, (GLintptr)offset, stride));
+}
+
+void VertexArray::SetIndexBuffer(const IndexBuffer& ib)
+{
+	GLCall(glVertexArrayElementBuffer(m_RendererID, ib.GetRendererID()));
+}
+
 void VertexArray::Bind() const
 {
 	/* Bind our Vertex Array Object as the current used object */
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "VertexLayout.h"
 
 class VertexBufferLayout;
 
@@ -12,8 +14,24 @@ public:
 	VertexArray();
 	~VertexArray();
 
+	VertexArray(const VertexArray&) = delete;
+	VertexArray& operator=(const VertexArray&) = delete;
+	VertexArray(VertexArray&& other) noexcept;
+	VertexArray& operator=(VertexArray&& other) noexcept;
+
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
 
+	// DSA format setup, every attribute reads from binding point 0
+	void SetLayout(const VertexAttribute* attributes, size_t count);
+	template<size_t N>
+	inline void SetLayout(const VertexLayout<N>& layout) { SetLayout(layout.Attributes.data(), N); }
+
+	// attaches buffers without binding anything, lets one VAO per format serve many buffers
+	void SetVertexBuffer(const VertexBuffer& vb, unsigned int stride);
+	// raw buffer name, the vertex data starts offset bytes in (streaming buffers)
+	void SetVertexBuffer(unsigned int buffer, unsigned int stride, size_t offset);
+	void SetIndexBuffer(const IndexBuffer& ib);
+
 	void Bind() const;
 	void Unbind() const;
 };
\ No newline at end of file
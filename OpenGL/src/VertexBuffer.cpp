@@ -1,28 +1,48 @@
 #include "VertexBuffer.h"
+#include "GpuMemoryTracker.h"
 #include "Renderer.h"
 
+#include <cstring>
+#include <utility>
+
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
 	GLCall(glGenBuffers(1, &m_RendererID));
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
 	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+	GPU_TRACK(GpuResourceType::Buffer, m_RendererID, size, "VertexBuffer");
 }
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size, const char* type)
 {
+	// compares the text, the literals aren't guaranteed to share an address with the caller's
+	GLenum usage = strcmp(type, "dynamic") == 0 ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
 	GLCall(glGenBuffers(1, &m_RendererID));
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
-	if (type == "static")
-		GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
-	if (type == "dynamic")
-		GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW));
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
+	GPU_TRACK(GpuResourceType::Buffer, m_RendererID, size, std::string("VertexBuffer ") + type);
 }
 
 VertexBuffer::~VertexBuffer()
 {
+	// 0 after a move, deleting it is a no-op
+	GPU_UNTRACK(GpuResourceType::Buffer, m_RendererID);
 	GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
+VertexBuffer::VertexBuffer(VertexBuffer&& other) noexcept
+	: m_RendererID(other.m_RendererID)
+{
+	other.m_RendererID = 0;
+}
+
+VertexBuffer& VertexBuffer::operator=(VertexBuffer&& other) noexcept
+{
+	// our old buffer is deleted along with other
+	std::swap(m_RendererID, other.m_RendererID);
+	return *this;
+}
+
 void VertexBuffer::Bind() const
 {
 	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
@@ -9,6 +9,14 @@ public:
 	VertexBuffer(const void* data, unsigned int size, const char* type);
 	~VertexBuffer();
 
+	// owns the GL name, moving transfers it and copying would delete it twice
+	VertexBuffer(const VertexBuffer&) = delete;
+	VertexBuffer& operator=(const VertexBuffer&) = delete;
+	VertexBuffer(VertexBuffer&& other) noexcept;
+	VertexBuffer& operator=(VertexBuffer&& other) noexcept;
+
 	void Bind() const;
 	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include "glm/glm.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct VertexAttribute
+{
+	unsigned int Type;
+	unsigned int Count;
+	unsigned char Normalized;
+	unsigned int Offset;
+};
+
+// GL type and component count of a vertex struct member
+template<typename T>
+struct VertexAttributeTraits;
+
+template<> struct VertexAttributeTraits<float>      { static constexpr unsigned int Type = GL_FLOAT, Count = 1; static constexpr unsigned char Normalized = GL_FALSE; };
+template<> struct VertexAttributeTraits<glm::vec2>  { static constexpr unsigned int Type = GL_FLOAT, Count = 2; static constexpr unsigned char Normalized = GL_FALSE; };
+template<> struct VertexAttributeTraits<glm::vec3>  { static constexpr unsigned int Type = GL_FLOAT, Count = 3; static constexpr unsigned char Normalized = GL_FALSE; };
+template<> struct VertexAttributeTraits<glm::vec4>  { static constexpr unsigned int Type = GL_FLOAT, Count = 4; static constexpr unsigned char Normalized = GL_FALSE; };
+template<> struct VertexAttributeTraits<uint32_t>   { static constexpr unsigned int Type = GL_UNSIGNED_INT, Count = 1; static constexpr unsigned char Normalized = GL_FALSE; };
+// packed RGBA8 colors
+template<> struct VertexAttributeTraits<glm::u8vec4> { static constexpr unsigned int Type = GL_UNSIGNED_BYTE, Count = 4; static constexpr unsigned char Normalized = GL_TRUE; };
+
+constexpr unsigned int GetVertexTypeSize(unsigned int type)
+{
+	return type == GL_UNSIGNED_BYTE ? 1 : 4;
+}
+
+// attribute list of a vertex struct, built at compile time with MakeVertexLayout
+template<size_t N>
+struct VertexLayout
+{
+	std::array<VertexAttribute, N> Attributes;
+	unsigned int Stride;
+
+	// FNV-1a over the whole format, equal layouts share a VAO
+	constexpr uint64_t Hash() const
+	{
+		uint64_t hash = 14695981039346656037ull;
+		const auto mix = [&hash](uint64_t value) { hash = (hash ^ value) * 1099511628211ull; };
+		for (size_t i = 0; i < N; i++)
+		{
+			mix(Attributes[i].Type);
+			mix(Attributes[i].Count);
+			mix(Attributes[i].Normalized);
+			mix(Attributes[i].Offset);
+		}
+		mix(Stride);
+		return hash;
+	}
+
+	// members in declaration order, no overlap and no padding up to the stride
+	constexpr bool IsPacked() const
+	{
+		unsigned int end = 0;
+		for (size_t i = 0; i < N; i++)
+		{
+			if (Attributes[i].Offset != end)
+				return false;
+			end += Attributes[i].Count * GetVertexTypeSize(Attributes[i].Type);
+		}
+		return end == Stride;
+	}
+};
+
+#define VERTEX_ATTRIBUTE(Vertex, Member) VertexAttribute{ \
+	VertexAttributeTraits<decltype(Vertex::Member)>::Type, \
+	VertexAttributeTraits<decltype(Vertex::Member)>::Count, \
+	VertexAttributeTraits<decltype(Vertex::Member)>::Normalized, \
+	(unsigned int)offsetof(Vertex, Member) }
+
+template<typename Vertex, typename... Attributes>
+constexpr VertexLayout<sizeof...(Attributes)> MakeVertexLayout(Attributes... attributes)
+{
+	return { { { attributes... } }, (unsigned int)sizeof(Vertex) };
+}
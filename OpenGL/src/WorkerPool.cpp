@@ -0,0 +1,96 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+WorkerPool& WorkerPool::Get()
+{
+    static WorkerPool pool;
+    return pool;
+}
+
+WorkerPool::WorkerPool()
+{
+    // the calling thread is the last one
+    uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (uint32_t i = 0; i + 1 < threads; i++)
+        m_Workers.emplace_back(&WorkerPool::WorkerLoop, this, i);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+    for (std::thread& worker : m_Workers)
+        worker.join();
+}
+
+void WorkerPool::Run(size_t count, size_t minRange, uint32_t threads, RangeFunc func, void* context)
+{
+    if (count == 0)
+        return;
+
+    uint32_t available = threads ? std::min(threads, GetThreadCount()) : GetThreadCount();
+    // a few ranges per thread so the ones finishing early pick up the slack
+    size_t range = std::max<size_t>({ minRange, 1, (count + available * 4 - 1) / (available * 4) });
+    size_t ranges = (count + range - 1) / range;
+    uint32_t helpers = (uint32_t)std::min<size_t>(available - 1, ranges - 1);
+    if (helpers == 0)
+    {
+        func(context, 0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> run(m_RunMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_Func = func;
+        m_Context = context;
+        m_Count = count;
+        m_Range = range;
+        m_Next.store(0, std::memory_order_relaxed);
+        m_Participants = helpers;
+        m_Busy = helpers;
+        m_Generation++;
+    }
+    m_Wake.notify_all();
+
+    Work();
+
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    m_Done.wait(lock, [this] { return m_Busy == 0; });
+}
+
+void WorkerPool::Work()
+{
+    for (;;)
+    {
+        size_t begin = m_Next.fetch_add(m_Range, std::memory_order_relaxed);
+        if (begin >= m_Count)
+            return;
+        m_Func(m_Context, begin, std::min(begin + m_Range, m_Count));
+    }
+}
+
+void WorkerPool::WorkerLoop(uint32_t index)
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_Mutex);
+            m_Wake.wait(lock, [&] { return m_Stop || (m_Generation != seen && index < m_Participants); });
+            if (m_Stop)
+                return;
+            seen = m_Generation;
+        }
+
+        Work();
+
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        if (--m_Busy == 0)
+            m_Done.notify_one();
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// threads that stay parked between data parallel loops, the caller works on the loop
+// too so a pool of n workers runs n + 1 ranges at once; one loop at a time, don't
+// start another one from inside a range
+class WorkerPool
+{
+public:
+	static WorkerPool& Get();
+
+	WorkerPool(const WorkerPool&) = delete;
+	WorkerPool& operator=(const WorkerPool&) = delete;
+
+	// workers plus the calling thread
+	inline uint32_t GetThreadCount() const { return (uint32_t)m_Workers.size() + 1; }
+
+	// func(begin, end) over [0, count) in ranges of at least minRange, at most threads
+	// threads take part (0 for all of them), returns once every range is done
+	template<typename Func>
+	void ParallelFor(size_t count, size_t minRange, Func&& func, uint32_t threads = 0)
+	{
+		using Callable = std::remove_reference_t<Func>;
+		Run(count, minRange, threads, [](void* context, size_t begin, size_t end) {
+			(*(Callable*)context)(begin, end);
+		}, (void*)&func);
+	}
+
+private:
+	using RangeFunc = void(*)(void* context, size_t begin, size_t end);
+
+	WorkerPool();
+	~WorkerPool();
+
+	void Run(size_t count, size_t minRange, uint32_t threads, RangeFunc func, void* context);
+	// takes ranges until the loop is used up
+	void Work();
+	void WorkerLoop(uint32_t index);
+
+	std::vector<std::thread> m_Workers;
+
+	// held for a whole loop, callers on other threads queue up behind it
+	std::mutex m_RunMutex;
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake, m_Done;
+	// bumped for every loop, workers compare it to the last one they saw
+	uint64_t m_Generation = 0;
+	// workers below this index join the current loop
+	uint32_t m_Participants = 0;
+	uint32_t m_Busy = 0;
+	bool m_Stop = false;
+
+	// the current loop, written before m_Generation is bumped
+	RangeFunc m_Func = nullptr;
+	void* m_Context = nullptr;
+	size_t m_Count = 0;
+	size_t m_Range = 0;
+	std::atomic<size_t> m_Next{ 0 };
+};
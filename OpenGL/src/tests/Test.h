@@ -25,13 +25,16 @@ namespace test {
 
 		void OnImGuiRender() override;
 
-		template<typename T>
-		void RegisterTest(const std::string& name)
+		// args are copied and passed to the constructor every time the test is opened
+		template<typename T, typename... Args>
+		void RegisterTest(const std::string& name, Args... args)
 		{
 			std::cout << "Registering test " << name << std::endl;
 
-			m_Tests.push_back(std::make_pair(name, []() { return new T(); }));
+			m_Tests.push_back(std::make_pair(name, [=]() { return new T(args...); }));
 		}
+
+		inline const std::vector<std::pair<std::string, std::function<Test*()>>>& GetTests() const { return m_Tests; }
 	private:
 		Test*& m_CurrentTest;
 		std::vector<std::pair<std::string, std::function<Test*()>>> m_Tests;
@@ -1,13 +1,15 @@
 #include "TestBatchDynamicGeometry.h"
 
 #include "Renderer.h"
+#include "ResourceManager.h"
 #include "imgui/imgui.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "Shader.h"
+#include "FrameArena.h"
 
-#include <array>
+#include <vector>
 
 namespace test {
 
@@ -19,6 +21,14 @@ namespace test {
         float TextureID;
     };
 
+    // 2D positions, the shader's vec4 gets z = 0 and w = 1, the VAO comes from the per format cache
+    static constexpr auto Layout = MakeVertexLayout<Vertex>(
+        VERTEX_ATTRIBUTE(Vertex, Position),
+        VERTEX_ATTRIBUTE(Vertex, TexCoord),
+        VERTEX_ATTRIBUTE(Vertex, Color),
+        VERTEX_ATTRIBUTE(Vertex, TextureID));
+    static_assert(Layout.IsPacked(), "Vertex has padding");
+
     static Vertex* CreateQuad(Vertex* target, float x, float y, 
         float tintRed, float tintGreen, float tintBlue, float tintA, float textureID)
     {
@@ -68,50 +78,47 @@ namespace test {
         const size_t MaxVertexCount = MaxQuadCount * 4;
         const size_t MaxIndexCount = MaxQuadCount * 6;
 
-        m_VAO = std::make_unique<VertexArray>();
-
-        m_VB = std::make_unique<VertexBuffer>(nullptr, MaxVertexCount * sizeof(Vertex), "dynamic");
-        VertexBufferLayout layout;
-        layout.Push<float>(2); // window coord
-        layout.Push<float>(2); // texture coord
-        layout.Push<float>(4); // color
-        layout.Push<float>(1); // texture ID
-
-        // links the vertex array with the vertex buffer
-        m_VAO->AddBuffer(*m_VB, layout);
-
-        /*unsigned int indices[] = {
-            0, 1, 2,   // triangle 1
-            2, 3, 0,   // triangle 2
-            4, 5, 6,   // triangle 3
-            6, 7, 4,   // triangle 4
-            8, 9, 10,  // triangle 5
-            10, 11, 8  // triangle 6
-        };*/
+        // rewritten every frame, so not shared with other instances like the indices
+        m_VB = std::make_unique<StreamingBuffer>(MaxVertexCount * sizeof(Vertex), BatchRenderer::DefaultStreamingStrategy);
+
+        // built once, later instances of the test reuse it
+        m_Mesh = ResourceManager::Get().GetMesh("BatchDynamicGeometry", [&](Mesh& mesh) {
+            /*unsigned int indices[] = {
+                0, 1, 2,   // triangle 1
+                2, 3, 0,   // triangle 2
+                4, 5, 6,   // triangle 3
+                6, 7, 4,   // triangle 4
+                8, 9, 10,  // triangle 5
+                10, 11, 8  // triangle 6
+            };*/
+
+            // 24KB, too much for the stack
+            std::vector<uint32_t> indices(MaxIndexCount);
+            uint32_t offset = 0;
+            for (size_t i = 0; i < MaxIndexCount; i += 6)
+            {
+                indices[i + 0] = 0 + offset;
+                indices[i + 1] = 1 + offset;
+                indices[i + 2] = 2 + offset;
 
-        uint32_t indices[MaxIndexCount];
-        uint32_t offset = 0;
-        for (size_t i = 0; i < MaxIndexCount; i += 6)
-        {
-            indices[i + 0] = 0 + offset;
-            indices[i + 1] = 1 + offset;
-            indices[i + 2] = 2 + offset;
+                indices[i + 3] = 2 + offset;
+                indices[i + 4] = 3 + offset;
+                indices[i + 5] = 0 + offset;
 
-            indices[i + 3] = 2 + offset;
-            indices[i + 4] = 3 + offset;
-            indices[i + 5] = 0 + offset;
+                offset += 4;
+            }
 
-            offset += 4;
-        }
+            mesh.IB = std::make_unique<IndexBuffer>(indices.data(), MaxIndexCount);
+        });
 
-        m_IB = std::make_unique<IndexBuffer>(indices, MaxIndexCount);
+        m_VAO = &ResourceManager::Get().GetVertexArray(Layout);
 
-        m_Shader = std::make_unique<Shader>("res/shaders/Multi.shader");
+        m_Shader = ResourceManager::Get().GetShader("res/shaders/Multi.shader");
         m_Shader->Bind();
 
         // load texture
-        m_Texture1 = std::make_unique<Texture>("res/textures/Penguin.png");
-        m_Texture2 = std::make_unique<Texture>("res/textures/icon.png");
+        m_Texture1 = ResourceManager::Get().GetTexture("res/textures/Penguin.png");
+        m_Texture2 = ResourceManager::Get().GetTexture("res/textures/icon.png");
         int samplers[2] = { 0, 1 };
         m_Shader->SetUniform1iv("u_Textures", 2, samplers);
     }
@@ -146,9 +153,11 @@ namespace test {
 
         uint32_t indexCount = 0;
 
-        std::array<Vertex, 1000> vertices{};
-        Vertex* buffer = vertices.data();
-        
+        // 5 x 5 grid and the three movable quads, gone at the end of the frame
+        const size_t QuadCount = 5 * 5 + 3;
+        Vertex* vertices = FrameArena::Get().Allocate<Vertex>(QuadCount * 4);
+        Vertex* buffer = vertices;
+
         // draw grid with alternating textures
         for (int y = 0; y < 500; y += 101)
         {
@@ -169,14 +178,13 @@ namespace test {
         buffer = CreateQuad(buffer, m_Quad2Position[0], m_Quad2Position[1], 1.00f, 0.93f, 0.24f, 1.0f, 1.0f);
         indexCount += 6;
 
-        m_VB->Bind();
         // load data into vertex buffer
-        /*glMapBuffer();
-        glUnmapBuffer();*/
-        GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data()));
+        size_t size = (buffer - vertices) * sizeof(Vertex);
+        size_t offset = m_VB->Upload(vertices, size);
+        Renderer::GetFrameStats().BytesUploaded += size;
 
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
-        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
 
         Renderer renderer;
 
@@ -190,8 +198,11 @@ namespace test {
             m_Shader->SetUniformMat4f("u_MVP", mvp);
 
             /* bind va and ib, then create a shape */
-            renderer.Draw(*m_VAO, *m_IB, *m_Shader);
+            // only this frame's quads are at offset, the rest of the index buffer would read old laps of the ring
+            m_VAO->SetVertexBuffer(m_VB->GetRendererID(), Layout.Stride, offset);
+            renderer.Draw(*m_VAO, *m_Mesh->IB, indexCount, *m_Shader);
         }
+        m_VB->Fence();
     }
 
     void TestBatchDynamicGeometry::OnImGuiRender()
@@ -21,7 +21,7 @@ namespace test {
 	void TestClearColor::OnRender()
 	{
 		GLCall(glClearColor(m_ClearColor[0], m_ClearColor[1], m_ClearColor[2], m_ClearColor[3]));
-		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+		Renderer::Clear(GL_COLOR_BUFFER_BIT);
 	}
 
 	void TestClearColor::OnImGuiRender()
@@ -0,0 +1,112 @@
+#include "TestLines.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <cmath>
+#include <random>
+
+namespace test {
+
+    TestLines::TestLines()
+        : m_Proj(glm::ortho(0.0f, 1920.0f, 0.0f, 1080.0f, -1.0f, 1.0f))
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+        m_Plot.resize(200);
+    }
+
+    TestLines::~TestLines()
+    {
+    }
+
+    void TestLines::OnUpdate(float deltaTime)
+    {
+    }
+
+    void TestLines::GenerateHairlines()
+    {
+        // fixed seed so every run draws the same segments
+        std::mt19937 rng(1234);
+        std::uniform_real_distribution<float> x(0.0f, 1920.0f);
+        std::uniform_real_distribution<float> y(0.0f, 1080.0f);
+        std::uniform_real_distribution<float> offset(-20.0f, 20.0f);
+
+        m_Hairlines.resize((size_t)m_HairlineCount * 2);
+        for (size_t i = 0; i < m_Hairlines.size(); i += 2)
+        {
+            m_Hairlines[i] = { x(rng), y(rng) };
+            m_Hairlines[i + 1] = m_Hairlines[i] + glm::vec2(offset(rng), offset(rng));
+        }
+        m_GeneratedCount = m_HairlineCount;
+    }
+
+    void TestLines::OnRender()
+    {
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+
+        if (m_GeneratedCount != m_HairlineCount)
+            GenerateHairlines();
+
+        m_Renderer->SetViewProjection(m_Proj);
+        m_Renderer->ResetStats();
+        m_Renderer->BeginBatch();
+
+        // random hairlines, Flush draws lines after the quads so they end up over the thick strokes too
+        m_Renderer->DrawHairlines(m_Hairlines.data(), (size_t)m_HairlineCount, { 0.3f, 0.3f, 0.3f, 1.0f });
+
+        // debug grid overlay
+        for (float x = 0.0f; x <= 1920.0f; x += 120.0f)
+            m_Renderer->DrawHairline({ x, 0.0f }, { x, 1080.0f }, { 0.2f, 0.4f, 0.2f, 1.0f });
+        for (float y = 0.0f; y <= 1080.0f; y += 120.0f)
+            m_Renderer->DrawHairline({ 0.0f, y }, { 1920.0f, y }, { 0.2f, 0.4f, 0.2f, 1.0f });
+
+        LineJoin join = (LineJoin)m_Join;
+        LineCap cap = (LineCap)m_Cap;
+
+        // sine plot
+        for (size_t i = 0; i < m_Plot.size(); i++)
+        {
+            float t = (float)i / (float)(m_Plot.size() - 1);
+            m_Plot[i] = { 100.0f + t * 1700.0f, 700.0f + 200.0f * std::sin(t * 12.0f + m_Phase) };
+        }
+        m_Renderer->DrawPolyline(m_Plot.data(), m_Plot.size(), m_Thickness, { 0.26f, 0.52f, 0.96f, 1.0f }, join, cap);
+
+        // zigzag with sharp corners to show the joins
+        const glm::vec2 zigzag[] = {
+            { 150.0f, 150.0f }, { 350.0f, 400.0f }, { 550.0f, 150.0f },
+            { 750.0f, 400.0f }, { 800.0f, 150.0f }, { 1100.0f, 300.0f }
+        };
+        m_Renderer->DrawPolyline(zigzag, 6, m_Thickness * 2.0f, { 0.91f, 0.26f, 0.21f, 1.0f }, join, cap);
+
+        // closed outline
+        const glm::vec2 outline[] = {
+            { 1300.0f, 150.0f }, { 1700.0f, 150.0f }, { 1700.0f, 400.0f }, { 1300.0f, 400.0f }
+        };
+        m_Renderer->DrawPolyline(outline, 4, m_Thickness, { 1.00f, 0.93f, 0.24f, 1.0f }, join, cap, true);
+
+        m_Renderer->EndBatch();
+        m_Renderer->Flush();
+    }
+
+    void TestLines::OnImGuiRender()
+    {
+        const char* joins[] = { "Miter", "Bevel", "Round" };
+        const char* caps[] = { "Butt", "Square", "Round" };
+
+        ImGui::SliderFloat("Thickness", &m_Thickness, 1.0f, 40.0f);
+        ImGui::Combo("Join", &m_Join, joins, 3);
+        ImGui::Combo("Cap", &m_Cap, caps, 3);
+        ImGui::SliderFloat("Phase", &m_Phase, 0.0f, 6.28f);
+        ImGui::SliderInt("Hairlines", &m_HairlineCount, 0, 1000000);
+        ImGui::Text("Quads: %d", m_Renderer->GetStats().QuadCount);
+        ImGui::Text("Lines: %d", m_Renderer->GetStats().LineCount);
+        ImGui::Text("Draws: %d", m_Renderer->GetStats().DrawCount);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    }
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+
+namespace test {
+
+	class TestLines : public Test
+	{
+	public:
+		TestLines();
+		~TestLines();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void GenerateHairlines();
+
+		std::shared_ptr<BatchRenderer> m_Renderer;
+
+		// MVP
+		glm::mat4 m_Proj;
+
+		// thick line settings
+		float m_Thickness = 12.0f;
+		int m_Join = (int)LineJoin::Miter;
+		int m_Cap = (int)LineCap::Butt;
+
+		// plot
+		std::vector<glm::vec2> m_Plot;
+		float m_Phase = 0.0f;
+
+		// hairline stress
+		int m_HairlineCount = 10000;
+		int m_GeneratedCount = -1;
+		std::vector<glm::vec2> m_Hairlines;
+	};
+
+}
@@ -1,6 +1,7 @@
 #include "TestMultiTexture2DBatch.h"
 
 #include "Renderer.h"
+#include "ResourceManager.h"
 #include "imgui/imgui.h"
 
 #include "glm/glm.hpp"
@@ -44,25 +45,28 @@ namespace test {
         GLCall(glEnable(GL_BLEND));
         GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 
-        m_VAO = std::make_unique<VertexArray>();
+        // built once, later instances of the test reuse it
+        m_Mesh = ResourceManager::Get().GetMesh("MultiTexture2DBatch", [&](Mesh& mesh) {
+            mesh.VAO = std::make_unique<VertexArray>();
 
-        m_VB = std::make_unique<VertexBuffer>(positions, sizeof(positions));
-        VertexBufferLayout layout;
-        layout.Push<float>(2); // window coord
-        layout.Push<float>(2); // texture coord
-        layout.Push<float>(4); // color
-        layout.Push<float>(1); // texture ID
+            mesh.VB = std::make_unique<VertexBuffer>(positions, sizeof(positions));
+            VertexBufferLayout layout;
+            layout.Push<float>(2); // window coord
+            layout.Push<float>(2); // texture coord
+            layout.Push<float>(4); // color
+            layout.Push<float>(1); // texture ID
 
-        // links the vertex array with the vertex buffer
-        m_VAO->AddBuffer(*m_VB, layout);
-        m_IB = std::make_unique<IndexBuffer>(indices, 6 * 3);
+            // links the vertex array with the vertex buffer
+            mesh.VAO->AddBuffer(*mesh.VB, layout);
+            mesh.IB = std::make_unique<IndexBuffer>(indices, 6 * 3);
+        });
 
-        m_Shader = std::make_unique<Shader>("res/shaders/Multi.shader");
+        m_Shader = ResourceManager::Get().GetShader("res/shaders/Multi.shader");
         m_Shader->Bind();
 
         // load texture
-        m_Texture1 = std::make_unique<Texture>("res/textures/Penguin.png");
-        m_Texture2 = std::make_unique<Texture>("res/textures/icon.png");
+        m_Texture1 = ResourceManager::Get().GetTexture("res/textures/Penguin.png");
+        m_Texture2 = ResourceManager::Get().GetTexture("res/textures/icon.png");
         int samplers[2] = { 0, 1 };
         m_Shader->SetUniform1iv("u_Textures", 2, samplers);
     }
@@ -78,7 +82,7 @@ namespace test {
     void TestMultiTexture2DBatch::OnRender()
     {
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
-        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
 
         Renderer renderer;
 
@@ -92,7 +96,7 @@ namespace test {
             m_Shader->SetUniformMat4f("u_MVP", mvp);
 
             /* bind va and ib, then create a shape */
-            renderer.Draw(*m_VAO, *m_IB, *m_Shader);
+            renderer.Draw(*m_Mesh->VAO, *m_Mesh->IB, *m_Shader);
         }
     }
 
@@ -5,6 +5,7 @@
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "Texture.h"
+#include "ResourceManager.h"
 
 namespace test {
 
@@ -19,11 +20,9 @@ namespace test {
 		void OnImGuiRender() override;
 
 	private:
-		std::unique_ptr<VertexArray> m_VAO;
-		std::unique_ptr<VertexBuffer> m_VB;
-		std::unique_ptr<IndexBuffer> m_IB;
-		std::unique_ptr<Shader> m_Shader;
-		std::unique_ptr<Texture> m_Texture1, m_Texture2;
+		std::shared_ptr<Mesh> m_Mesh;
+		std::shared_ptr<Shader> m_Shader;
+		std::shared_ptr<Texture> m_Texture1, m_Texture2;
 
 		// MVP
 		glm::mat4 m_Proj, m_Model;
@@ -0,0 +1,194 @@
+#include "TestRenderGraph.h"
+
+#include "CommandCapture.h"
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <cmath>
+
+namespace test {
+
+    TestRenderGraph::TestRenderGraph()
+        : m_Proj(glm::ortho(0.0f, 1920.0f, 0.0f, 1080.0f, -1.0f, 1.0f))
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+        m_BlurShader = ResourceManager::Get().GetShader("res/shaders/Blur.shader");
+        m_ThresholdShader = ResourceManager::Get().GetShader("res/shaders/Blur.shader", { "THRESHOLD" });
+        m_CompositeShader = ResourceManager::Get().GetShader("res/shaders/Composite.shader");
+    }
+
+    TestRenderGraph::~TestRenderGraph()
+    {
+    }
+
+    void TestRenderGraph::OnUpdate(float deltaTime)
+    {
+        m_Time += deltaTime;
+    }
+
+    void TestRenderGraph::DrawScene()
+    {
+        m_Renderer->SetViewProjection(m_Proj);
+        m_Renderer->ResetStats();
+        bool sorting = m_Renderer->IsDepthSorting();
+        // the scene target has no depth attachment
+        m_Renderer->SetDepthSorting(false);
+        GLCall(glEnable(GL_BLEND));
+        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+
+        m_Renderer->BeginBatch();
+        // dim tiles with a wave of brighter ones running over them
+        for (float y = 0.0f; y < 1080.0f; y += 60.0f)
+        {
+            for (float x = 0.0f; x < 1920.0f; x += 60.0f)
+            {
+                float phase = x * 0.004f + y * 0.006f + m_Time;
+                float pulse = std::pow(0.5f + 0.5f * std::sin(phase * 2.0f), 4.0f);
+                glm::vec4 color = { 0.15f + 0.85f * pulse, 0.1f + 0.5f * pulse * (0.5f + 0.5f * std::sin(phase)),
+                    0.25f + 0.75f * pulse * (0.5f + 0.5f * std::cos(phase)), 1.0f };
+                m_Renderer->DrawQuad({ x + 5.0f, y + 5.0f }, { 50.0f, 50.0f }, color);
+            }
+        }
+        // and a few lights circling the middle
+        for (int i = 0; i < 6; i++)
+        {
+            float angle = m_Time * 0.7f + i * 1.0471976f;
+            glm::vec2 position = { 960.0f + std::cos(angle) * 400.0f - 40.0f, 540.0f + std::sin(angle) * 300.0f - 40.0f };
+            m_Renderer->DrawQuad(position, { 80.0f, 80.0f }, glm::vec4(1.0f));
+        }
+        m_Renderer->EndBatch();
+        m_Renderer->Flush();
+
+        m_Renderer->SetDepthSorting(sorting);
+    }
+
+    void TestRenderGraph::DrawFullscreen(Shader& shader, const char* sampler, unsigned int source)
+    {
+        shader.Bind();
+        GLCall(glBindTextureUnit(0, source));
+        shader.SetUniform1i(sampler, 0);
+        m_EmptyVAO.Bind();
+        CommandCapture::Get().RecordDraw(GL_TRIANGLES, 3, 0, 0);
+        GLCall(glDrawArrays(GL_TRIANGLES, 0, 3));
+        Renderer::GetFrameStats().DrawCalls++;
+    }
+
+    void TestRenderGraph::OnRender()
+    {
+        GLint framebuffer, viewport[4];
+        GLCall(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &framebuffer));
+        GLCall(glGetIntegerv(GL_VIEWPORT, viewport));
+        GLboolean blend;
+        GLCall(blend = glIsEnabled(GL_BLEND));
+
+        m_Graph.Begin(viewport[2], viewport[3]);
+        RenderGraphResource backbuffer = m_Graph.ImportFramebuffer("Back buffer", framebuffer, viewport[2], viewport[3]);
+
+        RenderGraphTextureDesc sceneDesc;
+        sceneDesc.ClearColor = { 0.02f, 0.02f, 0.05f, 1.0f };
+        RenderGraphResource scene;
+        m_Graph.AddPass("Scene", [&](RenderGraph::PassBuilder& pass) {
+            scene = pass.CreateTexture("Scene", sceneDesc);
+        }, [this](const RenderGraph&) {
+            DrawScene();
+        });
+
+        // the fullscreen passes cover their whole target, nothing to clear
+        RenderGraphTextureDesc half;
+        half.Scale = 0.5f;
+        RenderGraphResource bright;
+        m_Graph.AddPass("Bright", [&](RenderGraph::PassBuilder& pass) {
+            pass.Read(scene);
+            bright = pass.CreateTexture("Bright", half, RenderGraphLoad::DontCare);
+        }, [this, scene](const RenderGraph& graph) {
+            GLCall(glDisable(GL_BLEND));
+            m_ThresholdShader->Bind();
+            m_ThresholdShader->SetUniform1f("u_Threshold", m_Threshold);
+            DrawFullscreen(*m_ThresholdShader, "u_Source", graph.GetTexture(scene));
+        });
+
+        // every iteration declares two more targets, they alias the ones before
+        RenderGraphResource blurred = bright;
+        for (int i = 0; i < m_BlurIterations; i++)
+        {
+            RenderGraphResource horizontal, vertical;
+            m_Graph.AddPass("Blur horizontal", [&](RenderGraph::PassBuilder& pass) {
+                pass.Read(blurred);
+                horizontal = pass.CreateTexture("Blur horizontal", half, RenderGraphLoad::DontCare);
+            }, [this, blurred](const RenderGraph& graph) {
+                m_BlurShader->Bind();
+                m_BlurShader->SetUniform2f("u_Direction", 1.0f / graph.GetWidth(blurred), 0.0f);
+                DrawFullscreen(*m_BlurShader, "u_Source", graph.GetTexture(blurred));
+            });
+            m_Graph.AddPass("Blur vertical", [&](RenderGraph::PassBuilder& pass) {
+                pass.Read(horizontal);
+                vertical = pass.CreateTexture("Blur vertical", half, RenderGraphLoad::DontCare);
+            }, [this, horizontal](const RenderGraph& graph) {
+                m_BlurShader->Bind();
+                m_BlurShader->SetUniform2f("u_Direction", 0.0f, 1.0f / graph.GetHeight(horizontal));
+                DrawFullscreen(*m_BlurShader, "u_Source", graph.GetTexture(horizontal));
+            });
+            blurred = vertical;
+        }
+
+        m_Graph.AddPass("Composite", [&](RenderGraph::PassBuilder& pass) {
+            pass.Read(scene);
+            pass.Write(backbuffer, RenderGraphAccess::RenderTarget, RenderGraphLoad::DontCare);
+        }, [this, scene](const RenderGraph& graph) {
+            GLCall(glDisable(GL_BLEND));
+            DrawFullscreen(*m_CompositeShader, "u_Layer", graph.GetTexture(scene));
+        });
+
+        // without these nothing reads the bright and blur targets and their passes are culled
+        if (m_Bloom)
+        {
+            m_Graph.AddPass("Add bloom", [&](RenderGraph::PassBuilder& pass) {
+                pass.Read(blurred);
+                pass.Write(backbuffer);
+            }, [this, blurred](const RenderGraph& graph) {
+                GLCall(glEnable(GL_BLEND));
+                GLCall(glBlendColor(0.0f, 0.0f, 0.0f, m_Intensity));
+                GLCall(glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE));
+                DrawFullscreen(*m_CompositeShader, "u_Layer", graph.GetTexture(blurred));
+                GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+            });
+        }
+        if (m_ShowBrightPass)
+        {
+            m_Graph.AddPass("Bright pass view", [&](RenderGraph::PassBuilder& pass) {
+                pass.Read(bright);
+                pass.Write(backbuffer);
+            }, [this, bright](const RenderGraph& graph) {
+                GLCall(glDisable(GL_BLEND));
+                GLCall(glViewport(0, 0, graph.GetWidth(bright) / 2, graph.GetHeight(bright) / 2));
+                DrawFullscreen(*m_CompositeShader, "u_Layer", graph.GetTexture(bright));
+            });
+        }
+
+        m_Graph.Execute();
+
+        if (blend)
+        {
+            GLCall(glEnable(GL_BLEND));
+        }
+        else
+        {
+            GLCall(glDisable(GL_BLEND));
+        }
+    }
+
+    void TestRenderGraph::OnImGuiRender()
+    {
+        ImGui::Checkbox("Bloom", &m_Bloom);
+        ImGui::SliderInt("Blur iterations", &m_BlurIterations, 1, 8);
+        ImGui::SliderFloat("Threshold", &m_Threshold, 0.0f, 1.0f);
+        ImGui::SliderFloat("Intensity", &m_Intensity, 0.0f, 2.0f);
+        ImGui::Checkbox("Show bright pass", &m_ShowBrightPass);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+        m_Graph.OnImGuiRender();
+    }
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "RenderGraph.h"
+#include "Shader.h"
+#include "VertexArray.h"
+
+#include <memory>
+
+namespace test {
+
+	// bloom built as a render graph: the scene into a transient target, a half resolution
+	// bright pass, separable blur passes and the composite into whatever framebuffer is
+	// bound; the blur targets alias each other and a debug pass is culled while hidden
+	class TestRenderGraph : public Test
+	{
+	public:
+		TestRenderGraph();
+		~TestRenderGraph();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void DrawScene();
+		// samples source through the given sampler into the bound framebuffer with a fullscreen triangle
+		void DrawFullscreen(Shader& shader, const char* sampler, unsigned int source);
+
+		std::shared_ptr<BatchRenderer> m_Renderer;
+		RenderGraph m_Graph;
+
+		std::shared_ptr<Shader> m_BlurShader, m_ThresholdShader, m_CompositeShader;
+		// bound for the fullscreen triangle, core profile draws need one
+		VertexArray m_EmptyVAO;
+
+		// MVP
+		glm::mat4 m_Proj;
+
+		float m_Time = 0.0f;
+		bool m_Bloom = true;
+		int m_BlurIterations = 2;
+		float m_Threshold = 0.6f;
+		float m_Intensity = 1.0f;
+		bool m_ShowBrightPass = false;
+	};
+
+}
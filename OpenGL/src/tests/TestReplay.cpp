@@ -0,0 +1,40 @@
+#include "TestReplay.h"
+
+#include "imgui/imgui.h"
+
+namespace test {
+
+    TestReplay::TestReplay(const std::string& path)
+        : m_Path(path)
+    {
+        m_Replay.Load(path);
+    }
+
+    TestReplay::~TestReplay()
+    {
+    }
+
+    void TestReplay::OnRender()
+    {
+        m_Replay.ReplayFrame();
+    }
+
+    void TestReplay::OnImGuiRender()
+    {
+        if (!m_Replay.IsLoaded())
+        {
+            ImGui::Text("Couldn't load %s", m_Path.c_str());
+            return;
+        }
+
+        const CommandReplay::Stats& stats = m_Replay.GetStats();
+        ImGui::Text("%s, %dx%d, %.1f KB", m_Path.c_str(), m_Replay.GetWidth(), m_Replay.GetHeight(), stats.FileBytes / 1024.0f);
+        ImGui::Text("Frame %u of %u", m_Replay.GetCurrentFrame() + 1, m_Replay.GetFrameCount());
+        ImGui::Text("%u programs, %u buffers, %u textures, %u framebuffers, %u vertex arrays",
+            stats.Programs, stats.Buffers, stats.Textures, stats.Framebuffers, stats.VertexArrays);
+        ImGui::Text("Per loop: %u draws, %u clears, %u state changes, %u uploads (%.1f KB)",
+            stats.Draws, stats.Clears, stats.StateChanges, stats.Uploads, stats.UploadBytes / 1024.0f);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    }
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Test.h"
+
+#include "CommandReplay.h"
+
+#include <string>
+
+namespace test {
+
+	// the frames of a --record file played back in a loop, benchmarked like any other test
+	class TestReplay : public Test
+	{
+	public:
+		TestReplay(const std::string& path);
+		~TestReplay();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		std::string m_Path;
+		CommandReplay m_Replay;
+	};
+
+}
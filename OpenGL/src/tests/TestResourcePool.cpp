@@ -0,0 +1,100 @@
+#include "TestResourcePool.h"
+
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include <chrono>
+#include <memory>
+
+namespace test {
+
+    TestResourcePool::TestResourcePool()
+    {
+    }
+
+    TestResourcePool::~TestResourcePool()
+    {
+    }
+
+    void TestResourcePool::OnUpdate(float deltaTime)
+    {
+    }
+
+    void TestResourcePool::OnRender()
+    {
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+    }
+
+    // destroys every other buffer and creates them again, the freed slots get reused
+    void TestResourcePool::Churn()
+    {
+        for (size_t i = 0; i < m_Handles.size(); i += 2)
+        {
+            m_StaleHandle = m_Handles[i];
+            m_Buffers.Destroy(m_Handles[i]);
+            m_Handles[i] = m_Buffers.Create(nullptr, m_BufferSize);
+        }
+    }
+
+    void TestResourcePool::RunBenchmark()
+    {
+        // pooled, buffers live by value in one array
+        auto start = std::chrono::high_resolution_clock::now();
+        {
+            ResourcePool<VertexBuffer> pool;
+            pool.Reserve(m_BufferCount);
+            for (int i = 0; i < m_BufferCount; i++)
+                pool.Create(nullptr, m_BufferSize);
+            pool.Clear();
+        }
+        GLCall(glFinish());
+        auto end = std::chrono::high_resolution_clock::now();
+        m_PoolMs = std::chrono::duration<float, std::milli>(end - start).count();
+
+        // one heap allocation per buffer
+        start = std::chrono::high_resolution_clock::now();
+        {
+            std::vector<std::unique_ptr<VertexBuffer>> buffers;
+            buffers.reserve(m_BufferCount);
+            for (int i = 0; i < m_BufferCount; i++)
+                buffers.push_back(std::make_unique<VertexBuffer>(nullptr, m_BufferSize));
+        }
+        GLCall(glFinish());
+        end = std::chrono::high_resolution_clock::now();
+        m_HeapMs = std::chrono::duration<float, std::milli>(end - start).count();
+    }
+
+    void TestResourcePool::OnImGuiRender()
+    {
+        ImGui::SliderInt("Buffers", &m_BufferCount, 1, 100000);
+        ImGui::SliderInt("Buffer size", &m_BufferSize, 16, 65536);
+
+        if (ImGui::Button("Create"))
+        {
+            m_Buffers.Reserve(m_Buffers.GetCapacity() + m_BufferCount);
+            for (int i = 0; i < m_BufferCount; i++)
+                m_Handles.push_back(m_Buffers.Create(nullptr, m_BufferSize));
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Churn"))
+            Churn();
+        ImGui::SameLine();
+        if (ImGui::Button("Destroy all"))
+        {
+            m_Buffers.Clear();
+            if (!m_Handles.empty())
+                m_StaleHandle = m_Handles.back();
+            m_Handles.clear();
+        }
+
+        ImGui::Text("%u live buffers in %u slots", (unsigned int)m_Buffers.GetCount(), (unsigned int)m_Buffers.GetCapacity());
+        ImGui::Text("Stale handle %u/%u resolves: %s", m_StaleHandle.Index, m_StaleHandle.Generation,
+            m_Buffers.Get(m_StaleHandle) ? "yes (bug)" : "no");
+
+        if (ImGui::Button("Benchmark create + destroy"))
+            RunBenchmark();
+        ImGui::Text("Pool %.3f ms, unique_ptr %.3f ms", m_PoolMs, m_HeapMs);
+    }
+
+}
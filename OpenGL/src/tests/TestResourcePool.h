@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Test.h"
+
+#include "VertexBuffer.h"
+#include "ResourcePool.h"
+
+#include <vector>
+
+namespace test {
+
+	class TestResourcePool : public Test
+	{
+	public:
+		TestResourcePool();
+		~TestResourcePool();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Churn();
+		void RunBenchmark();
+
+		ResourcePool<VertexBuffer> m_Buffers;
+		std::vector<Handle<VertexBuffer>> m_Handles;
+		// a handle whose slot was destroyed, must never resolve again
+		Handle<VertexBuffer> m_StaleHandle;
+
+		int m_BufferCount = 10000;
+		int m_BufferSize = 256;
+
+		// create + destroy of m_BufferCount buffers
+		float m_PoolMs = 0.0f;
+		float m_HeapMs = 0.0f;
+	};
+
+}
@@ -0,0 +1,108 @@
+#include "TestSceneFile.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+
+namespace test {
+
+    // visible world size at zoom 1
+    static const glm::vec2 ViewSize = { 960.0f, 540.0f };
+
+    TestSceneFile::TestSceneFile(const std::string& path, uint32_t spriteCount)
+        : m_Path(path)
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+
+        auto start = std::chrono::high_resolution_clock::now();
+        if (!m_Scene.Open(path))
+        {
+            std::cout << "Generating " << spriteCount << " sprites into '" << path << "'" << std::endl;
+            SceneWriter writer;
+            GenerateScene(writer, spriteCount);
+            if (writer.Write(path))
+            {
+                start = std::chrono::high_resolution_clock::now();
+                m_Scene.Open(path);
+            }
+        }
+        m_OpenMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        if (m_Scene.IsOpen())
+        {
+            m_Scene.LoadTextures();
+            const SceneHeader& header = m_Scene.GetHeader();
+            m_Camera = { header.ChunkMinX, header.ChunkMinY };
+        }
+    }
+
+    TestSceneFile::~TestSceneFile()
+    {
+    }
+
+    void TestSceneFile::OnUpdate(float deltaTime)
+    {
+        if (!m_AutoPan || !m_Scene.IsOpen())
+            return;
+
+        // diagonally across the world and around again
+        const SceneHeader& header = m_Scene.GetHeader();
+        glm::vec2 origin = { header.ChunkMinX, header.ChunkMinY };
+        glm::vec2 extent = glm::vec2(header.ChunkColumns, header.ChunkRows) * header.ChunkSize;
+        m_Camera += glm::vec2(300.0f, 170.0f) * deltaTime;
+        if (m_Camera.x > origin.x + extent.x || m_Camera.y > origin.y + extent.y)
+            m_Camera = origin;
+    }
+
+    void TestSceneFile::OnRender()
+    {
+        GLCall(glClearColor(0.05f, 0.05f, 0.08f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+
+        m_DrawnSprites = 0;
+        m_DrawnChunks = 0;
+        if (!m_Scene.IsOpen())
+            return;
+
+        glm::vec2 size = ViewSize / m_Zoom;
+        glm::vec2 min = m_Camera, max = m_Camera + size;
+        m_Renderer->SetViewProjection(glm::ortho(min.x, max.x, min.y, max.y, -1.0f, 1.0f));
+
+        m_Renderer->ResetStats();
+        m_Renderer->BeginBatch();
+        m_DrawnSprites = m_Scene.DrawRegion(*m_Renderer, min, max);
+        m_Renderer->EndBatch();
+        m_Renderer->Flush();
+
+        glm::ivec2 first, last;
+        if (m_Scene.GetChunkRange(min, max, first, last))
+            m_DrawnChunks = (last.x - first.x + 1) * (last.y - first.y + 1);
+    }
+
+    void TestSceneFile::OnImGuiRender()
+    {
+        if (!m_Scene.IsOpen())
+        {
+            ImGui::Text("Couldn't open '%s'", m_Path.c_str());
+            return;
+        }
+
+        const SceneHeader& header = m_Scene.GetHeader();
+        ImGui::Text("%s: %u sprites, %.1f MB, mapped in %.3f ms", m_Path.c_str(), header.SpriteCount,
+            m_Scene.GetFileSize() / (1024.0 * 1024.0), m_OpenMs);
+        ImGui::Text("%u x %u chunks of %.0f units, %u textures", header.ChunkColumns, header.ChunkRows,
+            header.ChunkSize, header.TextureCount);
+
+        ImGui::Checkbox("Pan", &m_AutoPan);
+        ImGui::DragFloat2("Camera", &m_Camera.x, 4.0f);
+        ImGui::SliderFloat("Zoom", &m_Zoom, 0.1f, 4.0f);
+        ImGui::Text("Drawn: %u sprites from %d chunks", (unsigned int)m_DrawnSprites, m_DrawnChunks);
+        ImGui::Text("Draws: %d", m_Renderer->GetStats().DrawCount);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    }
+
+}
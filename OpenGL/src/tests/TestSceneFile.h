@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "SceneFile.h"
+
+namespace test {
+
+	// pans over a mapped scene file, only the chunks under the camera are submitted
+	class TestSceneFile : public Test
+	{
+	public:
+		// generates spriteCount random sprites into path first if it doesn't open
+		TestSceneFile(const std::string& path, uint32_t spriteCount);
+		~TestSceneFile();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		std::shared_ptr<BatchRenderer> m_Renderer;
+		SceneFile m_Scene;
+		std::string m_Path;
+		double m_OpenMs = 0.0;
+
+		glm::vec2 m_Camera = { 0.0f, 0.0f };
+		float m_Zoom = 1.0f;
+		bool m_AutoPan = true;
+
+		size_t m_DrawnSprites = 0;
+		int m_DrawnChunks = 0;
+	};
+
+}
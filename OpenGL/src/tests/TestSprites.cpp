@@ -0,0 +1,107 @@
+#include "TestSprites.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "WorkerPool.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <random>
+
+namespace test {
+
+    static const glm::vec2 WorldSize = { 1920.0f, 1080.0f };
+
+    TestSprites::TestSprites(uint32_t spriteCount)
+        : m_Proj(glm::ortho(0.0f, WorldSize.x, 0.0f, WorldSize.y, -1.0f, 1.0f)),
+        m_SpriteCount((int)spriteCount), m_Threads((int)WorkerPool::Get().GetThreadCount())
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+
+        m_Texture1 = ResourceManager::Get().GetTexture("res/textures/Penguin.png");
+        m_Texture2 = ResourceManager::Get().GetTexture("res/textures/icon.png");
+        // image 0 and 1 double as the two frames of the animated sprites
+        m_Sprites.AddImage(m_Texture1->GetRendererID());
+        m_Sprites.AddImage(m_Texture2->GetRendererID());
+
+        m_Sprites.SetBounds({ 0.0f, 0.0f }, WorldSize);
+        Populate(spriteCount);
+    }
+
+    TestSprites::~TestSprites()
+    {
+    }
+
+    void TestSprites::Populate(uint32_t count)
+    {
+        m_Sprites.Clear();
+        m_Sprites.Reserve(count);
+
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            float size = 2.0f + 14.0f * unit(random) * unit(random);
+            glm::vec2 position = { unit(random) * (WorldSize.x - size), unit(random) * (WorldSize.y - size) };
+            glm::vec4 color = { 0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), 1.0f };
+
+            // a third plain, a third textured, a third flipping between both textures
+            uint32_t kind = i % 3;
+            SpriteHandle sprite = m_Sprites.Create(position, { size, size }, kind == 0 ? color : glm::vec4(1.0f),
+                kind == 0 ? SpriteStore::NoImage : (uint16_t)(i / 3 % 2));
+            m_Sprites.SetVelocity(sprite, { (unit(random) - 0.5f) * 200.0f, (unit(random) - 0.5f) * 200.0f });
+            m_Sprites.SetRotation(sprite, unit(random) * 6.28f, (unit(random) - 0.5f) * 4.0f);
+            if (kind == 2)
+                m_Sprites.SetAnimation(sprite, 0, 2, 1.0f + 3.0f * unit(random));
+        }
+    }
+
+    void TestSprites::OnUpdate(float deltaTime)
+    {
+        if (m_Paused)
+            return;
+
+        auto start = std::chrono::high_resolution_clock::now();
+        m_Sprites.Update(deltaTime, (uint32_t)m_Threads);
+        m_UpdateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    void TestSprites::OnRender()
+    {
+        GLCall(glClearColor(0.05f, 0.05f, 0.08f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+
+        m_Renderer->SetViewProjection(m_Proj);
+        m_Renderer->ResetStats();
+
+        // submission order is fine for sprites, and sorting would copy every one of them
+        bool sorting = m_Renderer->IsDepthSorting();
+        m_Renderer->SetDepthSorting(false);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        m_Renderer->BeginBatch();
+        m_Renderer->DrawSprites(m_Sprites);
+        m_Renderer->EndBatch();
+        m_Renderer->Flush();
+        m_DrawMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        m_Renderer->SetDepthSorting(sorting);
+    }
+
+    void TestSprites::OnImGuiRender()
+    {
+        ImGui::SliderInt("Sprites", &m_SpriteCount, 1000, 1000000);
+        if (ImGui::Button("Respawn"))
+            Populate((uint32_t)m_SpriteCount);
+        ImGui::SliderInt("Update threads", &m_Threads, 1, (int)WorkerPool::Get().GetThreadCount());
+        ImGui::Checkbox("Pause", &m_Paused);
+
+        ImGui::Text("%u sprites, update %.3f ms, submit and draw %.3f ms", (unsigned int)m_Sprites.GetCount(),
+            m_UpdateMs, m_DrawMs);
+        ImGui::Text("Draws: %d", m_Renderer->GetStats().DrawCount);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    }
+
+}
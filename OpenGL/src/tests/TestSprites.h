@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "SpriteStore.h"
+
+namespace test {
+
+	// a SpriteStore full of moving, spinning and animated sprites, updated on the worker
+	// pool and fed to the batcher straight from its arrays
+	class TestSprites : public Test
+	{
+	public:
+		TestSprites(uint32_t spriteCount);
+		~TestSprites();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Populate(uint32_t count);
+
+		std::shared_ptr<BatchRenderer> m_Renderer;
+		std::shared_ptr<Texture> m_Texture1, m_Texture2;
+		SpriteStore m_Sprites;
+
+		// MVP
+		glm::mat4 m_Proj;
+
+		int m_SpriteCount;
+		int m_Threads;
+		bool m_Paused = false;
+
+		double m_UpdateMs = 0.0, m_DrawMs = 0.0;
+	};
+
+}
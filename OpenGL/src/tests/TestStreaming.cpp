@@ -0,0 +1,184 @@
+#include "TestStreaming.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <cmath>
+
+namespace test {
+
+    static void Accumulate(StreamingBuffer::Stats& total, const StreamingBuffer::Stats& stats)
+    {
+        total.Bytes += stats.Bytes;
+        total.Uploads += stats.Uploads;
+        total.UploadMs += stats.UploadMs;
+        total.WaitMs += stats.WaitMs;
+        total.Waits += stats.Waits;
+    }
+
+    TestStreaming::TestStreaming(StreamingStrategy strategy)
+        : m_Strategy(strategy), m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+        m_Renderer->SetStreamingStrategy(m_Strategy);
+    }
+
+    TestStreaming::~TestStreaming()
+    {
+        // the bench runs every strategy as its own test, this is where its numbers show up
+        if (m_TotalFrames > 0)
+        {
+            std::cout << "Streaming (" << GetStreamingStrategyName(m_Strategy) << "): "
+                << m_Total.GetMBPerSecond() << " MB/s, "
+                << m_Total.UploadMs / m_TotalFrames << " ms upload, "
+                << m_Total.WaitMs / m_TotalFrames << " ms stalled per frame" << std::endl;
+        }
+
+        m_Renderer->SetStreamingStrategy(BatchRenderer::DefaultStreamingStrategy);
+    }
+
+    void TestStreaming::OnUpdate(float deltaTime)
+    {
+        m_Time += deltaTime;
+
+        m_WindowTime += deltaTime;
+        if (m_WindowTime >= 1.0f && m_WindowFrames > 0)
+        {
+            m_Current.MBPerSecond = m_Window.GetMBPerSecond();
+            m_Current.UploadMs = m_Window.UploadMs / m_WindowFrames;
+            m_Current.WaitMs = m_Window.WaitMs / m_WindowFrames;
+            m_Current.FrameMs = 1000.0f * m_WindowTime / m_WindowFrames;
+            m_Window = StreamingBuffer::Stats();
+            m_WindowFrames = 0;
+            m_WindowTime = 0.0f;
+        }
+    }
+
+    // every vertex moves each frame, nothing can be reused from the last upload
+    void TestStreaming::DrawScene()
+    {
+        int columns = (int)std::ceil(std::sqrt(m_QuadCount * 16.0f / 9.0f));
+        float cell = 960.0f / columns;
+        for (int i = 0; i < m_QuadCount; i++)
+        {
+            float x = (i % columns) * cell;
+            float y = (i / columns) * cell;
+            float wobble = std::sin(m_Time * 3.0f + i * 0.1f) * cell * 0.25f;
+            glm::vec4 color = { (i % columns) / (float)columns, y / 540.0f, 0.5f + 0.5f * std::sin(m_Time + i), 1.0f };
+            m_Renderer->DrawQuad({ x + wobble, y }, { cell * 0.8f, cell * 0.8f }, color);
+        }
+    }
+
+    void TestStreaming::RunBenchmark()
+    {
+        const int frames = 60;
+
+        for (int i = 0; i < StreamingStrategyCount; i++)
+        {
+            m_Renderer->SetStreamingStrategy((StreamingStrategy)i);
+            m_Renderer->ResetStreamingStats();
+            GLCall(glFinish());
+
+            auto start = std::chrono::high_resolution_clock::now();
+            for (int frame = 0; frame < frames; frame++)
+            {
+                m_Time += 1.0f / 60.0f;
+                m_Renderer->BeginBatch();
+                DrawScene();
+                m_Renderer->EndBatch();
+                m_Renderer->Flush();
+            }
+            GLCall(glFinish());
+            auto end = std::chrono::high_resolution_clock::now();
+
+            StreamingBuffer::Stats stats = m_Renderer->GetStreamingStats();
+            Result& result = m_Results[i];
+            result.MBPerSecond = stats.GetMBPerSecond();
+            result.UploadMs = stats.UploadMs / frames;
+            result.WaitMs = stats.WaitMs / frames;
+            result.FrameMs = std::chrono::duration<double, std::milli>(end - start).count() / frames;
+
+            std::cout << GetStreamingStrategyName((StreamingStrategy)i) << ": " << result.MBPerSecond << " MB/s, "
+                << result.UploadMs << " ms upload, " << result.WaitMs << " ms stalled, "
+                << result.FrameMs << " ms per frame" << std::endl;
+        }
+
+        m_Renderer->SetStreamingStrategy(m_Strategy);
+        m_HasResults = true;
+    }
+
+    void TestStreaming::OnRender()
+    {
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+
+        m_Renderer->SetViewProjection(m_Proj);
+
+        if (m_RunBenchmark)
+        {
+            RunBenchmark();
+            m_RunBenchmark = false;
+        }
+
+        m_Renderer->ResetStats();
+        m_Renderer->ResetStreamingStats();
+        m_Renderer->BeginBatch();
+        DrawScene();
+        m_Renderer->EndBatch();
+        m_Renderer->Flush();
+
+        StreamingBuffer::Stats stats = m_Renderer->GetStreamingStats();
+        Accumulate(m_Window, stats);
+        Accumulate(m_Total, stats);
+        m_WindowFrames++;
+        m_TotalFrames++;
+    }
+
+    void TestStreaming::OnImGuiRender()
+    {
+        int strategy = (int)m_Strategy;
+        const char* names[StreamingStrategyCount];
+        for (int i = 0; i < StreamingStrategyCount; i++)
+            names[i] = GetStreamingStrategyName((StreamingStrategy)i);
+        if (ImGui::Combo("Strategy", &strategy, names, StreamingStrategyCount))
+        {
+            m_Strategy = (StreamingStrategy)strategy;
+            m_Renderer->SetStreamingStrategy(m_Strategy);
+        }
+        ImGui::SliderInt("Quads", &m_QuadCount, 1000, 500000);
+
+        ImGui::Text("Uploads: %.1f MB/s, %.3f ms per frame", m_Current.MBPerSecond, m_Current.UploadMs);
+        ImGui::Text("Stalled on fences: %.3f ms per frame", m_Current.WaitMs);
+        ImGui::Text("Draws: %d", m_Renderer->GetStats().DrawCount);
+
+        if (ImGui::Button("Compare strategies"))
+            m_RunBenchmark = true;
+        if (m_HasResults && ImGui::BeginTable("Results", 5))
+        {
+            ImGui::TableSetupColumn("Strategy");
+            ImGui::TableSetupColumn("MB/s");
+            ImGui::TableSetupColumn("Upload ms");
+            ImGui::TableSetupColumn("Stall ms");
+            ImGui::TableSetupColumn("Frame ms");
+            ImGui::TableHeadersRow();
+            for (int i = 0; i < StreamingStrategyCount; i++)
+            {
+                const Result& result = m_Results[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::Text("%s", names[i]);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", result.MBPerSecond);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", result.UploadMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", result.WaitMs);
+                ImGui::TableNextColumn(); ImGui::Text("%.3f", result.FrameMs);
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    }
+
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "StreamingBuffer.h"
+
+namespace test {
+
+	// streams a screen of moving quads through the batcher with one upload strategy
+	class TestStreaming : public Test
+	{
+	public:
+		TestStreaming(StreamingStrategy strategy = BatchRenderer::DefaultStreamingStrategy);
+		~TestStreaming();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		struct Result
+		{
+			double MBPerSecond = 0.0;
+			// per frame
+			double UploadMs = 0.0, WaitMs = 0.0, FrameMs = 0.0;
+		};
+
+		void DrawScene();
+		// the same scene for a fixed number of frames with every strategy
+		void RunBenchmark();
+
+		std::shared_ptr<BatchRenderer> m_Renderer;
+		StreamingStrategy m_Strategy;
+
+		// MVP
+		glm::mat4 m_Proj;
+
+		int m_QuadCount = 50000;
+		float m_Time = 0.0f;
+
+		// accumulated over about a second for the UI, and over the whole run for the exit summary
+		StreamingBuffer::Stats m_Window, m_Total;
+		int m_WindowFrames = 0, m_TotalFrames = 0;
+		float m_WindowTime = 0.0f;
+		Result m_Current;
+
+		bool m_RunBenchmark = false;
+		bool m_HasResults = false;
+		Result m_Results[StreamingStrategyCount];
+	};
+
+}
@@ -0,0 +1,154 @@
+#include "TestStreamingTexture.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "WorkerPool.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+namespace test {
+
+    static const int Sizes[] = { 256, 512, 1024, 2048, 4096 };
+    static const char* SizeNames[] = { "256", "512", "1024", "2048", "4096" };
+
+    static void Accumulate(StreamingTexture::Stats& total, const StreamingTexture::Stats& stats)
+    {
+        total.Bytes += stats.Bytes;
+        total.Uploads += stats.Uploads;
+        total.UploadMs += stats.UploadMs;
+        total.WaitMs += stats.WaitMs;
+        total.Waits += stats.Waits;
+    }
+
+    TestStreamingTexture::TestStreamingTexture(int size)
+        : m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_Size(size)
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+        m_Texture = std::make_unique<StreamingTexture>(m_Size, m_Size);
+        m_Pixels.resize((size_t)m_Size * m_Size);
+    }
+
+    TestStreamingTexture::~TestStreamingTexture()
+    {
+        // the bench runs it as its own test, this is where its numbers show up
+        if (m_TotalFrames > 0 && m_TotalTime > 0.0f)
+        {
+            std::cout << "Streaming texture (" << m_Size << "x" << m_Size << "): "
+                << m_Total.Bytes / (m_TotalTime * 1.0e6) << " MB/s sustained, "
+                << m_Total.UploadMs / m_TotalFrames << " ms upload, "
+                << m_Total.WaitMs / m_TotalFrames << " ms stalled per frame" << std::endl;
+        }
+    }
+
+    void TestStreamingTexture::OnUpdate(float deltaTime)
+    {
+        m_Time += deltaTime;
+        m_TotalTime += deltaTime;
+
+        m_WindowTime += deltaTime;
+        if (m_WindowTime >= 1.0f && m_WindowFrames > 0)
+        {
+            m_UploadMBPerSecond = m_Window.GetMBPerSecond();
+            m_SustainedMBPerSecond = m_Window.Bytes / (m_WindowTime * 1.0e6);
+            m_WaitMs = m_Window.WaitMs / m_WindowFrames;
+            m_Window = StreamingTexture::Stats();
+            m_WindowFrames = 0;
+            m_WindowTime = 0.0f;
+        }
+    }
+
+    // scrolling xor pattern, cheap enough that the upload dominates
+    void TestStreamingTexture::Generate(uint32_t* pixels, int x, int y, int width, int height) const
+    {
+        uint32_t t = (uint32_t)(m_Time * 120.0f);
+        WorkerPool::Get().ParallelFor((size_t)height, 16, [=](size_t begin, size_t end) {
+            for (size_t row = begin; row < end; row++)
+            {
+                uint32_t gy = (uint32_t)(y + row);
+                uint32_t* out = pixels + row * width;
+                for (int i = 0; i < width; i++)
+                {
+                    uint32_t gx = (uint32_t)(x + i);
+                    uint32_t r = ((gx + t) ^ gy) & 0xff;
+                    uint32_t g = (gx ^ (gy + t)) & 0xff;
+                    uint32_t b = ((gx + gy) >> 1) & 0xff;
+                    out[i] = r | g << 8 | b << 16 | 0xff000000u;
+                }
+            }
+        });
+    }
+
+    void TestStreamingTexture::OnRender()
+    {
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+
+        int x = 0, y = 0, width = m_Size, height = m_Size;
+        if (m_Partial)
+        {
+            width = height = m_Size / 2;
+            x = (int)((0.5f + 0.5f * std::sin(m_Time)) * (m_Size - width));
+            y = (int)((0.5f + 0.5f * std::cos(m_Time * 0.7f)) * (m_Size - height));
+        }
+
+        StreamingTexture::Stats stats;
+        if (m_Synchronous)
+        {
+            Generate(m_Pixels.data(), x, y, width, height);
+            auto start = std::chrono::high_resolution_clock::now();
+            GLCall(glTextureSubImage2D(m_Texture->GetRendererID(), 0, x, y, width, height, GL_RGBA,
+                GL_UNSIGNED_BYTE, m_Pixels.data()));
+            stats.UploadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            stats.Bytes = (uint64_t)width * height * 4;
+            stats.Uploads = 1;
+            Renderer::GetFrameStats().BytesUploaded += stats.Bytes;
+        }
+        else
+        {
+            // generated straight into the ring, no copy on the way
+            m_Texture->ResetStats();
+            uint8_t* target = m_Texture->BeginUpdate(x, y, width, height);
+            if (target)
+                Generate((uint32_t*)target, x, y, width, height);
+            m_Texture->EndUpdate();
+            stats = m_Texture->GetStats();
+        }
+        Accumulate(m_Window, stats);
+        Accumulate(m_Total, stats);
+        m_WindowFrames++;
+        m_TotalFrames++;
+
+        m_Renderer->SetViewProjection(m_Proj);
+        m_Renderer->ResetStats();
+        m_Renderer->BeginBatch();
+        m_Renderer->DrawQuad({ 220.0f, 10.0f }, { 520.0f, 520.0f }, m_Texture->GetRendererID());
+        m_Renderer->EndBatch();
+        m_Renderer->Flush();
+    }
+
+    void TestStreamingTexture::OnImGuiRender()
+    {
+        int size = 0;
+        while (size < IM_ARRAYSIZE(Sizes) - 1 && Sizes[size] < m_Size)
+            size++;
+        if (ImGui::Combo("Size", &size, SizeNames, IM_ARRAYSIZE(SizeNames)))
+        {
+            m_Size = Sizes[size];
+            m_Texture = std::make_unique<StreamingTexture>(m_Size, m_Size);
+            m_Pixels.assign((size_t)m_Size * m_Size, 0);
+        }
+        ImGui::Checkbox("Synchronous glTextureSubImage2D", &m_Synchronous);
+        ImGui::Checkbox("Partial updates", &m_Partial);
+
+        ImGui::Text("Uploads: %.1f MB/s sustained, %.1f MB/s inside the upload calls", m_SustainedMBPerSecond,
+            m_UploadMBPerSecond);
+        ImGui::Text("Stalled on fences: %.3f ms per frame", m_WaitMs);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    }
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "StreamingTexture.h"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+
+	// a CPU generated image rewritten every frame, through the StreamingTexture ring or
+	// with a plain glTextureSubImage2D from client memory to compare against
+	class TestStreamingTexture : public Test
+	{
+	public:
+		TestStreamingTexture(int size = 1024);
+		~TestStreamingTexture();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		// fills width * height pixels of the pattern for the region at (x, y)
+		void Generate(uint32_t* pixels, int x, int y, int width, int height) const;
+
+		std::shared_ptr<BatchRenderer> m_Renderer;
+		std::unique_ptr<StreamingTexture> m_Texture;
+		// the synchronous path generates here first
+		std::vector<uint32_t> m_Pixels;
+
+		// MVP
+		glm::mat4 m_Proj;
+
+		int m_Size;
+		bool m_Synchronous = false;
+		// only a moving square of a quarter of the texture changes per frame
+		bool m_Partial = false;
+		float m_Time = 0.0f;
+
+		// accumulated over about a second for the UI, and over the whole run for the exit summary
+		StreamingTexture::Stats m_Window, m_Total;
+		int m_WindowFrames = 0, m_TotalFrames = 0;
+		float m_WindowTime = 0.0f, m_TotalTime = 0.0f;
+		// upload MB/s while inside the upload calls, and sustained over wall clock time
+		double m_UploadMBPerSecond = 0.0, m_SustainedMBPerSecond = 0.0, m_WaitMs = 0.0;
+	};
+
+}
@@ -0,0 +1,211 @@
+#include "TestStress.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "WorkerPool.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace test {
+
+    static const glm::vec2 WorldSize = { 1920.0f, 1080.0f };
+    static const int MaxQuads = 10000000;
+    // SpriteStore keeps images as uint16
+    static const int MaxTextures = 1024;
+    static const int TextureSize = 16;
+    static const char* SizeNames[] = { "fixed", "uniform", "skewed" };
+
+    // mt19937 gives the same numbers everywhere, the std distributions don't
+    static float Unit(std::mt19937& random)
+    {
+        return (random() >> 8) * (1.0f / 16777216.0f);
+    }
+
+    // edge length relative to the other quads, scaled to the overlap afterwards
+    static float RelativeSize(StressSizes sizes, float u)
+    {
+        switch (sizes)
+        {
+        case StressSizes::Fixed:   return 1.0f;
+        case StressSizes::Uniform: return 0.5f + u;
+        case StressSizes::Skewed:  return 1.0f + 15.0f * u * u * u * u;
+        }
+        return 1.0f;
+    }
+
+    std::string GetStressName(const StressParams& params)
+    {
+        char name[160];
+        snprintf(name, sizeof(name), "Stress: %u quads, %u textures, %d%% moving, overlap %g, %s sizes",
+            params.Quads, params.Textures, (int)(params.Moving * 100.0f + 0.5f), params.Overlap,
+            SizeNames[(int)params.Sizes]);
+        return name;
+    }
+
+    TestStress::TestStress(const StressParams& params)
+        : m_Proj(glm::ortho(0.0f, WorldSize.x, 0.0f, WorldSize.y, -1.0f, 1.0f)),
+        m_QuadCount((int)params.Quads), m_TextureCount((int)params.Textures),
+        m_MovingPercent((int)(params.Moving * 100.0f + 0.5f)), m_Sizes((int)params.Sizes), m_Seed((int)params.Seed),
+        m_Overlap(params.Overlap), m_Threads((int)WorkerPool::Get().GetThreadCount())
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+        Generate(params);
+    }
+
+    TestStress::~TestStress()
+    {
+    }
+
+    void TestStress::Generate(const StressParams& params)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        m_Params = params;
+        m_Params.Quads = std::min(params.Quads, (uint32_t)MaxQuads);
+        m_Params.Textures = std::min(params.Textures, (uint32_t)MaxTextures);
+        m_Params.Moving = std::min(std::max(params.Moving, 0.0f), 1.0f);
+        m_Params.Overlap = std::max(params.Overlap, 0.01f);
+
+        m_Static = SpriteStore();
+        m_Moving = SpriteStore();
+        m_Textures.clear();
+        m_Textures.reserve(m_Params.Textures);
+
+        // a checkerboard in its own hue per texture, so batches switching textures show
+        std::vector<unsigned char> pixels(TextureSize * TextureSize * 4);
+        for (uint32_t i = 0; i < m_Params.Textures; i++)
+        {
+            float hue = std::fmod(i * 0.618034f, 1.0f) * 6.0f;
+            glm::vec3 color = glm::clamp(glm::vec3(std::abs(hue - 3.0f) - 1.0f, 2.0f - std::abs(hue - 2.0f),
+                2.0f - std::abs(hue - 4.0f)), 0.0f, 1.0f);
+            for (int y = 0; y < TextureSize; y++)
+            {
+                for (int x = 0; x < TextureSize; x++)
+                {
+                    float shade = (x / 4 + y / 4) % 2 ? 1.0f : 0.6f;
+                    unsigned char* pixel = &pixels[(y * TextureSize + x) * 4];
+                    pixel[0] = (unsigned char)(color.r * shade * 255.0f);
+                    pixel[1] = (unsigned char)(color.g * shade * 255.0f);
+                    pixel[2] = (unsigned char)(color.b * shade * 255.0f);
+                    pixel[3] = 255;
+                }
+            }
+            m_Textures.emplace_back("stress texture " + std::to_string(i), TextureSize, TextureSize, pixels.data());
+            m_Static.AddImage(m_Textures.back().GetRendererID());
+            m_Moving.AddImage(m_Textures.back().GetRendererID());
+        }
+
+        std::mt19937 random(m_Params.Seed);
+
+        // sizes first, they're scaled so the quads together cover the screen Overlap times
+        std::vector<float> sizes(m_Params.Quads);
+        double area = 0.0;
+        for (float& size : sizes)
+        {
+            size = RelativeSize(m_Params.Sizes, Unit(random));
+            area += (double)size * size;
+        }
+        float scale = area > 0.0 ? (float)std::sqrt(m_Params.Overlap * WorldSize.x * WorldSize.y / area) : 1.0f;
+
+        uint32_t moving = (uint32_t)(m_Params.Quads * m_Params.Moving + 0.5f);
+        m_Static.Reserve(m_Params.Quads - moving);
+        m_Moving.Reserve(moving);
+        m_Moving.SetBounds({ 0.0f, 0.0f }, WorldSize);
+
+        for (uint32_t i = 0; i < m_Params.Quads; i++)
+        {
+            float size = sizes[i] * scale;
+            glm::vec2 position = { Unit(random) * std::max(WorldSize.x - size, 0.0f),
+                Unit(random) * std::max(WorldSize.y - size, 0.0f) };
+            glm::vec4 color = { 0.3f + 0.7f * Unit(random), 0.3f + 0.7f * Unit(random), 0.3f + 0.7f * Unit(random), 1.0f };
+            uint16_t image = SpriteStore::NoImage;
+            if (m_Params.Textures > 0)
+            {
+                image = (uint16_t)(random() % m_Params.Textures);
+                color = glm::vec4(1.0f);
+            }
+            float angle = Unit(random) * 6.2831853f;
+            float speed = 50.0f + 150.0f * Unit(random);
+
+            // the first ones move, the same quads for any moving fraction with this seed
+            if (i < moving)
+            {
+                SpriteHandle sprite = m_Moving.Create(position, { size, size }, color, image);
+                m_Moving.SetVelocity(sprite, { std::cos(angle) * speed, std::sin(angle) * speed });
+            }
+            else
+                m_Static.Create(position, { size, size }, color, image);
+        }
+
+        m_GenerateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    void TestStress::OnUpdate(float deltaTime)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        m_Moving.Update(deltaTime, (uint32_t)m_Threads);
+        m_UpdateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    void TestStress::OnRender()
+    {
+        GLCall(glClearColor(0.05f, 0.05f, 0.08f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+
+        m_Renderer->SetViewProjection(m_Proj);
+        m_Renderer->ResetStats();
+
+        // measures the batcher, not the sort
+        bool sorting = m_Renderer->IsDepthSorting();
+        m_Renderer->SetDepthSorting(false);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        m_Renderer->BeginBatch();
+        m_Renderer->DrawSprites(m_Static);
+        m_Renderer->DrawSprites(m_Moving);
+        m_Renderer->EndBatch();
+        m_Renderer->Flush();
+        m_DrawMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        m_Renderer->SetDepthSorting(sorting);
+    }
+
+    void TestStress::OnImGuiRender()
+    {
+        ImGui::SliderInt("Quads", &m_QuadCount, 1000, MaxQuads, "%d", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderInt("Textures", &m_TextureCount, 0, MaxTextures, "%d", ImGuiSliderFlags_Logarithmic);
+        ImGui::SliderInt("Moving %", &m_MovingPercent, 0, 100);
+        ImGui::SliderFloat("Overlap", &m_Overlap, 0.1f, 64.0f, "%.2f", ImGuiSliderFlags_Logarithmic);
+        ImGui::Combo("Sizes", &m_Sizes, SizeNames, IM_ARRAYSIZE(SizeNames));
+        ImGui::InputInt("Seed", &m_Seed);
+        if (ImGui::Button("Regenerate"))
+        {
+            StressParams params;
+            params.Quads = (uint32_t)std::max(m_QuadCount, 1);
+            params.Textures = (uint32_t)std::max(m_TextureCount, 0);
+            params.Moving = m_MovingPercent / 100.0f;
+            params.Overlap = m_Overlap;
+            params.Sizes = (StressSizes)m_Sizes;
+            params.Seed = (uint32_t)m_Seed;
+            Generate(params);
+        }
+        ImGui::SliderInt("Update threads", &m_Threads, 1, (int)WorkerPool::Get().GetThreadCount());
+
+        const BatchRenderer::Stats& stats = m_Renderer->GetStats();
+        float framerate = ImGui::GetIO().Framerate;
+        ImGui::Text("%s", GetStressName(m_Params).c_str());
+        ImGui::Text("Generated in %.1f ms, update %.3f ms, submit and draw %.3f ms", m_GenerateMs, m_UpdateMs, m_DrawMs);
+        ImGui::Text("Draws: %d, %.0f quads per draw", stats.DrawCount,
+            stats.DrawCount ? (float)stats.QuadCount / stats.DrawCount : 0.0f);
+        ImGui::Text("%.2f M quads/s", stats.QuadCount * framerate / 1.0e6f);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / framerate, framerate);
+    }
+
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "SpriteStore.h"
+#include "Texture.h"
+
+#include <string>
+#include <vector>
+
+namespace test {
+
+	enum class StressSizes
+	{
+		// every quad the same size
+		Fixed,
+		// half to one and a half times the average
+		Uniform,
+		// mostly small quads and a few large ones
+		Skewed
+	};
+
+	// everything a stress scene is generated from, the same params always give the same scene
+	struct StressParams
+	{
+		uint32_t Quads = 100000;
+		// distinct textures, picked at random per quad, 0 for plain colored quads
+		uint32_t Textures = 1;
+		// part of the quads that move every frame, 0 to 1
+		float Moving = 0.1f;
+		// quads covering an average pixel, decides how large the quads are
+		float Overlap = 2.0f;
+		StressSizes Sizes = StressSizes::Uniform;
+		uint32_t Seed = 1;
+	};
+
+	// e.g. "Stress: 100000 quads, 8 textures, 10% moving, overlap 2, uniform sizes"
+	std::string GetStressName(const StressParams& params);
+
+	// a generated scene for scaling curves, quads per second against the quad count,
+	// the textures per batch, how much moves and how much overdraw there is
+	class TestStress : public Test
+	{
+	public:
+		TestStress(const StressParams& params);
+		~TestStress();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void Generate(const StressParams& params);
+
+		std::shared_ptr<BatchRenderer> m_Renderer;
+		std::vector<Texture> m_Textures;
+		// the moving quads have their own store so the update only walks them
+		SpriteStore m_Static, m_Moving;
+
+		// MVP
+		glm::mat4 m_Proj;
+
+		StressParams m_Params;
+		// edited in the ui, applied by Regenerate
+		int m_QuadCount, m_TextureCount, m_MovingPercent, m_Sizes, m_Seed;
+		float m_Overlap;
+		int m_Threads;
+
+		double m_GenerateMs = 0.0, m_UpdateMs = 0.0, m_DrawMs = 0.0;
+	};
+
+}
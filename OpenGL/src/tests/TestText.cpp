@@ -0,0 +1,129 @@
+#include "TestText.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/glm.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+
+namespace test {
+
+    // longer than the small string buffer, a literal would be copied to the heap every frame
+    static const std::string Title = "Signed Distance Fields";
+
+    TestText::TestText()
+        : m_Proj(glm::ortho(0.0f, 1920.0f, 0.0f, 1080.0f, -1.0f, 1.0f))
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+        m_Font = ResourceManager::Get().GetFont("res/fonts/Lato-Regular.ttf", 48.0f);
+        m_Texture = ResourceManager::Get().GetTexture("res/textures/Penguin.png");
+    }
+
+    TestText::~TestText()
+    {
+    }
+
+    void TestText::OnUpdate(float deltaTime)
+    {
+        m_Frame++;
+    }
+
+    void TestText::DrawScene()
+    {
+        // world space tags on a grid, each next to a sprite
+        if ((int)m_Tags.size() != m_TagCount)
+        {
+            m_Tags.resize(m_TagCount);
+            for (int i = 0; i < m_TagCount; i++)
+                m_Tags[i] = "Tag #" + std::to_string(i);
+        }
+
+        const int columns = 25;
+        for (int i = 0; i < m_TagCount; i++)
+        {
+            glm::vec2 position = { 20.0f + (i % columns) * 75.0f, 20.0f + (i / columns) * 22.0f };
+            if (i % 10 == 0)
+                m_Renderer->DrawQuad(position - glm::vec2(16.0f, 2.0f), { 14.0f, 14.0f }, *m_Texture);
+            m_Renderer->DrawString(*m_Font, m_Tags[i], position, m_TagSize, { 0.8f, 0.8f, 0.8f, 1.0f });
+        }
+
+        // scaled title
+        m_Renderer->DrawString(*m_Font, Title, { 100.0f, 900.0f }, m_TitleSize, { 1.0f, 0.93f, 0.24f, 1.0f });
+
+        // HUD counter
+        m_Renderer->DrawString(*m_Font, "Frame " + std::to_string(m_Frame), { 1600.0f, 1040.0f }, 24.0f, { 1.0f, 1.0f, 1.0f, 1.0f });
+    }
+
+    void TestText::RunBenchmark()
+    {
+        const int iterations = 20;
+
+        // layout cached from the previous frames
+        m_Renderer->ResetStats();
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            m_Renderer->BeginBatch();
+            DrawScene();
+            m_Renderer->EndBatch();
+            m_Renderer->Flush();
+        }
+        auto end = std::chrono::high_resolution_clock::now();
+        float ms = std::chrono::duration<float, std::milli>(end - start).count();
+        m_CachedGlyphsPerMs = m_Renderer->GetStats().GlyphCount / ms;
+
+        // reshape every string each iteration
+        m_Renderer->ResetStats();
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            m_Font->ClearLayoutCache();
+            m_Renderer->BeginBatch();
+            DrawScene();
+            m_Renderer->EndBatch();
+            m_Renderer->Flush();
+        }
+        end = std::chrono::high_resolution_clock::now();
+        ms = std::chrono::duration<float, std::milli>(end - start).count();
+        m_UncachedGlyphsPerMs = m_Renderer->GetStats().GlyphCount / ms;
+    }
+
+    void TestText::OnRender()
+    {
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+
+        m_Renderer->SetViewProjection(m_Proj);
+
+        if (m_RunBenchmark)
+        {
+            RunBenchmark();
+            m_RunBenchmark = false;
+        }
+
+        m_Renderer->ResetStats();
+        m_Renderer->BeginBatch();
+        DrawScene();
+        m_Renderer->EndBatch();
+        m_Renderer->Flush();
+    }
+
+    void TestText::OnImGuiRender()
+    {
+        ImGui::SliderFloat("Title size", &m_TitleSize, 8.0f, 400.0f);
+        ImGui::SliderFloat("Tag size", &m_TagSize, 4.0f, 64.0f);
+        ImGui::SliderInt("Tags", &m_TagCount, 0, 20000);
+        ImGui::Text("Glyphs: %d", m_Renderer->GetStats().GlyphCount);
+        ImGui::Text("Draws: %d", m_Renderer->GetStats().DrawCount);
+        ImGui::Text("Cached layouts: %d", (int)m_Font->GetCachedLayoutCount());
+        if (ImGui::Button("Benchmark"))
+            m_RunBenchmark = true;
+        ImGui::Text("Cached: %.1f glyphs/ms", m_CachedGlyphsPerMs);
+        ImGui::Text("Uncached: %.1f glyphs/ms", m_UncachedGlyphsPerMs);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    }
+
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "Font.h"
+#include "Texture.h"
+
+namespace test {
+
+	class TestText : public Test
+	{
+	public:
+		TestText();
+		~TestText();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void DrawScene();
+		void RunBenchmark();
+
+		std::shared_ptr<BatchRenderer> m_Renderer;
+		std::shared_ptr<Font> m_Font;
+		std::shared_ptr<Texture> m_Texture;
+
+		// MVP
+		glm::mat4 m_Proj;
+
+		float m_TitleSize = 96.0f;
+		float m_TagSize = 14.0f;
+		int m_TagCount = 2000;
+		std::vector<std::string> m_Tags;
+
+		uint32_t m_Frame = 0;
+
+		// benchmark results in glyphs per millisecond
+		bool m_RunBenchmark = false;
+		float m_CachedGlyphsPerMs = 0.0f;
+		float m_UncachedGlyphsPerMs = 0.0f;
+	};
+
+}
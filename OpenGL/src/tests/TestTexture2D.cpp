@@ -1,6 +1,7 @@
 #include "TestTexture2D.h"
 
 #include "Renderer.h"
+#include "ResourceManager.h"
 #include "imgui/imgui.h"
 
 
@@ -12,7 +13,7 @@ namespace test {
 	TestTexture2D::TestTexture2D()
         : m_Proj(glm::ortho(0.0f, 1920.0f, 0.0f, 1080.0f, -1.0f, 1.0f)), 
         m_Model(glm::rotate(glm::mat4(1.0f), glm::radians(20.0f), glm::vec3(0.0f, 0.0f, 1.0f))),
-        m_Translation1(300, 200, 0), m_Translation2(600, 300, 0), m_Green(0.0f), m_Increment(0.05f)
+        m_Translation1(300, 200, 0), m_Translation2(600, 300, 0), m_Green(0.0f), m_Increment(1.0f)
 	{
         float positions[] = {
             -50.0f, -50.0f, 0.0f, 0.0f, // 0
@@ -30,23 +31,26 @@ namespace test {
         GLCall(glEnable(GL_BLEND));
         GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 
-        m_VAO = std::make_unique<VertexArray>();
+        // built once, later instances of the test reuse it
+        m_Mesh = ResourceManager::Get().GetMesh("Quad", [&](Mesh& mesh) {
+            mesh.VAO = std::make_unique<VertexArray>();
 
-        m_VB = std::make_unique<VertexBuffer>(positions, 4 * 4 * sizeof(float));
-        VertexBufferLayout layout;
-        layout.Push<float>(2);
-        layout.Push<float>(2);
+            mesh.VB = std::make_unique<VertexBuffer>(positions, 4 * 4 * sizeof(float));
+            VertexBufferLayout layout;
+            layout.Push<float>(2);
+            layout.Push<float>(2);
 
-        // links the vertex array with the vertex buffer
-        m_VAO->AddBuffer(*m_VB, layout);
-        m_IB = std::make_unique<IndexBuffer>(indices, 6);
+            // links the vertex array with the vertex buffer
+            mesh.VAO->AddBuffer(*mesh.VB, layout);
+            mesh.IB = std::make_unique<IndexBuffer>(indices, 6);
+        });
 
-        m_Shader = std::make_unique<Shader>("res/shaders/Basic.shader");
+        m_Shader = ResourceManager::Get().GetShader("res/shaders/Basic.shader");
         m_Shader->Bind();
         m_Shader->SetUniform4f("u_Color", 0.26f, 0.52f, 0.96f, 1.0f);
 
         // load texture
-        m_Texture = std::make_unique<Texture>("res/textures/Penguin.png");
+        m_Texture = ResourceManager::Get().GetTexture("res/textures/Penguin.png");
         m_Shader->SetUniform1i("u_Texture", 0);
 	}
 
@@ -56,12 +60,19 @@ namespace test {
 
 	void TestTexture2D::OnUpdate(float deltaTime)
 	{
+        // tint pulse, scaled by deltaTime
+        if (m_Green > 1.0f)
+            m_Increment = -1.0f;
+        else if (m_Green < 0.0f)
+            m_Increment = 1.0f;
+
+        m_Green += m_Increment * deltaTime;
 	}
 
 	void TestTexture2D::OnRender()
 	{
 		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
-		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+		Renderer::Clear(GL_COLOR_BUFFER_BIT);
 
         Renderer renderer;
 
@@ -75,7 +86,7 @@ namespace test {
             m_Shader->SetUniformMat4f("u_MVP", mvp);
 
             /* bind va and ib, then create a shape */
-            renderer.Draw(*m_VAO, *m_IB, *m_Shader);
+            renderer.Draw(*m_Mesh->VAO, *m_Mesh->IB, *m_Shader);
         }
 
         /* draw a second shape using a second MVP*/
@@ -83,15 +94,8 @@ namespace test {
             glm::mat4 view = glm::translate(glm::mat4(1.0f), m_Translation2);
             glm::mat4 mvp = m_Proj * view * m_Model;
             m_Shader->SetUniformMat4f("u_MVP", mvp);
-            renderer.Draw(*m_VAO, *m_IB, *m_Shader);
+            renderer.Draw(*m_Mesh->VAO, *m_Mesh->IB, *m_Shader);
         }
-
-        if (m_Green > 1.0f)
-            m_Increment = -0.5f;
-        else if (m_Green < 0.0f)
-            m_Increment = 0.5f;
-
-        m_Green += m_Increment;
 	}
 
 	void TestTexture2D::OnImGuiRender()
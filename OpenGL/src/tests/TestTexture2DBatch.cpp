@@ -1,6 +1,7 @@
 #include "TestTexture2DBatch.h"
 
 #include "Renderer.h"
+#include "ResourceManager.h"
 #include "imgui/imgui.h"
 
 
@@ -37,23 +38,26 @@ namespace test {
         GLCall(glEnable(GL_BLEND));
         GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
 
-        m_VAO = std::make_unique<VertexArray>();
+        // built once, later instances of the test reuse it
+        m_Mesh = ResourceManager::Get().GetMesh("Texture2DBatch", [&](Mesh& mesh) {
+            mesh.VAO = std::make_unique<VertexArray>();
 
-        m_VB = std::make_unique<VertexBuffer>(positions, sizeof(positions));
-        VertexBufferLayout layout;
-        layout.Push<float>(2); // window coord
-        layout.Push<float>(2); // texture coord
-        layout.Push<float>(4); // color
+            mesh.VB = std::make_unique<VertexBuffer>(positions, sizeof(positions));
+            VertexBufferLayout layout;
+            layout.Push<float>(2); // window coord
+            layout.Push<float>(2); // texture coord
+            layout.Push<float>(4); // color
 
-        // links the vertex array with the vertex buffer
-        m_VAO->AddBuffer(*m_VB, layout);
-        m_IB = std::make_unique<IndexBuffer>(indices, 12);
+            // links the vertex array with the vertex buffer
+            mesh.VAO->AddBuffer(*mesh.VB, layout);
+            mesh.IB = std::make_unique<IndexBuffer>(indices, 12);
+        });
 
-        m_Shader = std::make_unique<Shader>("res/shaders/TextureBatch.shader");
+        m_Shader = ResourceManager::Get().GetShader("res/shaders/TextureBatch.shader");
         m_Shader->Bind();
 
         // load texture
-        m_Texture = std::make_unique<Texture>("res/textures/Penguin.png");
+        m_Texture = ResourceManager::Get().GetTexture("res/textures/Penguin.png");
         m_Shader->SetUniform1i("u_Texture", 0);
     }
 
@@ -68,7 +72,7 @@ namespace test {
     void TestTexture2DBatch::OnRender()
     {
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
-        GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
 
         Renderer renderer;
 
@@ -81,7 +85,7 @@ namespace test {
             m_Shader->SetUniformMat4f("u_MVP", mvp);
 
             /* bind va and ib, then create a shape */
-            renderer.Draw(*m_VAO, *m_IB, *m_Shader);
+            renderer.Draw(*m_Mesh->VAO, *m_Mesh->IB, *m_Shader);
         }
     }
 
@@ -0,0 +1,119 @@
+#include "TestWorldStreaming.h"
+
+#include "Renderer.h"
+#include "ResourceManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+
+namespace test {
+
+    // visible world size at zoom 1
+    static const glm::vec2 ViewSize = { 960.0f, 540.0f };
+
+    TestWorldStreaming::TestWorldStreaming(const std::string& path, uint32_t spriteCount)
+        : m_Path(path)
+    {
+        m_Renderer = ResourceManager::Get().GetBatchRenderer();
+
+        if (!m_Scene.Open(path))
+        {
+            std::cout << "Generating " << spriteCount << " sprites into '" << path << "'" << std::endl;
+            SceneWriter writer;
+            GenerateScene(writer, spriteCount);
+            if (writer.Write(path))
+                m_Scene.Open(path);
+        }
+
+        if (m_Scene.IsOpen())
+        {
+            const SceneHeader& header = m_Scene.GetHeader();
+            m_Camera = { header.ChunkMinX, header.ChunkMinY };
+            m_Streamer = std::make_unique<ChunkStreamer>(m_Scene);
+        }
+    }
+
+    TestWorldStreaming::~TestWorldStreaming()
+    {
+        // joins the loader before the scene it reads from is unmapped
+        m_Streamer.reset();
+    }
+
+    void TestWorldStreaming::OnUpdate(float deltaTime)
+    {
+        if (!m_AutoPan || !m_Streamer)
+            return;
+
+        // bounce around inside the world
+        const SceneHeader& header = m_Scene.GetHeader();
+        glm::vec2 origin = { header.ChunkMinX, header.ChunkMinY };
+        glm::vec2 extent = glm::vec2(header.ChunkColumns, header.ChunkRows) * header.ChunkSize - ViewSize / m_Zoom;
+        m_Camera += m_Direction * m_Speed * deltaTime;
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if (m_Camera[axis] < origin[axis] || m_Camera[axis] > origin[axis] + extent[axis])
+            {
+                m_Direction[axis] = -m_Direction[axis];
+                m_Camera[axis] = glm::clamp(m_Camera[axis], origin[axis], origin[axis] + std::max(extent[axis], 0.0f));
+            }
+        }
+    }
+
+    void TestWorldStreaming::OnRender()
+    {
+        GLCall(glClearColor(0.05f, 0.05f, 0.08f, 1.0f));
+        Renderer::Clear(GL_COLOR_BUFFER_BIT);
+
+        m_DrawnSprites = 0;
+        if (!m_Streamer)
+            return;
+
+        glm::vec2 min = m_Camera, max = m_Camera + ViewSize / m_Zoom;
+        m_Streamer->Update(min, max);
+
+        m_Renderer->SetViewProjection(glm::ortho(min.x, max.x, min.y, max.y, -1.0f, 1.0f));
+        m_Renderer->ResetStats();
+        m_DrawnSprites = m_Streamer->Draw(*m_Renderer, min, max);
+    }
+
+    void TestWorldStreaming::OnImGuiRender()
+    {
+        if (!m_Streamer)
+        {
+            ImGui::Text("Couldn't open '%s'", m_Path.c_str());
+            return;
+        }
+
+        const SceneHeader& header = m_Scene.GetHeader();
+        ImGui::Text("%s: %u sprites, %.1f MB mapped", m_Path.c_str(), header.SpriteCount,
+            m_Scene.GetFileSize() / (1024.0 * 1024.0));
+        ImGui::Text("World %.0f x %.0f, %u x %u chunks", header.ChunkColumns * header.ChunkSize,
+            header.ChunkRows * header.ChunkSize, header.ChunkColumns, header.ChunkRows);
+
+        ImGui::Checkbox("Pan", &m_AutoPan);
+        ImGui::SliderFloat("Speed", &m_Speed, 0.0f, 10000.0f, "%.0f units/s");
+        ImGui::SliderFloat("Zoom", &m_Zoom, 0.25f, 4.0f);
+        ImGui::DragFloat2("Camera", &m_Camera.x, 4.0f);
+
+        float margin = m_Streamer->GetPrefetchMargin();
+        if (ImGui::SliderFloat("Prefetch margin", &margin, 0.0f, 4096.0f, "%.0f units"))
+            m_Streamer->SetPrefetchMargin(margin);
+        int maxResident = (int)m_Streamer->GetMaxResidentChunks();
+        if (ImGui::SliderInt("Max resident chunks", &maxResident, 16, 2048))
+            m_Streamer->SetMaxResidentChunks((uint32_t)maxResident);
+
+        const ChunkStreamer::Stats& stats = m_Streamer->GetStats();
+        ImGui::Text("Resident: %u chunks, %u queued", stats.ResidentChunks, stats.QueuedLoads);
+        ImGui::Text("Visible: %u chunks, %u not loaded yet", stats.VisibleChunks, stats.MissingChunks);
+        ImGui::Text("Buffers: %u pooled, %u free, %.1f MB GPU, %.1f MB staging", stats.PooledBuffers,
+            stats.FreeBuffers, stats.GpuBytes / (1024.0 * 1024.0), stats.StagingBytes / (1024.0 * 1024.0));
+        ImGui::Text("Loaded %llu, evicted %llu, discarded %llu", (unsigned long long)stats.Loaded,
+            (unsigned long long)stats.Evicted, (unsigned long long)stats.Discarded);
+        ImGui::Text("Upload %.3f ms, drawn %u sprites in %d draws", stats.UploadMs,
+            (unsigned int)m_DrawnSprites, m_Renderer->GetStats().DrawCount);
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+    }
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "ChunkStreamer.h"
+#include "SceneFile.h"
+
+namespace test {
+
+	// flies over a scene file much larger than the view, only the chunks around the
+	// camera are kept on the GPU by a ChunkStreamer
+	class TestWorldStreaming : public Test
+	{
+	public:
+		// generates spriteCount random sprites into path first if it doesn't open
+		TestWorldStreaming(const std::string& path, uint32_t spriteCount);
+		~TestWorldStreaming();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		std::shared_ptr<BatchRenderer> m_Renderer;
+		SceneFile m_Scene;
+		std::unique_ptr<ChunkStreamer> m_Streamer;
+		std::string m_Path;
+
+		glm::vec2 m_Camera = { 0.0f, 0.0f };
+		glm::vec2 m_Direction = { 0.87f, 0.5f };
+		float m_Speed = 600.0f;
+		float m_Zoom = 1.0f;
+		bool m_AutoPan = true;
+
+		size_t m_DrawnSprites = 0;
+	};
+
+}